@@ -16,26 +16,41 @@
 #define CACHE_H
 
 #include "types.h"
+#include "checkpoint.h"
+#include "stats.h"
 
 /**
  * @brief Initialize cache with given configuration
  * 
  * Creates and initializes a cache with the specified size, block size,
- * and associativity. Allocates all necessary data structures including
- * cache sets, cache lines, and LRU tracking structures.
+ * and associativity. All sets live in one aligned allocation; each set
+ * block packs its tags, state bits and replacement state (no block data
+ * is kept).
  * 
  * Algorithm:
  * 1. Calculate number of sets based on associativity
  * 2. Calculate ways per set
  * 3. Calculate bit field sizes (offset, index, tag)
- * 4. Allocate cache sets and lines
- * 5. Initialize LRU lists for set-associative caches
+ * 4. Allocate the packed set blocks
+ * 5. Initialize replacement state (config.policy) for set-associative caches
  * 
  * @param config Cache configuration (size, block_size, associativity)
  * @return Pointer to initialized cache, or NULL on error
  */
 cache_t* cache_init(cache_config_t config);
 
+/**
+ * @brief Classify the misses of a cache from now on (--classify)
+ * 
+ * Attaches a classifier (see classify.h) and wraps the access path so
+ * every access also updates it. Caches without one keep their
+ * specialized path untouched. Classified caches cannot be viewed.
+ * 
+ * @param cache Cache instance
+ * @return false on allocation failure
+ */
+bool cache_enable_classify(cache_t *cache);
+
 /**
  * @brief Access cache with given physical address
  * 
@@ -48,13 +63,13 @@ cache_t* cache_init(cache_config_t config);
  * 3. Search cache set for matching tag
  * 4. If HIT:
  *    a. Update hit statistics
- *    b. Update LRU (move to head if set-associative)
+ *    b. Update replacement state (e.g. LRU: move to MRU)
  *    c. Set dirty bit if write
  * 5. If MISS:
  *    a. Update miss statistics
- *    b. Select victim line (LRU or invalid)
+ *    b. Select victim way (first unfilled, else ask the policy)
  *    c. Evict victim if necessary
- *    d. Insert new line
+ *    d. Install new tag
  * 
  * @param cache Cache instance
  * @param addr Physical address to access
@@ -63,6 +78,145 @@ cache_t* cache_init(cache_config_t config);
  */
 cache_result_t cache_access(cache_t *cache, uint32_t addr, bool is_write);
 
+/**
+ * @brief Write a dirty block from the level above into the cache
+ * 
+ * Updates the cache like a write access (allocating the block on a miss,
+ * which may evict a dirty victim in turn) but is not a demand access:
+ * only writebacks_in and writeback_misses are counted.
+ * 
+ * @param cache Cache instance
+ * @param addr Block address of the written-back block
+ * @return CACHE_HIT or CACHE_MISS
+ */
+cache_result_t cache_write_back(cache_t *cache, uint32_t addr);
+
+/**
+ * @brief Record the dirty victims of the cache
+ * 
+ * Every dirty eviction is counted in cache->writebacks; with a log, it is
+ * also appended to log (see cache_writeback_t), which the owner empties
+ * by resetting cache->wb_count. The log must have room for one entry per
+ * operation between two drains.
+ * 
+ * @param cache Cache instance
+ * @param log Victim log, or NULL to stop recording
+ */
+void cache_set_writeback_log(cache_t *cache, cache_writeback_t *log);
+
+/**
+ * @brief Access cache with a batch of physical addresses
+ * 
+ * Equivalent to calling cache_access() on each address in order, so the
+ * results and statistics are identical to the scalar path. While access i
+ * is simulated, the set blocks of upcoming accesses are software-prefetched,
+ * letting the misses of a large cache overlap.
+ * 
+ * @param cache Cache instance
+ * @param addrs Physical addresses
+ * @param is_write Per-access write flags
+ * @param n Number of accesses
+ * @param[out] results Per-access CACHE_HIT or CACHE_MISS
+ */
+void cache_access_batch(cache_t *cache, const uint32_t *addrs,
+                        const bool *is_write, size_t n,
+                        cache_result_t *results);
+
+/**
+ * @brief Set the next-use time of the access about to be simulated
+ * 
+ * Only the OPT policy (--opt) reads it: the accessed block is tagged with
+ * this time, and the block with the latest time is evicted first.
+ * 
+ * @param cache Cache instance
+ * @param next_use Position of the block's next access (REPL_NEVER if none)
+ */
+void cache_set_next_use(cache_t *cache, uint64_t next_use);
+
+/**
+ * @brief Prefetch the set an address maps to
+ * 
+ * Pure performance hint; has no effect on cache state.
+ * 
+ * @param cache Cache instance
+ * @param addr Physical address
+ */
+void cache_prefetch(const cache_t *cache, uint32_t addr);
+
+/**
+ * @brief Create a view of a cache for one thread
+ * 
+ * The view shares the set storage of the cache but has its own
+ * statistics. Threads that access disjoint sets, each through its own
+ * view, therefore never write the same memory; cache_view_merge() then
+ * folds the statistics back. Caches with a tag index (large
+ * fully-associative) have a single set and cannot be viewed; neither
+ * can classified caches.
+ * 
+ * @param cache Cache instance (must outlive the view)
+ * @return View with zeroed statistics, or NULL on error
+ */
+cache_t* cache_view_create(const cache_t *cache);
+
+/**
+ * @brief Add a view's statistics to its cache and free the view
+ * 
+ * @param cache Cache the view was created from
+ * @param view View to merge (may be NULL)
+ */
+void cache_view_merge(cache_t *cache, cache_t *view);
+
+/**
+ * @brief Append the state and statistics of a cache to a checkpoint
+ * 
+ * @param cache Cache instance
+ * @param w Checkpoint writer
+ */
+void cache_save(const cache_t *cache, ckpt_writer_t *w);
+
+/**
+ * @brief Load the state and statistics of a cache from a checkpoint
+ * 
+ * @param cache Cache built with the configuration that was saved
+ * @param r Checkpoint reader
+ * @return false if the saved geometry differs or the file is truncated
+ */
+bool cache_restore(cache_t *cache, ckpt_reader_t *r);
+
+/**
+ * @brief Zero the statistics, keeping the cache contents (--warmup)
+ * 
+ * @param cache Cache instance
+ */
+void cache_reset_stats(cache_t *cache);
+
+/**
+ * @brief Add the counters of a cache to a statistics group
+ * 
+ * Keys: accesses, hits, misses, reads, read_hits, writes, write_hits,
+ * and writebacks, writebacks_in, writeback_misses (not in the text
+ * report).
+ * 
+ * @param cache Cache instance
+ * @param group Group to fill
+ */
+void cache_fill_stats(const cache_t *cache, stats_group_t *group);
+
+/**
+ * @brief Register the counters of a cache as a new group
+ * 
+ * A classified cache also gets a "<key>_3c" group titled
+ * "<label> Miss Classification" (see classify_fill_stats()).
+ * 
+ * @param cache Cache instance
+ * @param reg Registry
+ * @param key Group key (e.g., "cache", "l1")
+ * @param label Text label as in cache_print_stats() (NULL: "Cache")
+ * @return The cache group, or NULL on allocation failure
+ */
+stats_group_t* cache_register_stats(const cache_t *cache, stats_registry_t *reg,
+                                    const char *key, const char *label);
+
 /**
  * @brief Print cache statistics
  * 
@@ -83,10 +237,26 @@ cache_result_t cache_access(cache_t *cache, uint32_t addr, bool is_write);
  */
 void cache_print_stats(const cache_t *cache, const char *label);
 
+/**
+ * @brief Print the statistics of several caches as one table
+ * 
+ * Used for configuration sweeps (-C, --sweep), where every cache saw the
+ * same physical address stream.
+ * 
+ * Format:
+ *   * Configuration Sweep *
+ *   size block sets ways accesses hits misses miss-ratio
+ *   S B N W X X X R          (one row per cache)
+ * 
+ * @param caches Cache instances
+ * @param n Number of caches
+ */
+void cache_print_sweep(cache_t *const *caches, uint32_t n);
+
 /**
  * @brief Destroy cache and free all resources
  * 
- * Frees all allocated memory including cache sets, lines, and data blocks.
+ * Frees the set storage and the cache descriptor.
  * 
  * @param cache Cache to destroy
  */
@@ -101,7 +271,9 @@ void cache_destroy(cache_t *cache);
  * 
  * Extracts the index bits from the physical address based on cache configuration.
  * For fully-associative: always returns 0
- * For direct-mapped/set-associative: extracts appropriate index bits
+ * For power-of-2 set counts: extracts appropriate index bits
+ * For other set counts: block number modulo the set count
+ * With hashed indexing: hash of the block number
  * 
  * @param cache Cache instance
  * @param addr Physical address
@@ -112,7 +284,9 @@ uint32_t cache_get_index(const cache_t *cache, uint32_t addr);
 /**
  * @brief Calculate tag from address
  * 
- * Extracts the tag bits from the physical address.
+ * Extracts the tag bits from the physical address. With modulo indexing
+ * the tag is the block number divided by the set count; with hashed
+ * indexing it is the whole block number.
  * 
  * @param cache Cache instance
  * @param addr Physical address
@@ -142,5 +316,16 @@ uint32_t cache_get_offset(const cache_t *cache, uint32_t addr);
  */
 uint32_t log2_uint32(uint32_t n);
 
+/**
+ * @brief Map a block number to a set with a multiplicative hash
+ * 
+ * Used by hashed indexing (--hash-index). Works for any set count.
+ * 
+ * @param block Block (or page) number
+ * @param num_sets Number of sets
+ * @return Set index below num_sets
+ */
+uint32_t hash_set_index(uint32_t block, uint32_t num_sets);
+
 #endif /* CACHE_H */
 
@@ -0,0 +1,121 @@
+/**
+ * @file checkpoint.h
+ * @brief Versioned binary checkpoints of the simulator state
+ *
+ * A checkpoint is a fixed header followed by the state of each structure,
+ * in a fixed order, as raw arrays in host byte order (checked by a
+ * byte-order probe):
+ *
+ *   magic "VMSIMCKP" | version | byte-order probe | ckpt_position_t
+ *   per structure: ckpt_geometry_t | state arrays | statistics
+ *
+ * Every structure writes its geometry ahead of its state, and restoring
+ * requires it to match the structure built from the command line, so a
+ * checkpoint can only be restored into the configuration it came from.
+ * The header identifies the trace (see trace_identity_t), so it can only
+ * be resumed on the same trace file.
+ *
+ * Writing goes through stdio. Reading maps the whole file once and copies
+ * each array straight out of the mapping, so restoring costs about one
+ * memcpy of the state.
+ */
+
+#ifndef CHECKPOINT_H
+#define CHECKPOINT_H
+
+#include <stddef.h>
+#include "trace.h"
+#include "types.h"
+
+/* Current format version (bumped whenever the layout changes) */
+#define CKPT_VERSION 4
+
+typedef struct ckpt_writer_s ckpt_writer_t;
+typedef struct ckpt_reader_s ckpt_reader_t;
+
+/**
+ * @brief Point of the trace a checkpoint was taken at
+ */
+typedef struct {
+    uint64_t records;              /* Trace records simulated */
+    uint64_t offset;               /* Byte offset of the next record, or
+                                    * TRACE_OFFSET_UNKNOWN (see trace_tell()) */
+    trace_identity_t trace;        /* File they were read from */
+} ckpt_position_t;
+
+/**
+ * @brief Geometry of a saved structure (zero-initialize before filling)
+ */
+typedef struct {
+    uint32_t sets;                 /* Number of sets */
+    uint32_t ways;                 /* Ways per set */
+    uint32_t index_mode;           /* index_mode_t */
+    uint32_t block_size;           /* Cache block size (0 for the TLB) */
+    uint64_t state_bytes;          /* Bytes of state arrays that follow */
+    char policy[16];               /* Replacement policy name */
+} ckpt_geometry_t;
+
+/**
+ * @brief Create a checkpoint file and write its header
+ *
+ * @param path Output file
+ * @param pos Trace position of the saved state
+ * @return Writer, or NULL on error
+ */
+ckpt_writer_t* ckpt_create(const char *path, const ckpt_position_t *pos);
+
+/**
+ * @brief Append raw bytes (errors are reported by ckpt_close())
+ *
+ * @param w Writer
+ * @param data Bytes to append
+ * @param len Number of bytes
+ */
+void ckpt_write(ckpt_writer_t *w, const void *data, size_t len);
+
+/**
+ * @brief Finish the file
+ *
+ * @param w Writer (freed)
+ * @return false if any write failed
+ */
+bool ckpt_close(ckpt_writer_t *w);
+
+/**
+ * @brief Map a checkpoint file and check its header
+ *
+ * @param path Checkpoint file
+ * @param[out] pos Trace position of the saved state
+ * @return Reader, or NULL if the file is missing or not a checkpoint of
+ *         this version
+ */
+ckpt_reader_t* ckpt_open(const char *path, ckpt_position_t *pos);
+
+/**
+ * @brief Copy the next bytes out of the checkpoint
+ *
+ * @param r Reader
+ * @param[out] data Destination
+ * @param len Number of bytes
+ * @return false if the file is too short
+ */
+bool ckpt_read(ckpt_reader_t *r, void *data, size_t len);
+
+/**
+ * @brief Read a saved geometry and compare it with the expected one
+ *
+ * @param r Reader
+ * @param expected Geometry of the structure being restored
+ * @return false on mismatch or truncated file
+ */
+bool ckpt_check_geometry(ckpt_reader_t *r, const ckpt_geometry_t *expected);
+
+/**
+ * @brief Unmap the checkpoint
+ *
+ * @param r Reader (freed)
+ * @return false if the file has bytes left over (wrong configuration)
+ */
+bool ckpt_release(ckpt_reader_t *r);
+
+#endif /* CHECKPOINT_H */
@@ -0,0 +1,92 @@
+/**
+ * @file classify.h
+ * @brief 3C miss classification and per-set conflict heatmaps
+ *
+ * Every access of an instrumented cache is replayed against two shadow
+ * structures:
+ *
+ *   first-touch set   Blocks referenced so far
+ *   shadow cache      Fully-associative LRU cache with the same number
+ *                     of blocks as the real one
+ *
+ * and each miss of the real cache is classified as
+ *
+ *   compulsory  First reference to the block
+ *   capacity    Also misses in the shadow cache: no cache of this size
+ *               could have kept the block
+ *   conflict    Hits in the shadow cache: the block was lost to the set
+ *               mapping or the replacement policy
+ *
+ * Accesses, misses (by class) and evictions are also counted per set, so
+ * hot or thrashing sets stand out (see classify_write_heatmap()).
+ *
+ * The shadow cache finds blocks through a way_index_t and keeps its LRU
+ * order in a linked list, so the overhead is O(1) per access. Blocks are
+ * tracked within the simulated physical memory.
+ */
+
+#ifndef CLASSIFY_H
+#define CLASSIFY_H
+
+#include <stdio.h>
+#include "stats.h"
+#include "types.h"
+
+/**
+ * @brief Create the shadow state of a cache geometry
+ *
+ * @param num_sets Number of sets of the real cache
+ * @param ways Ways per set of the real cache
+ * @param block_size Block size in bytes
+ * @return Classifier instance, or NULL on error
+ */
+classify_t* classify_create(uint32_t num_sets, uint32_t ways, uint32_t block_size);
+
+/**
+ * @brief Record one access of the real cache
+ *
+ * @param cls Classifier instance
+ * @param block Block number (physical address / block size)
+ * @param set Set the real cache selected
+ * @param miss The real cache missed
+ * @param evicted The miss replaced a valid line
+ */
+void classify_access(classify_t *cls, uint32_t block, uint32_t set, bool miss, bool evicted);
+
+/**
+ * @brief Zero the counters, keeping the shadow state (--warmup)
+ *
+ * @param cls Classifier instance
+ */
+void classify_reset_stats(classify_t *cls);
+
+/**
+ * @brief Add the miss classes to a statistics group
+ *
+ * Keys: compulsory, capacity, conflict, evictions.
+ *
+ * @param cls Classifier instance
+ * @param group Group to fill
+ */
+void classify_fill_stats(const classify_t *cls, stats_group_t *group);
+
+/**
+ * @brief Write one CSV row per set
+ *
+ * Columns: cache, set, accesses, misses, compulsory, capacity, conflict,
+ * evictions.
+ *
+ * @param cls Classifier instance
+ * @param name Value of the cache column (e.g., "cache", "l1")
+ * @param out Output stream
+ */
+void classify_write_heatmap(const classify_t *cls, const char *name, FILE *out);
+
+/**
+ * @brief Free the classifier
+ *
+ * @param cls Classifier instance (may be NULL)
+ */
+void classify_destroy(classify_t *cls);
+
+#endif /* CLASSIFY_H */
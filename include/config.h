@@ -21,7 +21,9 @@
  * - Single-level cache (Tasks 1-3):
  *   -S size      Cache size in bytes
  *   -B blocksize Block size in bytes (default: 16)
- *   -A assoc     Associativity (1/2/3/4, default: 2=fully-assoc)
+ *   -A assoc     Associativity (1/2/3/4, default: 2=fully-assoc), or
+ *                "<N>w" for N ways per set (e.g. 12w); any -A1/-A2/-L
+ *                accepts the same forms
  * 
  * - Multi-level cache (Task 4):
  *   -S1 size     L1 cache size
@@ -35,8 +37,103 @@
  *   -T entries   TLB entries
  *   -L assoc     TLB associativity
  * 
+ * - Replacement policies (lru, plru, fifo, random, srrip, brrip; default lru):
+ *   -P policy    Single-level cache policy
+ *   -P1 policy   L1 policy
+ *   -P2 policy   L2 policy
+ *   -PT policy   TLB policy
+ *   --seed n     Seed of the random and brrip policies (default: 1)
+ *   --opt        Belady OPT for caches, TLB and page frames (offline,
+ *                multi-pass replay through temporary files)
+ * 
+ * - Set indexing (power-of-2 set counts use address bits, others modulo):
+ *   --hash-index Hash block numbers onto sets in every structure
+ * 
+ * - Configuration sweeps (each trace record is translated once and fed
+ *   to every cache; the -P policy applies):
+ *   -C s,b,a     Extra single-level cache of size s, block b, assoc a
+ *                (repeatable)
+ *   --sweep min:max[:step]  Extra caches of the -B/-A geometry for sizes
+ *                min..max, doubling or in steps of step bytes
+ * 
+ * - Parameter grid (every combination is simulated independently on a
+ *   pool of threads from one in-memory copy of the trace; prints a
+ *   result table instead of the usual statistics). LIST is "a,b,c" or
+ *   "min:max[:step]" (doubling by default); dimensions not given take
+ *   the single -S/-A/-T value:
+ *   --grid-sizes LIST    Cache sizes
+ *   --grid-assoc a,b,... Cache associativities (as -A)
+ *   --grid-tlb LIST      TLB entries
+ *   --grid-threads n     Worker threads (default: one per online CPU)
+ *   --grid-format f      Result table format: csv (default) or json
+ * 
+ * - Parallel simulation:
+ *   --threads n  Split the sets of the single-level cache among n threads
+ *                (set i on thread i mod n; capped at the set count), fed
+ *                by the translating thread; results equal the sequential
+ *                run (default: 1)
+ *   --pipeline   Parse, translate and simulate the caches on three
+ *                threads connected by rings of batches (same output,
+ *                including -v order)
+ * 
+ * - Checkpoints (the TLB, page table, caches, sweep caches and their
+ *   statistics; see checkpoint.h):
+ *   --checkpoint-at n file  Save the state after the first n records (or
+ *                           at the end of a shorter trace) to file
+ *   --restore file          Start from a checkpoint taken with the same
+ *                           configuration, skipping the records it covers
+ *                           in the trace (which must be the same file, by
+ *                           size and modification time, and hold at least
+ *                           those records). Uncompressed trace files are
+ *                           positioned directly; gzip traces, pipes and
+ *                           stdin are decoded up to the checkpoint
+ * 
+ * - Measurement window (not with --opt or a grid):
+ *   --warmup n   Zero every statistic after the first n records, keeping
+ *                the contents of all structures (nothing is zeroed if the
+ *                trace is shorter)
+ *   --interval n Also print the counters of every structure for each
+ *                n records (after the warmup) as a time series
+ * 
+ * - Report format:
+ *   --stats-format f  text (default), or json / csv: every counter and the
+ *                     derived hit/miss rates, MPKI and AMAT (see stats.h)
+ *                     instead of the text report
+ * 
+ * - Writebacks (multi-level only, not with --opt):
+ *   --writebacks Write each dirty block evicted from L1 into L2 after the
+ *                access that evicted it, as a non-demand write (L2 demand
+ *                counters are unchanged; L2 contents and dirty bits
+ *                follow); adds L1->L2 and memory writebacks to the
+ *                Multi-Level Cache Summary. Without it, dirty victims are
+ *                only counted (json/csv "writebacks" of each cache)
+ * 
+ * - Timing (see timing.h):
+ *   --timing     Also report total cycles, AMAT, the cycles of each
+ *                component and a per-access latency histogram
+ *   --latency spec  Cycle counts as "name=N,..." with names l1 (the
+ *                   single-level cache or L1), l2, mem, walk (page walk
+ *                   after a TLB miss) and fault (page fault, on top of
+ *                   the walk); unnamed ones keep their defaults 4, 12,
+ *                   200, 30 and 10000 (implies --timing; also sets the
+ *                   latencies of the AMAT metric)
+ * 
+ * - Profiling:
+ *   --mrc        Also print the LRU miss-ratio curve of every fully-assoc
+ *                size (stack distances of the physical block stream)
+ *   --mrc-sets n Curve for every n-set geometry instead (implies --mrc)
+ *   --shards-rate r    Approximate the curve from a SHARDS sample of the
+ *                      blocks, at rate r in (0, 1] (implies --mrc)
+ *   --shards-budget n  Sample at most n blocks at a time, lowering the rate
+ *                      as the footprint grows (implies --mrc)
+ *   --classify   Also split the misses of the cache (each level) into
+ *                compulsory, capacity and conflict misses (see classify.h)
+ *   --heatmap file     Write the per-set accesses, misses by class and
+ *                      evictions of the cache (each level) to file as CSV
+ *                      (implies --classify)
+ * 
  * - Other:
- *   -t tracefile Trace file path
+ *   -t tracefile Trace file path ("-" for stdin; may be gzip-compressed)
  *   -v           Verbose mode
  * 
  * @param argc Argument count
@@ -51,11 +148,28 @@ sim_config_t* parse_arguments(int argc, char *argv[]);
  * Checks that the configuration is valid:
  * - Cache size > 0 and multiple of 4
  * - Block size >= 4 and multiple of 4
- * - Valid associativity codes (1-4)
+ * - Valid associativity codes (1-4) or way counts (N >= 1)
  * - For set-associative: cache size divisible by (block_size * ways)
  * - For multi-level: L2 >= L1 size, compatible block sizes
- * - TLB entries >= 2 and power of 2
- * - Trace file exists
+ * - TLB entries >= 2 and power of 2 (with "<N>w": a multiple of N)
+ * - Sweep caches: same rules as the single-level cache, no --opt
+ * - --mrc: not combined with --opt, 1 <= sets <= physical blocks,
+ *   0 < SHARDS rate <= 1
+ * - Grid: single-level only, no -v/--opt/--mrc/sweep caches, and every
+ *   grid point valid on its own
+ * - --threads: at least 1; above 1, single-level only and no -v/--opt/grid
+ * - --pipeline: not combined with --opt
+ * - Checkpoints: not combined with --opt, --mrc or a grid
+ * - --warmup, --interval: not combined with --opt or a grid
+ * - --stats-format json/csv: not combined with -v, --mrc, --interval or
+ *   a grid
+ * - --classify, --heatmap: not combined with --opt, --threads above 1, a
+ *   grid or checkpoints
+ * - --latency: known names, l1 and l2 at least 1 cycle
+ * - --timing: not combined with --opt, --threads above 1, a grid or
+ *   checkpoints
+ * - --writebacks: multi-level only, not combined with --opt
+ * - Trace file exists (unless reading stdin)
  * 
  * @param config Configuration to validate
  * @return true if valid, false otherwise
@@ -75,6 +189,27 @@ bool validate_config(const sim_config_t *config);
  */
 int detect_task(const sim_config_t *config);
 
+/**
+ * @brief Number of points of the parameter grid (0 outside grid mode)
+ * 
+ * @param config Parsed configuration
+ * @return Product of the grid dimensions
+ */
+uint32_t config_grid_points(const sim_config_t *config);
+
+/**
+ * @brief Expand one grid point into a standalone configuration
+ * 
+ * Points are numbered with the TLB size varying fastest, then the
+ * associativity, then the cache size. The point shares the trace file
+ * string of config and must not be passed to free_config().
+ * 
+ * @param config Parsed configuration in grid mode
+ * @param index Point index, below config_grid_points()
+ * @param[out] point Configuration of that point (grid mode off)
+ */
+void config_grid_point(const sim_config_t *config, uint32_t index, sim_config_t *point);
+
 /**
  * @brief Free configuration resources
  * 
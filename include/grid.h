@@ -0,0 +1,31 @@
+/**
+ * @file grid.h
+ * @brief Parallel parameter-grid driver (--grid-*)
+ *
+ * Every point of the configuration grid (cache sizes x associativities x
+ * TLB sizes) is an independent simulation with its own sim_ctx_t. The
+ * trace is decoded once into a read-only buffer shared by all of them,
+ * and the points are spread over a work-stealing thread pool.
+ */
+
+#ifndef GRID_H
+#define GRID_H
+
+#include "types.h"
+
+/**
+ * @brief Simulate every grid point and print the result table to stdout
+ *
+ * One row per point, in point order (see config_grid_point()) whatever
+ * the thread count:
+ *
+ *   csv:  size,block,sets,ways,tlb_entries,tlb_hits,tlb_misses,
+ *         page_faults,page_faults_dirty,accesses,hits,misses,miss_ratio
+ *   json: an array of objects with the same keys
+ *
+ * @param config Validated configuration in grid mode
+ * @return false on trace, allocation or simulation error
+ */
+bool grid_run(const sim_config_t *config);
+
+#endif /* GRID_H */
@@ -0,0 +1,100 @@
+/**
+ * @file mrc.h
+ * @brief Single-pass LRU miss-ratio curves (Mattson stack distances)
+ *
+ * Every physical access is assigned its LRU stack distance: the number of
+ * distinct blocks of the same set touched since the previous access to
+ * the block. An LRU cache with W ways per set hits exactly the accesses
+ * whose distance is below W, so one histogram of distances gives the miss
+ * count of every way count at once.
+ *
+ * Distances are counted with a Fenwick tree over access times per set:
+ * each block keeps a mark at the time of its latest access, and the
+ * distance is the number of marks after it (O(log n) per access). When
+ * a set runs out of time slots, its live marks are renumbered in order,
+ * so memory stays proportional to the number of distinct blocks.
+ *
+ * With one set the curve covers every fully-associative size; with N sets
+ * it covers every N-set geometry (sets are selected as in the cache).
+ *
+ * For large footprints, SHARDS spatial sampling profiles only the blocks
+ * whose hash falls below a threshold and scales distances and counts by
+ * the sampling rate, trading accuracy for memory.
+ */
+
+#ifndef MRC_H
+#define MRC_H
+
+#include "types.h"
+
+typedef struct mrc_s mrc_t;
+
+/**
+ * @brief Create a stack-distance profiler
+ *
+ * @param block_size Block size in bytes (power of 2)
+ * @param num_sets Number of sets (1 for fully-associative)
+ * @param hash_index Select sets by hash as with --hash-index
+ * @return Profiler instance, or NULL on error
+ */
+mrc_t* mrc_create(uint32_t block_size, uint32_t num_sets, bool hash_index);
+
+/**
+ * @brief Enable SHARDS sampling (call before the first access)
+ *
+ * @param mrc Profiler instance
+ * @param rate Fixed sampling rate in (0, 1], used when budget is 0
+ * @param budget Max blocks tracked at once; the rate starts at 1 and is
+ *               lowered as needed to stay within it (0: fixed rate)
+ * @return false on allocation failure
+ */
+bool mrc_set_sampling(mrc_t *mrc, double rate, uint32_t budget);
+
+/**
+ * @brief Record one physical access
+ *
+ * @param mrc Profiler instance
+ * @param paddr Physical address
+ * @return false on allocation failure
+ */
+bool mrc_access(mrc_t *mrc, uint32_t paddr);
+
+/**
+ * @brief Zero the stack-distance histogram, keeping the LRU stacks
+ *
+ * After a reset the curve describes a warm cache (--warmup): blocks
+ * already on a stack are not counted as cold misses again.
+ *
+ * @param mrc Profiler instance
+ */
+void mrc_reset_stats(mrc_t *mrc);
+
+/**
+ * @brief Print the miss-ratio curve
+ *
+ * Format:
+ *   * Miss-Ratio Curve *
+ *   block size: B
+ *   sets: N
+ *   sampling rate: R (only when sampling)
+ *   accesses: X
+ *   cold misses: X
+ *   ways size misses miss-ratio
+ *   W S X R          (one row per way count at which the misses drop)
+ *
+ * The miss count of way counts between two rows equals that of the lower
+ * row; the last row is the point past which only cold misses remain.
+ * Sampled counts are estimates scaled to the full number of accesses.
+ *
+ * @param mrc Profiler instance
+ */
+void mrc_print(const mrc_t *mrc);
+
+/**
+ * @brief Free the profiler
+ *
+ * @param mrc Profiler to destroy
+ */
+void mrc_destroy(mrc_t *mrc);
+
+#endif /* MRC_H */
@@ -11,6 +11,7 @@
 
 #include "types.h"
 #include "cache.h"
+#include "stats.h"
 
 /**
  * @brief Initialize multi-level cache hierarchy
@@ -27,7 +28,7 @@
  * @param num_levels Number of cache levels (must be 2)
  * @return Pointer to multi-level cache structure, or NULL on error
  */
-multilevel_cache_t* multilevel_cache_init(cache_config_t *configs, uint32_t num_levels);
+multilevel_cache_t* multilevel_cache_init(const cache_config_t *configs, uint32_t num_levels);
 
 /**
  * @brief Access multi-level cache hierarchy
@@ -54,6 +55,96 @@ cache_result_t multilevel_cache_access(multilevel_cache_t *mlc,
                                        uint32_t addr, 
                                        bool is_write);
 
+/**
+ * @brief Access multi-level cache hierarchy with a batch of addresses
+ * 
+ * Produces the same results and statistics as calling
+ * multilevel_cache_access() on each address in order. Each level is
+ * driven through cache_access_batch() with only the accesses that missed
+ * the level above, which keeps per-level access order unchanged. With
+ * writeback propagation only L1 is; the levels below take their demand
+ * accesses and writebacks one at a time, in order.
+ * 
+ * @param mlc Multi-level cache instance
+ * @param addrs Physical addresses
+ * @param is_write Per-access write flags
+ * @param n Number of accesses
+ * @param[out] results Per-access result codes (as multilevel_cache_access)
+ */
+void multilevel_cache_access_batch(multilevel_cache_t *mlc,
+                                   const uint32_t *addrs,
+                                   const bool *is_write, size_t n,
+                                   cache_result_t *results);
+
+/**
+ * @brief Write dirty victims into the next level (--writebacks)
+ * 
+ * From now on, a dirty block evicted from level i is written into level
+ * i + 1 with cache_write_back(), after the demand access that evicted
+ * it: it updates that level's contents and dirty bits but is not a
+ * demand access. Victims of the last level go to memory and show up in
+ * its writebacks counter. Without this, victims are only counted.
+ * 
+ * @param mlc Multi-level cache instance
+ * @return false on allocation failure
+ */
+bool multilevel_cache_propagate_writebacks(multilevel_cache_t *mlc);
+
+/**
+ * @brief Access a single level of the hierarchy
+ * 
+ * For replays that drive one level at a time with the misses of the level
+ * above (e.g. Belady OPT). Counts the access towards the level like
+ * multilevel_cache_access() does.
+ * 
+ * @param mlc Multi-level cache instance
+ * @param level Level number (0 = L1, 1 = L2, ...)
+ * @param addr Physical address
+ * @param is_write true for write, false for read
+ * @return Hit code of the level (as multilevel_cache_access), or
+ *         CACHE_MISS_ALL_LEVELS on a miss at this level
+ */
+cache_result_t multilevel_cache_access_level(multilevel_cache_t *mlc,
+                                             uint32_t level, uint32_t addr,
+                                             bool is_write);
+
+/**
+ * @brief Append the state of every level to a checkpoint
+ * 
+ * @param mlc Multi-level cache instance
+ * @param w Checkpoint writer
+ */
+void multilevel_cache_save(const multilevel_cache_t *mlc, ckpt_writer_t *w);
+
+/**
+ * @brief Load the state of every level from a checkpoint
+ * 
+ * @param mlc Multi-level cache built with the configuration that was saved
+ * @param r Checkpoint reader
+ * @return false if the saved hierarchy differs or the file is truncated
+ */
+bool multilevel_cache_restore(multilevel_cache_t *mlc, ckpt_reader_t *r);
+
+/**
+ * @brief Zero the statistics of every level, keeping their contents
+ * 
+ * @param mlc Multi-level cache instance
+ */
+void multilevel_cache_reset_stats(multilevel_cache_t *mlc);
+
+/**
+ * @brief Register one group per level ("l1", "l2", ...) and, with two
+ *        or more levels, the "hierarchy" summary group
+ * 
+ * With writeback propagation, the summary also counts the writebacks of
+ * each level into the next ("l1_writebacks": "L1 writebacks to L2") and
+ * of the last level to memory ("memory_writebacks").
+ * 
+ * @param mlc Multi-level cache instance
+ * @param reg Registry
+ */
+void multilevel_cache_register_stats(const multilevel_cache_t *mlc, stats_registry_t *reg);
+
 /**
  * @brief Print statistics for all cache levels
  * 
@@ -0,0 +1,67 @@
+/**
+ * @file next_use.h
+ * @brief Disk-backed next-use streams for offline (Belady OPT) replay
+ *
+ * Belady's policy needs, at every access, the position of the next
+ * access to the same block. A next-use stream computes those positions
+ * for a sequence of keys (VPNs, block addresses) in three phases:
+ *
+ *   1. next_use_append() each key of the sequence, in order
+ *   2. next_use_finish() to compute all next-use positions
+ *   3. next_use_read() the position for each key, in the same order
+ *
+ * Keys and results live in temporary files and are processed in fixed
+ * size chunks (the sequence is scanned backwards once), so only one table
+ * of 2^key_bits last-seen positions is kept in memory, whatever the
+ * trace length.
+ */
+
+#ifndef NEXT_USE_H
+#define NEXT_USE_H
+
+#include "types.h"
+
+typedef struct next_use_s next_use_t;
+
+/**
+ * @brief Create an empty next-use stream
+ *
+ * @param key_bits Keys are below 2^key_bits (at most 24)
+ * @return Stream instance, or NULL on error
+ */
+next_use_t* next_use_create(uint32_t key_bits);
+
+/**
+ * @brief Append the next key of the sequence
+ *
+ * @param nu Stream instance
+ * @param key Key (block address, VPN, ...)
+ * @return true on success, false on I/O error
+ */
+bool next_use_append(next_use_t *nu, uint32_t key);
+
+/**
+ * @brief Compute next-use positions for the whole sequence
+ *
+ * @param nu Stream instance
+ * @return true on success, false on I/O or allocation error
+ */
+bool next_use_finish(next_use_t *nu);
+
+/**
+ * @brief Read the next-use position of the next key in sequence order
+ *
+ * @param nu Stream instance (after next_use_finish())
+ * @param[out] next Position of the key's next occurrence, or REPL_NEVER
+ * @return true on success, false at end of sequence or on I/O error
+ */
+bool next_use_read(next_use_t *nu, uint64_t *next);
+
+/**
+ * @brief Close the temporary files and free the stream
+ *
+ * @param nu Stream to destroy
+ */
+void next_use_destroy(next_use_t *nu);
+
+#endif /* NEXT_USE_H */
@@ -0,0 +1,82 @@
+/**
+ * @file output.h
+ * @brief Buffered, allocation-free text output
+ *
+ * Verbose mode emits one line per trace access plus one per TLB/page table
+ * entry. Formatting those with printf costs several libc calls per line,
+ * so they are instead assembled in a caller-owned buffer with table-driven
+ * hex conversion and handed to stdio in large blocks.
+ *
+ * Output is flushed with fwrite() on the target stream, so it stays
+ * correctly ordered with printf() output as long as the writer is flushed
+ * before any printf() to the same stream.
+ */
+
+#ifndef OUTPUT_H
+#define OUTPUT_H
+
+#include <stdio.h>
+#include "types.h"
+
+/* Buffer size of a writer */
+#define OUT_BUFFER_SIZE (1 << 16)
+
+/* Longest single formatted item (a 32-bit hex number) */
+#define OUT_MAX_ITEM 8
+
+/**
+ * @brief Output writer (embed or declare on the stack; no heap use)
+ */
+typedef struct out_writer_s {
+    FILE *file;                    /* Target stream */
+    size_t len;                    /* Bytes buffered */
+    char buf[OUT_BUFFER_SIZE];
+} out_writer_t;
+
+/**
+ * @brief Append a string literal (length computed at compile time)
+ */
+#define OUT_LIT(w, s) out_write((w), (s), sizeof(s) - 1)
+
+/**
+ * @brief Initialize a writer
+ *
+ * @param w Writer
+ * @param file Stream flushed to (usually stdout)
+ */
+void out_init(out_writer_t *w, FILE *file);
+
+/**
+ * @brief Append raw bytes
+ *
+ * @param w Writer
+ * @param s Bytes to append
+ * @param len Number of bytes
+ */
+void out_write(out_writer_t *w, const char *s, size_t len);
+
+/**
+ * @brief Append one character
+ *
+ * @param w Writer
+ * @param c Character
+ */
+void out_char(out_writer_t *w, char c);
+
+/**
+ * @brief Append a value in lowercase hex, zero-padded like "%0*x"
+ *
+ * @param w Writer
+ * @param value Value to format
+ * @param min_digits Minimum number of digits (1-8)
+ */
+void out_hex(out_writer_t *w, uint32_t value, int min_digits);
+
+/**
+ * @brief Write all buffered bytes to the target stream
+ *
+ * @param w Writer
+ */
+void out_flush(out_writer_t *w);
+
+#endif /* OUTPUT_H */
@@ -4,6 +4,7 @@
  * 
  * Linear page table with 2^14 entries (26-bit virtual address space).
  * Manages 256 physical pages (1MB physical memory) with LRU eviction.
+ * Each pagetable_t is independent, so one process can simulate several.
  * 
  * STUDENTS IMPLEMENT THIS MODULE
  */
@@ -12,6 +13,8 @@
 #define PAGETABLE_H
 
 #include "types.h"
+#include "checkpoint.h"
+#include "stats.h"
 
 /**
  * @brief Initialize page table system
@@ -22,8 +25,10 @@
  * - Used page list for LRU tracking
  * 
  * Initially all pages are in the free list.
+ * 
+ * @return Page table instance, or NULL on allocation failure
  */
-void pagetable_init(void);
+pagetable_t* pagetable_init(void);
 
 /**
  * @brief Look up VPN in page table
@@ -32,12 +37,13 @@ void pagetable_init(void);
  * returns the PPN and updates LRU. If not present (page fault),
  * returns -1.
  * 
+ * @param pt Page table instance
  * @param vpn Virtual page number
  * @param[out] ppn Physical page number (if present)
  * @param[out] dirty Dirty bit value (if present)
  * @return PT_HIT or PT_MISS
  */
-pt_result_t pagetable_lookup(uint32_t vpn, uint32_t *ppn, bool *dirty);
+pt_result_t pagetable_lookup(pagetable_t *pt, uint32_t vpn, uint32_t *ppn, bool *dirty);
 
 /**
  * @brief Handle page fault
@@ -55,19 +61,87 @@ pt_result_t pagetable_lookup(uint32_t vpn, uint32_t *ppn, bool *dirty);
  * 5. Add page to used list (head = MRU)
  * 6. Return allocated PPN
  * 
+ * @param pt Page table instance
  * @param vpn Virtual page number
  * @return Physical page number allocated
  */
-uint32_t pagetable_handle_fault(uint32_t vpn);
+uint32_t pagetable_handle_fault(pagetable_t *pt, uint32_t vpn);
 
 /**
  * @brief Set dirty bit for a page
  * 
  * Marks the page as modified (needs writeback on eviction).
  * 
+ * @param pt Page table instance
  * @param vpn Virtual page number
  */
-void pagetable_set_dirty(uint32_t vpn);
+void pagetable_set_dirty(pagetable_t *pt, uint32_t vpn);
+
+/**
+ * @brief Switch page replacement between LRU (default) and Belady OPT
+ * 
+ * With OPT, the evicted frame is the one whose page is accessed furthest
+ * in the future, using the times given to pagetable_set_next_use().
+ * 
+ * @param pt Page table instance
+ * @param enable true for OPT, false for LRU
+ */
+void pagetable_use_opt(pagetable_t *pt, bool enable);
+
+/**
+ * @brief Set the next-use time of the page about to be accessed (OPT)
+ * 
+ * @param pt Page table instance
+ * @param next_use Position of the page's next access (REPL_NEVER if none)
+ */
+void pagetable_set_next_use(pagetable_t *pt, uint64_t next_use);
+
+/**
+ * @brief Prefetch the page table entry for a VPN
+ * 
+ * Pure performance hint for batched translation; has no effect on page
+ * table state or statistics.
+ * 
+ * @param pt Page table instance
+ * @param vpn Virtual page number
+ */
+void pagetable_prefetch(const pagetable_t *pt, uint32_t vpn);
+
+/**
+ * @brief Append the page table, frame lists and statistics to a checkpoint
+ * 
+ * Page contents are not saved (the simulated disk I/O keeps none).
+ * 
+ * @param pt Page table instance
+ * @param w Checkpoint writer
+ */
+void pagetable_save(const pagetable_t *pt, ckpt_writer_t *w);
+
+/**
+ * @brief Load the page table, frame lists and statistics from a checkpoint
+ * 
+ * @param pt Page table instance
+ * @param r Checkpoint reader
+ * @return false if the saved state is truncated or inconsistent
+ */
+bool pagetable_restore(pagetable_t *pt, ckpt_reader_t *r);
+
+/**
+ * @brief Zero the statistics, keeping the mappings and frames (--warmup)
+ * 
+ * @param pt Page table instance
+ */
+void pagetable_reset_stats(pagetable_t *pt);
+
+/**
+ * @brief Register the page table counters as group "pagetable"
+ * 
+ * Keys: accesses, page_faults, page_faults_dirty.
+ * 
+ * @param pt Page table instance
+ * @param reg Registry
+ */
+void pagetable_register_stats(const pagetable_t *pt, stats_registry_t *reg);
 
 /**
  * @brief Print page table statistics
@@ -77,8 +151,10 @@ void pagetable_set_dirty(uint32_t vpn);
  *   total accesses: X
  *   page faults: X
  *   page faults with dirty bit: X
+ * 
+ * @param pt Page table instance
  */
-void pagetable_print_stats(void);
+void pagetable_print_stats(const pagetable_t *pt);
 
 /**
  * @brief Print page table entries (verbose mode)
@@ -90,13 +166,17 @@ void pagetable_print_stats(void);
  *   ...
  * 
  * Only prints entries where present bit is set.
+ * 
+ * @param pt Page table instance
  */
-void pagetable_print_entries(void);
+void pagetable_print_entries(const pagetable_t *pt);
 
 /**
  * @brief Destroy page table and free resources
+ * 
+ * @param pt Page table to destroy
  */
-void pagetable_destroy(void);
+void pagetable_destroy(pagetable_t *pt);
 
 /* ============================================================================
  * Dummy I/O functions (PROVIDED - do not modify)
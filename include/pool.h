@@ -0,0 +1,46 @@
+/**
+ * @file pool.h
+ * @brief Work-stealing thread pool for independent tasks
+ *
+ * Tasks are numbered 0..n-1 and split into one contiguous range per
+ * worker. A worker takes tasks from the front of its own range; once it
+ * runs dry it steals the back half of another worker's range, so long and
+ * short tasks balance out without a shared queue.
+ *
+ * Meant for coarse tasks (a whole simulation each): the calling thread
+ * works too, and pool_run() returns once every task has finished.
+ */
+
+#ifndef POOL_H
+#define POOL_H
+
+#include <stddef.h>
+#include "types.h"
+
+/**
+ * @brief Task body
+ *
+ * @param arg Argument given to pool_run()
+ * @param task Task number
+ */
+typedef void (*pool_task_fn)(void *arg, size_t task);
+
+/**
+ * @brief Run tasks 0..num_tasks-1 on num_threads workers
+ *
+ * If threads cannot be created, the workers that did start (at least the
+ * calling thread) still run every task.
+ *
+ * @param num_threads Workers, including the calling thread (0 counts as 1)
+ * @param num_tasks Number of tasks (below 2^32)
+ * @param fn Task body, called exactly once per task
+ * @param arg Passed to every call of fn
+ */
+void pool_run(uint32_t num_threads, size_t num_tasks, pool_task_fn fn, void *arg);
+
+/**
+ * @brief Number of online CPUs (at least 1)
+ */
+uint32_t pool_cpu_count(void);
+
+#endif /* POOL_H */
@@ -0,0 +1,98 @@
+/**
+ * @file replacement.h
+ * @brief Pluggable replacement policies for caches and TLBs
+ *
+ * A policy keeps a small, fixed-size block of state per set and is driven
+ * through four operations on (set state, way):
+ *
+ *   init   - set up the state of an empty set
+ *   touch  - a valid way was hit
+ *   insert - a way was (re)filled with a new tag
+ *   victim - choose the way to evict from a full set
+ *
+ * touch and insert also receive the time of the block's next access
+ * (REPL_NEVER if none); only OPT uses it, the others ignore it.
+ *
+ * Free ways are always filled first, in way order, by the owner (cache or
+ * TLB); victim() is only consulted once every way of the set is valid.
+ *
+ * Available policies:
+ * - lru:    True LRU, doubly-linked list of way indices (O(1) per access)
+ * - plru:   Tree pseudo-LRU, one bit per internal tree node
+ * - fifo:   First-in first-out, one round-robin pointer per set
+ * - random: Uniform random victim from a per-set xorshift generator
+ * - srrip:  Static re-reference interval prediction, 2-bit RRPV per way
+ * - brrip:  Bimodal RRIP (inserts at distant RRPV except 1 in 32 fills)
+ * - opt:    Belady's optimal policy: evict the block reused furthest in
+ *           the future (indexed max-heap, O(log ways)); selected by --opt
+ *
+ * Random state is per set and seeded from (seed, set index), so results
+ * depend only on the seed, never on the order sets are simulated in.
+ *
+ * State blocks must be 8-byte aligned (OPT stores 64-bit times).
+ */
+
+#ifndef REPLACEMENT_H
+#define REPLACEMENT_H
+
+#include "types.h"
+
+/* Next-use time of a block that is never accessed again */
+#define REPL_NEVER UINT64_MAX
+
+/* Round a state size or offset up to the required state alignment */
+#define REPL_ALIGN 8
+#define REPL_ALIGN_UP(n) (((n) + REPL_ALIGN - 1) & ~(size_t)(REPL_ALIGN - 1))
+
+/**
+ * @brief Replacement policy operations
+ */
+struct repl_ops_s {
+    const char *name;
+
+    /* Bytes of per-set state for a set with the given number of ways */
+    size_t (*state_size)(uint32_t ways);
+
+    void (*init)(void *state, uint32_t ways, uint32_t seed);
+    void (*touch)(void *state, uint32_t ways, uint32_t way, uint64_t next_use);
+    void (*insert)(void *state, uint32_t ways, uint32_t way, uint64_t next_use);
+    uint32_t (*victim)(void *state, uint32_t ways);
+};
+
+/**
+ * @brief Get the operations of a policy
+ *
+ * @param policy Policy identifier
+ * @return Operation table (never NULL for a valid policy)
+ */
+const repl_ops_t* repl_get_ops(repl_policy_t policy);
+
+/**
+ * @brief Parse a policy name ("lru", "plru", "fifo", "random", "srrip", "brrip")
+ *
+ * "opt" is not accepted: it is enabled for every structure by --opt.
+ *
+ * @param name Policy name (case-sensitive)
+ * @param[out] policy Parsed policy
+ * @return true if the name is known
+ */
+bool repl_parse(const char *name, repl_policy_t *policy);
+
+/**
+ * @brief Get the name of a policy
+ *
+ * @param policy Policy identifier
+ * @return Policy name
+ */
+const char* repl_name(repl_policy_t policy);
+
+/**
+ * @brief Derive the RNG seed of one set
+ *
+ * @param seed Global seed (--seed)
+ * @param set_index Set number
+ * @return Non-zero per-set seed
+ */
+uint32_t repl_set_seed(uint32_t seed, uint32_t set_index);
+
+#endif /* REPLACEMENT_H */
@@ -0,0 +1,79 @@
+/**
+ * @file ring.h
+ * @brief Bounded lock-free single-producer/single-consumer ring
+ *
+ * A fixed number of equally sized slots shared by exactly one producer
+ * thread and one consumer thread. Slots are filled and drained in place,
+ * so a slot can hold a whole batch of records without extra copies:
+ *
+ *   producer: slot = ring_write_acquire(r); fill slot; ring_write_commit(r);
+ *   consumer: slot = ring_read_acquire(r);  use slot;  ring_read_release(r);
+ *
+ * Head and tail are C11 atomics; a side that finds the ring full/empty
+ * backs off (spin, then yield, then short sleeps) instead of taking a lock.
+ */
+
+#ifndef RING_H
+#define RING_H
+
+#include "types.h"
+
+typedef struct ring_s ring_t;
+
+/**
+ * @brief Create a ring
+ *
+ * @param num_slots Number of slots (rounded up to a power of 2)
+ * @param slot_size Size of each slot in bytes
+ * @return Ring instance, or NULL on allocation failure
+ */
+ring_t* ring_create(size_t num_slots, size_t slot_size);
+
+/**
+ * @brief Wait for a free slot to fill (producer side)
+ *
+ * @param ring Ring instance
+ * @return Slot to fill, or NULL if the consumer has closed the ring
+ */
+void* ring_write_acquire(ring_t *ring);
+
+/**
+ * @brief Publish the slot returned by ring_write_acquire()
+ *
+ * @param ring Ring instance
+ */
+void ring_write_commit(ring_t *ring);
+
+/**
+ * @brief Wait for a filled slot (consumer side)
+ *
+ * @param ring Ring instance
+ * @return Oldest filled slot, or NULL once the ring is closed and drained
+ */
+void* ring_read_acquire(ring_t *ring);
+
+/**
+ * @brief Return the slot from ring_read_acquire() to the producer
+ *
+ * @param ring Ring instance
+ */
+void ring_read_release(ring_t *ring);
+
+/**
+ * @brief Close the ring
+ *
+ * Called by the producer when it has nothing more to publish, or by the
+ * consumer to make a blocked producer give up.
+ *
+ * @param ring Ring instance
+ */
+void ring_close(ring_t *ring);
+
+/**
+ * @brief Free a ring (both sides must be done with it)
+ *
+ * @param ring Ring to destroy
+ */
+void ring_destroy(ring_t *ring);
+
+#endif /* RING_H */
@@ -0,0 +1,56 @@
+/**
+ * @file shard.h
+ * @brief Set-sharded parallel simulation of one cache (--threads)
+ *
+ * Cache sets never interact: an access only reads and updates the state
+ * of the set it maps to (replacement state, including random number
+ * generators, is per set). Set i is owned by shard i mod N, and each
+ * shard runs on its own thread through its own view of the cache (see
+ * cache_view_create()). The producer routes every access to the shard
+ * owning its set through a single-producer/single-consumer ring, so each
+ * set sees exactly the access sequence of a sequential run, and the
+ * merged statistics are identical to it.
+ *
+ *   shard_run_t *run = shard_start(cache, n);
+ *   shard_access_batch(run, addrs, is_write, count);   (repeatedly)
+ *   shard_finish(run);                                 (merges statistics)
+ */
+
+#ifndef SHARD_H
+#define SHARD_H
+
+#include "types.h"
+
+typedef struct shard_run_s shard_run_t;
+
+/**
+ * @brief Start the shard threads of a cache
+ *
+ * @param cache Cache to simulate (not accessed by the caller until
+ *              shard_finish())
+ * @param num_shards Number of shard threads (at most the number of sets)
+ * @return Running shards, or NULL on error
+ */
+shard_run_t* shard_start(cache_t *cache, uint32_t num_shards);
+
+/**
+ * @brief Route a batch of accesses to their shards
+ *
+ * Per-access results are not reported; only statistics are kept.
+ *
+ * @param run Running shards
+ * @param addrs Physical addresses
+ * @param is_write Per-access write flags
+ * @param n Number of accesses
+ */
+void shard_access_batch(shard_run_t *run, const uint32_t *addrs,
+                        const bool *is_write, size_t n);
+
+/**
+ * @brief Drain every shard, stop the threads and merge their statistics
+ *
+ * @param run Running shards (freed)
+ */
+void shard_finish(shard_run_t *run);
+
+#endif /* SHARD_H */
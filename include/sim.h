@@ -0,0 +1,157 @@
+/**
+ * @file sim.h
+ * @brief Reentrant simulator context
+ *
+ * A sim_ctx_t owns every structure of one simulation (TLB, page table,
+ * caches, miss-ratio profiler, sweep caches) and holds no file-static
+ * state, so several independent simulations can run in one process, on
+ * separate threads if each context is used by a single thread at a time.
+ *
+ * Typical use:
+ *
+ *   sim_ctx_t *ctx = sim_create(config);
+ *   trace_reader_t *trace = trace_open(config->trace_file);
+ *   if (sim_run(ctx, trace)) sim_print_report(ctx);
+ *   trace_close(trace);
+ *   sim_destroy(ctx);
+ *
+ * The core is also built as libvmsim.a / libvmsim.so (make lib).
+ */
+
+#ifndef SIM_H
+#define SIM_H
+
+#include "types.h"
+#include "trace.h"
+#include "stats.h"
+
+typedef struct sim_ctx_s sim_ctx_t;
+
+/**
+ * @brief Headline counters of a finished simulation
+ */
+typedef struct sim_stats_s {
+    uint64_t tlb_accesses;
+    uint64_t tlb_hits;
+    uint64_t tlb_misses;
+    uint64_t page_faults;
+    uint64_t page_faults_dirty;
+    uint32_t cache_sets;           /* Geometry of the (L1) cache */
+    uint32_t cache_ways;
+    uint64_t cache_accesses;       /* (L1) cache counters */
+    uint64_t cache_hits;
+    uint64_t cache_misses;
+} sim_stats_t;
+
+/**
+ * @brief Create a simulator from a validated configuration
+ *
+ * The configuration is borrowed, not copied: it must stay valid until
+ * sim_destroy().
+ *
+ * @param config Validated configuration (see validate_config())
+ * @return Simulator context, or NULL on error
+ */
+sim_ctx_t* sim_create(const sim_config_t *config);
+
+/**
+ * @brief Simulate every access of a trace
+ *
+ * Runs the normal simulation, or the offline Belady replay with --opt.
+ * Verbose per-access lines are written to stdout. With --restore the
+ * checkpoint is loaded first and the records it covers are skipped; with
+ * --checkpoint-at the state after that many records is saved on the way.
+ * With --heatmap the per-set counters are written at the end.
+ *
+ * @param ctx Simulator context
+ * @param trace Open trace reader (read to the end; not closed)
+ * @return true on success, false on allocation or I/O error or a truncated
+ *         or corrupt trace (see trace_failed())
+ */
+bool sim_run(sim_ctx_t *ctx, trace_reader_t *trace);
+
+/**
+ * @brief Simulate accesses already decoded in memory
+ *
+ * Same result as sim_run() on a trace holding the records; may be called
+ * repeatedly to continue the simulation. Not available with --opt.
+ * The records are only read, so several contexts may share them.
+ *
+ * @param ctx Simulator context
+ * @param recs Decoded trace records
+ * @param n Number of records
+ * @return true on success, false on allocation error
+ */
+bool sim_run_records(sim_ctx_t *ctx, const trace_record_t *recs, size_t n);
+
+/**
+ * @brief Save the whole simulator state to a checkpoint file
+ *
+ * Saves the TLB, page table, caches and sweep caches, the number of
+ * records simulated so far and the identity of the trace they came from.
+ * Not available with --opt or --mrc, and not while sim_run() is in
+ * progress.
+ *
+ * @param ctx Simulator context
+ * @param trace Trace being simulated (NULL for sim_run_records())
+ * @param path Output file (see checkpoint.h for the format)
+ * @return false on I/O error
+ */
+bool sim_checkpoint(const sim_ctx_t *ctx, const trace_reader_t *trace, const char *path);
+
+/**
+ * @brief Load the simulator state from a checkpoint file
+ *
+ * The context must be freshly created with the configuration the
+ * checkpoint was taken with. The next sim_run() skips the records the
+ * checkpoint already covers, so it continues on the same trace; it fails
+ * if the trace is a different file or ends before the checkpoint.
+ *
+ * @param ctx Simulator context
+ * @param path Checkpoint written by sim_checkpoint()
+ * @return false if the file is unreadable or from another configuration
+ */
+bool sim_restore(sim_ctx_t *ctx, const char *path);
+
+/**
+ * @brief Read the headline counters
+ *
+ * @param ctx Simulator context
+ * @param[out] stats Counters so far
+ */
+void sim_get_stats(const sim_ctx_t *ctx, sim_stats_t *stats);
+
+/**
+ * @brief Register every counter of the simulation and derive the metrics
+ *
+ * Groups, in report order: "tlb", "pagetable", then "cache" or "l1",
+ * "l2" and "hierarchy" (each cache followed by "<key>_3c" with
+ * --classify), then "sweep0", "sweep1", ... (omitted from the
+ * text report), then "timing" and "latency" with --timing (see
+ * timing_register_stats()). AMAT uses the --latency cycle counts.
+ *
+ * @param ctx Simulator context
+ * @param reg Initialized registry (free with stats_free())
+ */
+void sim_register_stats(const sim_ctx_t *ctx, stats_registry_t *reg);
+
+/**
+ * @brief Print all statistics to stdout
+ *
+ * TLB, page table and cache statistics, the timing report (--timing),
+ * then (verbose) the TLB and page table entries, the miss-ratio curve (--mrc) and the sweep table. With
+ * --stats-format json or csv, only the registry (sim_register_stats())
+ * is printed, in that format.
+ *
+ * @param ctx Simulator context
+ */
+void sim_print_report(const sim_ctx_t *ctx);
+
+/**
+ * @brief Free the context and every structure it owns
+ *
+ * @param ctx Context to destroy (may be NULL)
+ */
+void sim_destroy(sim_ctx_t *ctx);
+
+#endif /* SIM_H */
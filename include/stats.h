@@ -0,0 +1,178 @@
+/**
+ * @file stats.h
+ * @brief Statistics registry with pluggable output sinks
+ *
+ * Each module adds a group of named counters to a registry (see
+ * cache_register_stats(), tlb_register_stats(), ...). stats_derive() then
+ * computes the derived metrics once for every group, and a sink prints
+ * the whole registry:
+ *
+ *   text  The regular report ("* TLB Statistics *" blocks); derived
+ *         metrics are not shown, so the output is unchanged
+ *   json  One object per group: {"tlb": {"accesses": N, ...}, ...}
+ *   csv   One "group,name,value" row per counter and metric
+ *
+ * Derived metrics, for groups with the matching counters:
+ *   hit_rate   hits / accesses
+ *   miss_rate  misses (or page_faults) / accesses
+ *   mpki       misses (or page_faults) per 1000 measured trace records
+ *   amat       Average access time in cycles of each cache level with a
+ *              latency: latency + miss_rate * (AMAT of the next level,
+ *              or the memory latency after the last one); for groups
+ *              with a cycles counter, cycles / accesses
+ */
+
+#ifndef STATS_H
+#define STATS_H
+
+#include <stdio.h>
+#include "types.h"
+
+/* Capacity of one group */
+#define STATS_MAX_COUNTERS 16
+#define STATS_MAX_METRICS 4
+#define STATS_TITLE_SIZE 40
+
+/**
+ * @brief Named counter
+ */
+typedef struct {
+    char key[24];                  /* Machine-readable name ("read_hits") */
+    char label[32];                /* Text label ("read hits"), "" if none */
+    uint64_t value;
+} stats_counter_t;
+
+/**
+ * @brief Derived metric (computed by stats_derive())
+ */
+typedef struct {
+    const char *key;
+    double value;
+} stats_metric_t;
+
+/**
+ * @brief Counters of one structure
+ */
+typedef struct {
+    char key[16];                  /* Machine-readable name ("tlb", "l1") */
+    char title[STATS_TITLE_SIZE];  /* Text heading ("TLB Statistics"), "" if
+                                    * the text report omits the group */
+    uint32_t latency;              /* Hit latency of a cache level in cycles
+                                    * (0: not part of the AMAT chain) */
+    uint32_t num_counters;
+    stats_counter_t counters[STATS_MAX_COUNTERS];
+    uint32_t num_metrics;
+    stats_metric_t metrics[STATS_MAX_METRICS];
+} stats_group_t;
+
+/**
+ * @brief Groups of a whole simulation, in report order
+ */
+typedef struct {
+    stats_group_t *groups;
+    uint32_t num_groups;
+    uint32_t capacity;
+    uint64_t records;              /* Measured trace records (for MPKI) */
+    uint32_t memory_latency;       /* Cycles behind the last cache level */
+    bool failed;                   /* A group could not be allocated */
+} stats_registry_t;
+
+/**
+ * @brief Output sink
+ *
+ * begin() and end() frame the output; group() is called for each group
+ * in order.
+ */
+typedef struct {
+    void (*begin)(FILE *out, const stats_registry_t *reg);
+    void (*group)(FILE *out, const stats_group_t *group);
+    void (*end)(FILE *out, const stats_registry_t *reg);
+} stats_sink_t;
+
+/**
+ * @brief Initialize an empty registry
+ *
+ * @param reg Registry
+ */
+void stats_init(stats_registry_t *reg);
+
+/**
+ * @brief Initialize a standalone group
+ *
+ * @param group Group
+ * @param key Machine-readable name
+ * @param title Text heading ("" to omit the group from text output)
+ */
+void stats_group_init(stats_group_t *group, const char *key, const char *title);
+
+/**
+ * @brief Append a new group to a registry
+ *
+ * @param reg Registry
+ * @param key Machine-readable name
+ * @param title Text heading ("" to omit the group from text output)
+ * @return The group (valid until the next stats_add_group()), or NULL on
+ *         allocation failure (reg->failed is set)
+ */
+stats_group_t* stats_add_group(stats_registry_t *reg, const char *key, const char *title);
+
+/**
+ * @brief Find a group by key
+ *
+ * @param reg Registry
+ * @param key Machine-readable name
+ * @return The group, or NULL
+ */
+stats_group_t* stats_find_group(stats_registry_t *reg, const char *key);
+
+/**
+ * @brief Append a counter to a group (ignored when the group is full)
+ *
+ * @param group Group
+ * @param key Machine-readable name
+ * @param label Text label ("" to omit the counter from text output)
+ * @param value Counter value
+ */
+void stats_add_counter(stats_group_t *group, const char *key, const char *label,
+                       uint64_t value);
+
+/**
+ * @brief Compute the derived metrics of every group
+ *
+ * @param reg Registry (records and memory_latency set)
+ */
+void stats_derive(stats_registry_t *reg);
+
+/**
+ * @brief Get the sink of an output format
+ *
+ * @param format Output format
+ * @return Sink (never NULL)
+ */
+const stats_sink_t* stats_get_sink(stats_format_t format);
+
+/**
+ * @brief Print every group of a registry through a sink
+ *
+ * @param reg Registry
+ * @param sink Output sink
+ * @param out Output stream
+ */
+void stats_emit(const stats_registry_t *reg, const stats_sink_t *sink, FILE *out);
+
+/**
+ * @brief Print one group as text (the regular report format)
+ *
+ * @param group Group
+ * @param out Output stream
+ */
+void stats_print_group(const stats_group_t *group, FILE *out);
+
+/**
+ * @brief Free the groups of a registry
+ *
+ * @param reg Registry
+ */
+void stats_free(stats_registry_t *reg);
+
+#endif /* STATS_H */
@@ -0,0 +1,78 @@
+/**
+ * @file tag_match.h
+ * @brief Vectorized tag search over a contiguous tag array
+ *
+ * Every cache and TLB lookup ends in "which of these ways holds this tag".
+ * Tags of a set are stored contiguously, so the search compares 8 (AVX2)
+ * or 4 (SSE2) ways per instruction and turns the result into a way index
+ * with a movemask. Ways past the vector blocks are checked one at a time.
+ *
+ * The kernel is chosen at build time (see SIMD in the Makefile):
+ * - AVX2 when compiled with -mavx2
+ * - SSE2 on any x86-64 build (baseline instruction set)
+ * - Portable scalar loop otherwise, or when TAG_MATCH_SCALAR is defined
+ *
+ * All kernels return the same way, since a tag is resident in at most one
+ * valid way of a set.
+ */
+
+#ifndef TAG_MATCH_H
+#define TAG_MATCH_H
+
+#include "types.h"
+
+#if !defined(TAG_MATCH_SCALAR) && (defined(__GNUC__) || defined(__clang__))
+#if defined(__AVX2__)
+#define TAG_MATCH_AVX2 1
+#endif
+#if defined(__SSE2__)
+#define TAG_MATCH_SSE2 1
+#endif
+#endif
+
+#if defined(TAG_MATCH_AVX2) || defined(TAG_MATCH_SSE2)
+#include <immintrin.h>
+#endif
+
+/**
+ * @brief Find a tag among the first n entries of a tag array
+ *
+ * @param tags Tag array (no alignment required)
+ * @param n Number of valid entries to search
+ * @param tag Tag to find
+ * @return Index of the matching entry, or WAY_NONE if absent
+ */
+static inline uint32_t tag_match(const uint32_t *tags, uint32_t n, uint32_t tag) {
+    uint32_t i = 0;
+
+#if defined(TAG_MATCH_AVX2)
+    const __m256i key8 = _mm256_set1_epi32((int)tag);
+    for (; i + 8 <= n; i += 8) {
+        __m256i v = _mm256_loadu_si256((const __m256i *)(tags + i));
+        int mask = _mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, key8)));
+        if (mask) {
+            return i + (uint32_t)__builtin_ctz((unsigned)mask);
+        }
+    }
+#endif
+
+#if defined(TAG_MATCH_SSE2)
+    const __m128i key4 = _mm_set1_epi32((int)tag);
+    for (; i + 4 <= n; i += 4) {
+        __m128i v = _mm_loadu_si128((const __m128i *)(tags + i));
+        int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(v, key4)));
+        if (mask) {
+            return i + (uint32_t)__builtin_ctz((unsigned)mask);
+        }
+    }
+#endif
+
+    for (; i < n; i++) {
+        if (tags[i] == tag) {
+            return i;
+        }
+    }
+    return WAY_NONE;
+}
+
+#endif /* TAG_MATCH_H */
@@ -0,0 +1,100 @@
+/**
+ * @file timing.h
+ * @brief Cycle accounting of the translate -> cache path (--timing)
+ *
+ * Every access ends in one of three translation outcomes (TLB hit, page
+ * walk, page fault) and one of three data outcomes (L1 hit, L2 hit,
+ * memory). Its latency is fixed by that pair and the configured
+ * latencies (see latency_config_t), so the accumulator only counts the
+ * accesses of each of the nine pairs. Total cycles, the cycles of each
+ * component, AMAT and the exact latency histogram all follow from these
+ * counts when the report is printed.
+ *
+ * Stall cycles are the cycles beyond the L1 latency that every access
+ * pays: L2, memory, page walks and page faults.
+ */
+
+#ifndef TIMING_H
+#define TIMING_H
+
+#include <stddef.h>
+#include <stdio.h>
+#include "stats.h"
+#include "types.h"
+
+/* Translation outcomes: TLB hit, page walk, page fault */
+#define TIMING_TRANSLATIONS 3
+
+/* Data outcomes: L1 (or single-level) hit, L2 hit, memory */
+#define TIMING_LEVELS 3
+
+/**
+ * @brief Accesses per (translation, data) outcome
+ */
+typedef struct {
+    uint64_t counts[TIMING_TRANSLATIONS][TIMING_LEVELS];
+} timing_t;
+
+/**
+ * @brief Zero the counts
+ *
+ * @param t Accumulator
+ */
+void timing_reset(timing_t *t);
+
+/**
+ * @brief Count a batch of accesses
+ *
+ * @param t Accumulator
+ * @param tlb_res TLB result of each access
+ * @param pt_res Page table result of each access
+ * @param cache_res Cache result of each access (single- or multi-level)
+ * @param n Number of accesses
+ */
+void timing_record_batch(timing_t *t, const tlb_result_t *tlb_res,
+                         const pt_result_t *pt_res, const cache_result_t *cache_res,
+                         size_t n);
+
+/**
+ * @brief Register the cycle counts as two groups
+ *
+ * "timing": accesses, cycles, l1_cycles, l2_cycles, memory_cycles,
+ * page_walk_cycles, page_fault_cycles, stall_cycles (stats_derive() adds
+ * amat). "latency": one counter per distinct access latency, keyed
+ * "cycles_<N>", holding its number of accesses. Both are omitted from
+ * the text report (see timing_print()).
+ *
+ * @param t Accumulator
+ * @param lat Latencies
+ * @param levels Cache levels (1 or 2)
+ * @param reg Registry
+ */
+void timing_register_stats(const timing_t *t, const latency_config_t *lat,
+                           uint32_t levels, stats_registry_t *reg);
+
+/**
+ * @brief Print the cycle accounting and the latency histogram
+ *
+ * Format:
+ *   * Timing Statistics *
+ *   total cycles: X
+ *   average access time: X.XX cycles
+ *   L1 cycles: X (X.XX%)          one line per component, with its share
+ *   ...                           of the total cycles ("cache cycles" for
+ *                                 a single-level cache, no L2 line)
+ *   stall cycles: X (X.XX%)
+ *   latency percentiles: p50 X, p90 X, p99 X, p99.9 X
+ *
+ *   * Access Latency Histogram *
+ *   cycles accesses share cumulative
+ *   ...
+ *
+ * @param t Accumulator
+ * @param lat Latencies
+ * @param levels Cache levels (1 or 2)
+ * @param out Output stream
+ */
+void timing_print(const timing_t *t, const latency_config_t *lat, uint32_t levels,
+                  FILE *out);
+
+#endif /* TIMING_H */
@@ -10,6 +10,8 @@
 #define TLB_H
 
 #include "types.h"
+#include "checkpoint.h"
+#include "stats.h"
 
 /**
  * @brief Initialize TLB with given configuration
@@ -26,7 +28,7 @@ tlb_t* tlb_init(tlb_config_t config);
  * @brief Look up virtual page number in TLB
  * 
  * Searches TLB for the given VPN. If found (hit), returns the PPN
- * and updates LRU. If not found (miss), returns -1.
+ * and updates replacement state. If not found (miss), returns TLB_MISS.
  * 
  * @param tlb TLB instance
  * @param vpn Virtual page number to look up
@@ -40,7 +42,7 @@ tlb_result_t tlb_lookup(tlb_t *tlb, uint32_t vpn, uint32_t *ppn, bool *dirty);
  * @brief Insert or update TLB entry
  * 
  * Inserts a VPN->PPN mapping into the TLB. If TLB is full,
- * evicts an entry using LRU policy.
+ * evicts an entry chosen by the replacement policy (LRU by default).
  * 
  * @param tlb TLB instance
  * @param vpn Virtual page number
@@ -59,6 +61,62 @@ void tlb_insert(tlb_t *tlb, uint32_t vpn, uint32_t ppn);
  */
 void tlb_set_dirty(tlb_t *tlb, uint32_t vpn);
 
+/**
+ * @brief Set the next-use time of the VPN about to be translated
+ * 
+ * Only the OPT policy (--opt) reads it; see cache_set_next_use().
+ * 
+ * @param tlb TLB instance
+ * @param next_use Position of the VPN's next access (REPL_NEVER if none)
+ */
+void tlb_set_next_use(tlb_t *tlb, uint64_t next_use);
+
+/**
+ * @brief Prefetch the TLB set a VPN maps to
+ * 
+ * Pure performance hint for batched translation; has no effect on TLB
+ * state or statistics.
+ * 
+ * @param tlb TLB instance
+ * @param vpn Virtual page number
+ */
+void tlb_prefetch(const tlb_t *tlb, uint32_t vpn);
+
+/**
+ * @brief Append the entries, replacement state and statistics of a TLB
+ *        to a checkpoint
+ * 
+ * @param tlb TLB instance
+ * @param w Checkpoint writer
+ */
+void tlb_save(const tlb_t *tlb, ckpt_writer_t *w);
+
+/**
+ * @brief Load the state of a TLB from a checkpoint
+ * 
+ * @param tlb TLB built with the configuration that was saved
+ * @param r Checkpoint reader
+ * @return false if the saved geometry differs or the file is truncated
+ */
+bool tlb_restore(tlb_t *tlb, ckpt_reader_t *r);
+
+/**
+ * @brief Zero the statistics, keeping the entries (--warmup)
+ * 
+ * @param tlb TLB instance
+ */
+void tlb_reset_stats(tlb_t *tlb);
+
+/**
+ * @brief Register the TLB counters as group "tlb"
+ * 
+ * Keys: accesses, hits, misses.
+ * 
+ * @param tlb TLB instance
+ * @param reg Registry
+ */
+void tlb_register_stats(const tlb_t *tlb, stats_registry_t *reg);
+
 /**
  * @brief Print TLB statistics
  * 
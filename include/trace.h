@@ -0,0 +1,197 @@
+/**
+ * @file trace.h
+ * @brief Memory trace readers and writers
+ *
+ * Two on-disk trace formats are supported:
+ * - Text:   one access per line, "R 0x0000100c" / "W 0x00002000"
+ * - Binary: versioned header followed by packed (op, address) records
+ *
+ * trace_open() selects the decoder from the file magic, so callers never
+ * need to know which format they were handed. Either format may also be
+ * gzip-compressed and may be read from standard input ("-").
+ *
+ * Binary layout (all integers little-endian):
+ *
+ *   offset  size  field
+ *   0       8     magic "VMTRACE\0"
+ *   8       2     version (TRACE_BIN_VERSION)
+ *   10      2     record size in bytes (TRACE_BIN_RECORD_SIZE)
+ *   12      4     reserved, must be 0
+ *   16      8     record count
+ *   24      ...   records: 1-byte op ('R'/'W' as in the text trace),
+ *                 4-byte virtual address
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "types.h"
+
+/* ============================================================================
+ * Binary Format Constants
+ * ============================================================================ */
+
+#define TRACE_BIN_MAGIC "VMTRACE"      /* 7 chars + NUL = 8 magic bytes */
+#define TRACE_BIN_MAGIC_SIZE 8
+#define TRACE_BIN_VERSION 1
+#define TRACE_BIN_HEADER_SIZE 24
+#define TRACE_BIN_RECORD_SIZE 5
+
+/* Trace path that selects standard input */
+#define TRACE_STDIN "-"
+
+/* trace_tell() result when the input cannot be positioned */
+#define TRACE_OFFSET_UNKNOWN UINT64_MAX
+
+/**
+ * @brief Trace file formats
+ */
+typedef enum {
+    TRACE_FORMAT_TEXT = 0,
+    TRACE_FORMAT_BINARY = 1
+} trace_format_t;
+
+/**
+ * @brief One decoded trace access
+ */
+typedef struct trace_record_s {
+    uint32_t vaddr;                /* Virtual address */
+    char mode;                     /* Access mode as written in the trace */
+} trace_record_t;
+
+/**
+ * @brief Identity of a trace file (all zero for pipes and stdin)
+ */
+typedef struct {
+    uint64_t size;                 /* File size in bytes */
+    uint64_t mtime;                /* Modification time in nanoseconds */
+} trace_identity_t;
+
+typedef struct trace_reader_s trace_reader_t;
+typedef struct trace_writer_s trace_writer_t;
+
+/* ============================================================================
+ * Reader
+ * ============================================================================ */
+
+/**
+ * @brief Open a trace file for reading
+ *
+ * Detects the format from the first bytes of the file. Binary traces
+ * with an unknown version or record size are rejected. gzip input is
+ * inflated on the fly. Compressed or unmappable input (pipes, stdin) is
+ * decoded on a background thread; trace_next() then only unpacks batches.
+ *
+ * @param path Trace file path, or TRACE_STDIN for standard input
+ * @return Reader instance, or NULL on error
+ */
+trace_reader_t* trace_open(const char *path);
+
+/**
+ * @brief Decode the next access from the trace
+ *
+ * Text traces stop at the first record that does not match
+ * "<mode> 0x<hex>", mirroring the original fscanf loop.
+ *
+ * @param reader Reader instance
+ * @param[out] rec Decoded record
+ * @return true if a record was decoded, false at end of trace (or on a
+ *         decoding error, see trace_failed())
+ */
+bool trace_next(trace_reader_t *reader, trace_record_t *rec);
+
+/**
+ * @brief Get the file offset of the next record
+ *
+ * Only known for mapped, uncompressed files (those decoded without a
+ * reader thread).
+ *
+ * @param reader Reader instance
+ * @return Byte offset in the file, or TRACE_OFFSET_UNKNOWN
+ */
+uint64_t trace_tell(const trace_reader_t *reader);
+
+/**
+ * @brief Move past the first records of a trace
+ *
+ * Must be called before the first trace_next(). Mapped binary traces jump
+ * straight to the record, and mapped text traces to `offset` (as returned
+ * by trace_tell() after those records) when it is known. Compressed input,
+ * pipes and stdin decode and discard the records instead.
+ *
+ * @param reader Reader instance
+ * @param records Records to skip
+ * @param offset Byte offset of the next record, or TRACE_OFFSET_UNKNOWN
+ * @return false if the trace holds fewer records
+ */
+bool trace_seek(trace_reader_t *reader, uint64_t records, uint64_t offset);
+
+/**
+ * @brief Check whether the trace ended on an error
+ *
+ * A binary trace with fewer records than its header announces, or a
+ * truncated or corrupt gzip stream, ends the trace early (the reason is
+ * printed to stderr). Only meaningful once trace_next() returned false.
+ *
+ * @param reader Reader instance
+ * @return true if decoding stopped before the real end of the trace
+ */
+bool trace_failed(const trace_reader_t *reader);
+
+/**
+ * @brief Get the detected format of an open trace
+ *
+ * @param reader Reader instance
+ * @return TRACE_FORMAT_TEXT or TRACE_FORMAT_BINARY
+ */
+trace_format_t trace_get_format(const trace_reader_t *reader);
+
+/**
+ * @brief Get the identity of the file an open trace is read from
+ *
+ * @param reader Reader instance
+ * @param[out] id Size and modification time, or zeros if the input is not
+ *                a regular file
+ */
+void trace_get_identity(const trace_reader_t *reader, trace_identity_t *id);
+
+/**
+ * @brief Close a trace reader and free its resources
+ *
+ * @param reader Reader to close
+ */
+void trace_close(trace_reader_t *reader);
+
+/* ============================================================================
+ * Binary Writer
+ * ============================================================================ */
+
+/**
+ * @brief Create a binary trace file
+ *
+ * The header is written with a zero record count and patched by
+ * trace_writer_close(), so the output must be seekable.
+ *
+ * @param path Output file path
+ * @return Writer instance, or NULL on error
+ */
+trace_writer_t* trace_writer_open(const char *path);
+
+/**
+ * @brief Append one record to a binary trace
+ *
+ * @param writer Writer instance
+ * @param rec Record to append
+ * @return true on success, false on I/O error
+ */
+bool trace_writer_put(trace_writer_t *writer, const trace_record_t *rec);
+
+/**
+ * @brief Finalize the header and close a binary trace
+ *
+ * @param writer Writer to close
+ * @return true on success, false on I/O error
+ */
+bool trace_writer_close(trace_writer_t *writer);
+
+#endif /* TRACE_H */
@@ -28,6 +28,24 @@
 /* Default values for Task 1 */
 #define DEFAULT_BLOCK_SIZE 4
 #define DEFAULT_ASSOC DIRECT_MAPPED
+#define DEFAULT_SEED 1              /* Seed of random replacement policies */
+
+/* Default latencies in cycles (--latency), used for AMAT and --timing */
+#define DEFAULT_L1_LATENCY 4
+#define DEFAULT_L2_LATENCY 12
+#define DEFAULT_MEMORY_LATENCY 200
+#define DEFAULT_PAGE_WALK_LATENCY 30
+#define DEFAULT_PAGE_FAULT_LATENCY 10000
+
+/* Batched access paths: how many accesses ahead to prefetch */
+#define PREFETCH_DISTANCE 8
+
+/* Software prefetch hint (no-op on compilers without the builtin) */
+#if defined(__GNUC__) || defined(__clang__)
+#define PREFETCH(addr) __builtin_prefetch((addr), 1, 3)
+#else
+#define PREFETCH(addr) ((void)(addr))
+#endif
 
 /* ============================================================================
  * Enumerations
@@ -40,9 +58,37 @@ typedef enum {
     DIRECT_MAPPED = 1,    /* 1-way set associative */
     FULLY_ASSOC = 2,      /* Fully associative */
     TWO_WAY = 3,          /* 2-way set associative */
-    FOUR_WAY = 4          /* 4-way set associative */
+    FOUR_WAY = 4,         /* 4-way set associative */
+    N_WAY = 5             /* N-way, N given explicitly ("-A 12w") */
 } assoc_type_t;
 
+/**
+ * @brief How an address selects its set
+ * 
+ * Power-of-2 set counts take the index from the address bits above the
+ * offset. Other set counts use the block number modulo the set count.
+ * Hashed indexing spreads block numbers over the sets first; the tag is
+ * then the whole block number.
+ */
+typedef enum {
+    INDEX_BITS = 0,       /* index = block & (sets - 1), tag = block >> bits */
+    INDEX_MODULO = 1,     /* index = block % sets, tag = block / sets */
+    INDEX_HASH = 2        /* index = hash(block) mod sets, tag = block */
+} index_mode_t;
+
+/**
+ * @brief Replacement policies (see replacement.h)
+ */
+typedef enum {
+    REPL_LRU = 0,         /* True LRU (default) */
+    REPL_PLRU = 1,        /* Tree pseudo-LRU */
+    REPL_FIFO = 2,        /* First-in first-out */
+    REPL_RANDOM = 3,      /* Seeded random */
+    REPL_SRRIP = 4,       /* Static RRIP */
+    REPL_BRRIP = 5,       /* Bimodal RRIP */
+    REPL_OPT = 6          /* Belady's optimal (offline, --opt) */
+} repl_policy_t;
+
 /**
  * @brief Cache access result codes
  */
@@ -78,57 +124,100 @@ typedef enum {
  * Forward Declarations
  * ============================================================================ */
 
-typedef struct cache_line_s cache_line_t;
+typedef struct way_index_slot_s way_index_slot_t;
+typedef struct way_index_s way_index_t;
+
+typedef struct repl_ops_s repl_ops_t;
+
 typedef struct cache_set_s cache_set_t;
 typedef struct cache_s cache_t;
 typedef struct cache_config_s cache_config_t;
 typedef struct multilevel_cache_s multilevel_cache_t;
+typedef struct classify_s classify_t;
 
-typedef struct tlb_entry_s tlb_entry_t;
 typedef struct tlb_set_s tlb_set_t;
 typedef struct tlb_s tlb_t;
 typedef struct tlb_config_s tlb_config_t;
 
 typedef struct page_table_entry_s pte_t;
 typedef struct page_s page_t;
+typedef struct pagetable_s pagetable_t;
 
 typedef struct sim_config_s sim_config_t;
 
+/* Access paths, specialized per geometry and picked once at init */
+typedef cache_result_t (*cache_access_fn)(cache_t *cache, uint32_t addr, bool is_write);
+typedef tlb_result_t (*tlb_lookup_fn)(tlb_t *tlb, uint32_t vpn, uint32_t *ppn, bool *dirty);
+
 /* ============================================================================
- * Cache Structures
+ * Fully-Associative Lookup Index
  * ============================================================================ */
 
+/* Marks "no way": LRU list ends, empty index slots, lookup misses */
+#define WAY_NONE UINT32_MAX
+
+/* Fully-associative structures with more ways than this get a tag index;
+ * smaller ones are scanned, which is faster than hashing */
+#define WAY_INDEX_MIN_WAYS 16
+
+/**
+ * @brief One slot of a tag->way index (way == WAY_NONE marks an empty slot)
+ */
+struct way_index_slot_s {
+    uint32_t tag;
+    uint32_t way;
+};
+
 /**
- * @brief Cache line (cache block)
+ * @brief Open-addressing hash map from tag to way
  * 
- * Represents a single cache line with metadata and data storage.
+ * Linear probing with at most 50% load; deletion shifts later entries
+ * back instead of leaving tombstones, so probe chains stay short.
  */
-struct cache_line_s {
-    bool valid;                    /* Valid bit */
-    bool dirty;                    /* Dirty bit (for write-back) */
-    uint32_t tag;                  /* Tag bits */
-    uint8_t *data;                 /* Pointer to data block */
-    
-    /* LRU tracking (for set-associative caches) */
-    cache_line_t *prev;            /* Previous in LRU list */
-    cache_line_t *next;            /* Next in LRU list */
+struct way_index_s {
+    way_index_slot_t *slots;       /* NULL when the index is not in use */
+    uint32_t mask;                 /* Number of slots - 1 */
+    uint32_t shift;                /* 32 - log2(number of slots) */
 };
 
+/* ============================================================================
+ * Cache Structures
+ * ============================================================================ */
+
+/* Cache line state bits */
+#define LINE_VALID 0x01             /* Line holds a block */
+#define LINE_DIRTY 0x02             /* Block modified (write-back pending) */
+
+/* Alignment of the per-set storage blocks (one hardware cache line) */
+#define SET_ALIGN 64
+
 /**
- * @brief Cache set
+ * @brief Cache set header
  * 
- * Contains multiple cache lines (ways) for set-associative caches.
- * For direct-mapped, num_ways = 1. For fully-assoc, there's only 1 set.
+ * The simulator only tracks tags, so a set is a single contiguous block
+ * of cache->set_stride bytes holding all of its metadata:
+ * 
+ *   cache_set_t | uint32_t tags[ways] | uint8_t state[ways] | (pad to 8) |
+ *   replacement state (cache->repl_size bytes)
+ * 
+ * With LRU, a 4-way set is exactly 64 bytes, so a lookup touches one
+ * hardware line. Lines are filled in way order and never invalidated,
+ * so ways [0, fill) are valid and ways [fill, num_ways) are free.
  */
 struct cache_set_s {
-    uint32_t num_ways;             /* Number of ways in this set */
-    cache_line_t *lines;           /* Array of cache lines */
-    
-    /* LRU tracking */
-    cache_line_t *lru_head;        /* Most recently used */
-    cache_line_t *lru_tail;        /* Least recently used (victim) */
+    uint32_t fill;                 /* Number of valid ways */
 };
 
+/**
+ * @brief Dirty victim evicted by a cache operation
+ */
+typedef struct {
+    uint64_t op;                   /* Operations of the cache so far, this
+                                    * one included (demand accesses plus
+                                    * writebacks received) */
+    uint32_t addr;                 /* Block address of the victim */
+} cache_writeback_t;
+
 /**
  * @brief Unified cache structure (handles all associativities)
  * 
@@ -136,6 +225,7 @@ struct cache_set_s {
  * - Task 1: Direct-mapped, 4-byte blocks
  * - Task 2: Direct-mapped with variable block sizes
  * - Task 3: All associativity modes (direct-mapped, 2-way, 4-way, fully-assoc)
+ *   plus any N-way geometry, including non-power-of-2 set counts
  * - Task 4: Used as L1 and L2 in 2-level cache
  */
 struct cache_s {
@@ -148,11 +238,24 @@ struct cache_s {
     
     /* Bit field calculations */
     uint32_t offset_bits;          /* Bits for offset within block */
-    uint32_t index_bits;           /* Bits for set index */
+    uint32_t index_bits;           /* Bits for set index (INDEX_BITS only) */
     uint32_t tag_bits;             /* Bits for tag */
+    index_mode_t index_mode;       /* Set selection */
     
     /* Storage */
-    cache_set_t *sets;             /* Array of cache sets */
+    uint8_t *set_data;             /* num_sets blocks of set_stride bytes */
+    size_t set_stride;             /* Bytes per set block */
+    size_t repl_offset;            /* Replacement state offset in a set block */
+    size_t repl_size;              /* Replacement state bytes per set */
+    const repl_ops_t *repl;        /* Replacement policy */
+    uint64_t next_use;             /* Next-use time of current access (OPT) */
+    way_index_t tag_index;         /* Tag->way map (large fully-assoc only) */
+    cache_access_fn access;        /* Access path for this geometry */
+    classify_t *classify;          /* 3C miss classifier (NULL: off) */
+    cache_access_fn unclassified;  /* Access path wrapped by the classifier */
+    cache_writeback_t *wb_log;     /* Dirty victims since the owner last
+                                    * drained it (NULL: not recorded) */
+    uint32_t wb_count;             /* Entries in wb_log */
     
     /* Statistics */
     uint64_t accesses;             /* Total accesses */
@@ -162,6 +265,9 @@ struct cache_s {
     uint64_t read_hits;            /* Read hits */
     uint64_t writes;               /* Total writes */
     uint64_t write_hits;           /* Write hits */
+    uint64_t writebacks;           /* Dirty victims evicted */
+    uint64_t writebacks_in;        /* Writebacks received from the level above */
+    uint64_t writeback_misses;     /* Received writebacks that allocated a line */
 };
 
 /**
@@ -171,6 +277,10 @@ struct cache_config_s {
     uint32_t size;                 /* Cache size in bytes */
     uint32_t block_size;           /* Block size in bytes */
     assoc_type_t associativity;    /* Associativity type */
+    uint32_t ways;                 /* Ways per set (N_WAY only) */
+    bool hash_index;               /* Hashed set indexing */
+    repl_policy_t policy;          /* Replacement policy */
+    uint32_t seed;                 /* Seed of random policies */
 };
 
 /**
@@ -184,6 +294,10 @@ struct multilevel_cache_s {
     
     /* Per-level access tracking (beyond what cache_t tracks) */
     uint64_t level_accesses[MAX_CACHE_LEVELS]; /* Accesses to each level */
+    
+    /* Dirty victims of each level above the last (--writebacks) */
+    bool propagate_writebacks;                /* Write them into the next level */
+    cache_writeback_t *wb_log[MAX_CACHE_LEVELS];
 };
 
 /* ============================================================================
@@ -191,29 +305,16 @@ struct multilevel_cache_s {
  * ============================================================================ */
 
 /**
- * @brief TLB entry
- */
-struct tlb_entry_s {
-    bool valid;                    /* Valid bit */
-    bool dirty;                    /* Dirty bit */
-    uint32_t vpn;                  /* Virtual page number (tag) */
-    uint32_t ppn;                  /* Physical page number */
-    
-    /* LRU tracking */
-    tlb_entry_t *prev;
-    tlb_entry_t *next;
-};
-
-/**
- * @brief TLB set (for set-associative TLB)
+ * @brief TLB set header
+ * 
+ * Entries are stored structure-of-arrays in the tlb_t (vpns[], ppns[],
+ * state[]), with set i owning entries [i * ways, (i + 1) * ways), and
+ * the replacement state of set i at repl_state + i * repl_stride.
+ * Like cache sets, entries are filled in order and never invalidated, so
+ * entries [0, fill) of a set are valid.
  */
 struct tlb_set_s {
-    uint32_t num_ways;
-    tlb_entry_t *entries;
-    
-    /* LRU tracking */
-    tlb_entry_t *lru_head;
-    tlb_entry_t *lru_tail;
+    uint32_t fill;                 /* Number of valid entries */
 };
 
 /**
@@ -227,11 +328,21 @@ struct tlb_s {
     
     /* Bit field calculations */
     uint32_t offset_bits;          /* Always 12 (4KB pages) */
-    uint32_t index_bits;           /* Bits for set index */
+    uint32_t index_bits;           /* Bits for set index (INDEX_BITS only) */
     uint32_t tag_bits;             /* Bits for VPN tag */
+    index_mode_t index_mode;       /* Set selection */
     
-    /* Storage */
+    /* Storage (num_entries of each array, grouped by set) */
     tlb_set_t *sets;
+    uint32_t *vpns;                /* VPN tags, contiguous per set */
+    uint32_t *ppns;                /* Physical page numbers */
+    uint8_t *state;                /* LINE_VALID / LINE_DIRTY bits */
+    uint8_t *repl_state;           /* Replacement state, repl_stride per set */
+    size_t repl_stride;
+    const repl_ops_t *repl;        /* Replacement policy */
+    uint64_t next_use;             /* Next-use time of current access (OPT) */
+    way_index_t vpn_index;         /* Tag->entry map (large fully-assoc only) */
+    tlb_lookup_fn lookup;          /* Lookup path for this geometry */
     
     /* Statistics */
     uint64_t accesses;
@@ -245,6 +356,10 @@ struct tlb_s {
 struct tlb_config_s {
     uint32_t num_entries;          /* Number of TLB entries */
     assoc_type_t associativity;    /* Associativity type */
+    uint32_t ways;                 /* Ways per set (N_WAY only) */
+    bool hash_index;               /* Hashed set indexing */
+    repl_policy_t policy;          /* Replacement policy */
+    uint32_t seed;                 /* Seed of random policies */
 };
 
 /* ============================================================================
@@ -269,16 +384,87 @@ struct page_s {
     uint32_t frame_id;             /* Physical frame number */
     pte_t *pte;                    /* Pointer to corresponding PTE */
     uint8_t data[PAGE_SIZE];       /* Page data */
+    uint64_t next_use;             /* Next-use time of the page (OPT) */
     
     /* Linked list pointers */
     page_t *next;
     page_t *prev;
 };
 
+/**
+ * @brief Page table (linear table, frames and replacement state)
+ */
+struct pagetable_s {
+    pte_t page_table[PAGE_TABLE_ENTRIES];
+    page_t *frame_table[NUM_PHYSICAL_PAGES]; /* Frame number -> page */
+    page_t *free_page_list;        /* Unallocated frames */
+    page_t *used_page_list;        /* Allocated frames, head = MRU */
+    
+    /* OPT replacement */
+    bool opt_enabled;
+    uint64_t opt_next_use;         /* Next use of the page being accessed */
+    
+    /* Statistics */
+    uint64_t accesses;
+    uint64_t page_faults;
+    uint64_t page_faults_dirty;
+};
+
 /* ============================================================================
  * Simulation Configuration
  * ============================================================================ */
 
+/**
+ * @brief Output format of the parameter-grid driver
+ */
+typedef enum {
+    GRID_CSV = 0,
+    GRID_JSON = 1
+} grid_format_t;
+
+/**
+ * @brief Output format of the statistics report (--stats-format)
+ */
+typedef enum {
+    STATS_TEXT = 0,
+    STATS_JSON = 1,
+    STATS_CSV = 2
+} stats_format_t;
+
+/**
+ * @brief Latencies in cycles (--latency)
+ * 
+ * An access costs its translation (nothing on a TLB hit, page_walk on a
+ * TLB miss, page_walk + page_fault on a page fault) plus the latency of
+ * every cache level it reaches, plus memory if it misses them all.
+ */
+typedef struct latency_config_s {
+    uint32_t l1;                   /* Single-level cache or L1 */
+    uint32_t l2;                   /* L2 (multi-level only) */
+    uint32_t memory;               /* Behind the last cache level */
+    uint32_t page_walk;            /* Page table walk after a TLB miss */
+    uint32_t page_fault;           /* Fault handling, on top of the walk */
+} latency_config_t;
+
+/**
+ * @brief Parameter grid (--grid-*): every combination of the listed cache
+ * sizes, associativities and TLB sizes is simulated separately
+ * 
+ * Once parsed, dimensions that were not given hold the single -S/-A/-T
+ * value, so num_sizes > 0 exactly when grid mode is on.
+ */
+typedef struct grid_config_s {
+    uint32_t *sizes;               /* Cache sizes */
+    uint32_t num_sizes;
+    assoc_type_t *assoc;           /* Associativities ... */
+    uint32_t *ways;                /* ... and their way counts (N_WAY) */
+    uint32_t num_assoc;
+    uint32_t *tlb_entries;         /* TLB sizes */
+    uint32_t num_tlb;
+    uint32_t threads;              /* Worker threads (0: one per CPU) */
+    grid_format_t format;          /* Result table format */
+} grid_config_t;
+
 /**
  * @brief Complete simulator configuration
  * 
@@ -298,7 +484,40 @@ struct sim_config_s {
     /* TLB configuration */
     tlb_config_t tlb;
     
+    /* Extra single-level caches fed the same address stream (-C, --sweep) */
+    cache_config_t *sweep;
+    uint32_t num_sweep;
+    
+    /* Independent simulations over a parameter grid (--grid-*) */
+    grid_config_t grid;
+    
+    /* Threads sharing the sets of the single-level cache (--threads) */
+    uint32_t threads;
+    bool pipeline;                 /* Parse/translate/cache threads (--pipeline) */
+    
+    /* Whole-state checkpoints (--checkpoint-at, --restore) */
+    uint64_t checkpoint_at;        /* Records simulated before saving */
+    char *checkpoint_file;         /* Checkpoint to write, or NULL */
+    char *restore_file;            /* Checkpoint to resume from, or NULL */
+    
+    /* Measurement window */
+    uint64_t warmup;               /* Records before statistics are zeroed (--warmup) */
+    uint64_t interval;             /* Records per statistics row, 0: off (--interval) */
+    stats_format_t stats_format;   /* Report format (--stats-format) */
+    latency_config_t latency;      /* Cycle counts (--latency) */
+    bool timing;                   /* Cycle accounting report (--timing) */
+    bool writebacks;               /* Propagate dirty victims (--writebacks) */
+    
     /* File and options */
+    uint32_t seed;                 /* Seed of random replacement policies */
+    bool opt;                      /* Belady OPT replay (--opt) */
+    bool hash_index;               /* Hashed set indexing (--hash-index) */
+    bool mrc;                      /* Print a miss-ratio curve (--mrc) */
+    uint32_t mrc_sets;             /* Sets of the profiled geometry (--mrc-sets) */
+    double shards_rate;            /* SHARDS sampling rate (--shards-rate) */
+    uint32_t shards_budget;        /* SHARDS tracked-block budget (--shards-budget) */
+    bool classify;                 /* 3C miss classification (--classify) */
+    char *heatmap_file;            /* Per-set counters to write, or NULL (--heatmap) */
     char *trace_file;              /* Trace file path */
     bool verbose;                  /* Verbose output mode */
 };
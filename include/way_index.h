@@ -0,0 +1,61 @@
+/**
+ * @file way_index.h
+ * @brief Tag-to-way hash index for fully-associative structures
+ *
+ * A fully-associative cache or TLB is a single set, so finding a tag by
+ * scanning its ways costs one comparison per entry. The index maps each
+ * resident tag to its way, making lookup, insertion and eviction O(1)
+ * regardless of size. It only answers "which way holds this tag"; the
+ * owner still keeps the tags, state and LRU order.
+ */
+
+#ifndef WAY_INDEX_H
+#define WAY_INDEX_H
+
+#include "types.h"
+
+/**
+ * @brief Allocate an index able to hold one entry per way
+ *
+ * @param index Index to initialize
+ * @param ways Maximum number of resident tags
+ * @return true on success, false on allocation failure
+ */
+bool way_index_init(way_index_t *index, uint32_t ways);
+
+/**
+ * @brief Find the way holding a tag
+ *
+ * @param index Index instance
+ * @param tag Tag to look up
+ * @return Way index, or WAY_NONE if the tag is not resident
+ */
+uint32_t way_index_find(const way_index_t *index, uint32_t tag);
+
+/**
+ * @brief Record that a tag now lives in a way
+ *
+ * The tag must not already be in the index.
+ *
+ * @param index Index instance
+ * @param tag Tag being installed
+ * @param way Way it was installed in
+ */
+void way_index_insert(way_index_t *index, uint32_t tag, uint32_t way);
+
+/**
+ * @brief Forget an evicted tag
+ *
+ * @param index Index instance
+ * @param tag Tag being evicted (ignored if not present)
+ */
+void way_index_remove(way_index_t *index, uint32_t tag);
+
+/**
+ * @brief Free the index storage
+ *
+ * @param index Index to free (safe on an unused index)
+ */
+void way_index_free(way_index_t *index);
+
+#endif /* WAY_INDEX_H */
@@ -9,13 +9,22 @@
  * - Direct-mapped, 2-way, 4-way, and fully-associative
  * - Variable block sizes
  * - Write-back, write-allocate policy
- * - LRU replacement
+ * - Pluggable replacement (LRU by default, see replacement.h)
+ * 
+ * Tag-only simulation: no block data is stored. Each set's tags, state
+ * bits and replacement state live in one contiguous block (see cache_set_s).
  */
 
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include "cache.h"
+#include "checkpoint.h"
+#include "classify.h"
+#include "stats.h"
+#include "way_index.h"
+#include "tag_match.h"
+#include "replacement.h"
 #include "types.h"
 
 /* ============================================================================
@@ -31,113 +40,63 @@ uint32_t log2_uint32(uint32_t n) {
     return log;
 }
 
-/**
- * @brief Initialize a cache line
- */
-static void init_cache_line(cache_line_t *line, uint32_t block_size) {
-    line->valid = false;
-    line->dirty = false;
-    line->tag = 0;
-    line->data = calloc(block_size, sizeof(uint8_t));
-    line->prev = NULL;
-    line->next = NULL;
+uint32_t hash_set_index(uint32_t block, uint32_t num_sets) {
+    /* Fibonacci hash, then scale the 32-bit result down to [0, num_sets) */
+    uint32_t h = block * 0x9E3779B1u;
+    return (uint32_t)(((uint64_t)h * num_sets) >> 32);
 }
 
 /**
- * @brief Initialize LRU list for a cache set
- * 
- * Creates a doubly-linked list of cache lines ordered by LRU.
- * Head = MRU (most recently used)
- * Tail = LRU (least recently used, victim candidate)
+ * @brief Get the storage block of a set
  */
-static void init_lru_list(cache_set_t *set) {
-    if (set->num_ways <= 1) return;  /* No LRU for direct-mapped */
-    
-    /* Link all lines in order */
-    set->lru_head = &set->lines[0];
-    set->lru_tail = &set->lines[set->num_ways - 1];
-    
-    for (uint32_t i = 0; i < set->num_ways; i++) {
-        if (i > 0) {
-            set->lines[i].prev = &set->lines[i - 1];
-        }
-        if (i < set->num_ways - 1) {
-            set->lines[i].next = &set->lines[i + 1];
-        }
-    }
+static inline cache_set_t* get_set(const cache_t *cache, uint32_t index) {
+    return (cache_set_t *)(cache->set_data + (size_t)index * cache->set_stride);
 }
 
 /**
- * @brief Move a cache line to the head of LRU list (mark as MRU)
+ * @brief Per-set arrays that follow the set header
  */
-static void lru_move_to_head(cache_set_t *set, cache_line_t *line) {
-    if (!line || set->num_ways <= 1 || line == set->lru_head) {
-        return;  /* Already at head or no LRU tracking needed */
-    }
-    
-    /* Remove from current position */
-    if (line->prev) {
-        line->prev->next = line->next;
-    }
-    if (line->next) {
-        line->next->prev = line->prev;
-    }
-    
-    /* Update tail if we're removing the tail */
-    if (line == set->lru_tail) {
-        set->lru_tail = line->prev;
-    }
-    
-    /* Insert at head */
-    line->prev = NULL;
-    line->next = set->lru_head;
-    if (set->lru_head) {
-        set->lru_head->prev = line;
-    }
-    set->lru_head = line;
+static inline uint32_t* set_tags(cache_set_t *set) {
+    return (uint32_t *)(set + 1);
 }
 
-/**
- * @brief Find a cache line with matching tag in a set
- */
-static cache_line_t* find_line(cache_set_t *set, uint32_t tag) {
-    for (uint32_t i = 0; i < set->num_ways; i++) {
-        if (set->lines[i].valid && set->lines[i].tag == tag) {
-            return &set->lines[i];
-        }
-    }
-    return NULL;
+static inline void* set_repl(const cache_t *cache, cache_set_t *set) {
+    return (uint8_t *)set + cache->repl_offset;
 }
 
 /**
- * @brief Find an invalid (empty) line in a set
+ * @brief Bytes needed per set block
+ * 
+ * Small sets are padded to a power of two so that, with SET_ALIGN-aligned
+ * storage, no set straddles a hardware cache line; larger sets are padded
+ * to a whole number of lines.
  */
-static cache_line_t* find_invalid_line(cache_set_t *set) {
-    for (uint32_t i = 0; i < set->num_ways; i++) {
-        if (!set->lines[i].valid) {
-            return &set->lines[i];
+static size_t compute_set_stride(const cache_t *cache) {
+    size_t bytes = cache->repl_offset + cache->repl_size;
+    if (bytes <= SET_ALIGN) {
+        size_t stride = sizeof(uint32_t);
+        while (stride < bytes) {
+            stride <<= 1;
         }
+        return stride;
     }
-    return NULL;
+    return (bytes + SET_ALIGN - 1) / SET_ALIGN * SET_ALIGN;
 }
 
 /**
- * @brief Select victim line for eviction (LRU)
+ * @brief Find the way holding a tag in a set
+ * 
+ * Only ways [0, fill) are valid, so no per-line valid check is needed.
+ * Large fully-associative caches use the tag index instead of a scan.
+ * 
+ * @return Way index, or WAY_NONE on miss
  */
-static cache_line_t* select_victim(cache_set_t *set) {
-    /* First, try to find an invalid line */
-    cache_line_t *invalid = find_invalid_line(set);
-    if (invalid) {
-        return invalid;
-    }
-    
-    /* All lines valid, use LRU */
-    if (set->num_ways == 1) {
-        return &set->lines[0];  /* Direct-mapped: only one choice */
+static uint32_t find_way(const cache_t *cache, cache_set_t *set, uint32_t tag) {
+    if (cache->tag_index.slots) {
+        return way_index_find(&cache->tag_index, tag);
     }
     
-    /* Return tail of LRU list (least recently used) */
-    return set->lru_tail;
+    return tag_match(set_tags(set), set->fill, tag);
 }
 
 /**
@@ -145,21 +104,24 @@ static cache_line_t* select_victim(cache_set_t *set) {
  * 
  * Dummy function - in real hardware, this would fetch data from memory.
  */
-static void read_block_from_memory(cache_line_t *line, uint32_t addr) {
+static void read_block_from_memory(uint32_t addr) {
     /* In simulation, we don't actually read data */
-    (void)line;
     (void)addr;
 }
 
 /**
- * @brief Simulate writing a dirty block to memory
+ * @brief Write a dirty victim back to the next level or memory
  * 
- * Dummy function - in real hardware, this would write data to memory.
+ * Counts the writeback and, if the owner records them, logs the victim
+ * so it can be written into the next level (see multilevel_cache.c).
  */
-static void write_block_to_memory(cache_line_t *line, uint32_t addr) {
-    /* In simulation, we don't actually write data */
-    (void)line;
-    (void)addr;
+static void write_block_to_memory(cache_t *cache, uint32_t addr) {
+    cache->writebacks++;
+    if (cache->wb_log) {
+        cache_writeback_t *wb = &cache->wb_log[cache->wb_count++];
+        wb->op = cache->accesses + cache->writebacks_in;
+        wb->addr = addr;
+    }
 }
 
 /* ============================================================================
@@ -167,18 +129,45 @@ static void write_block_to_memory(cache_line_t *line, uint32_t addr) {
  * ============================================================================ */
 
 uint32_t cache_get_index(const cache_t *cache, uint32_t addr) {
-    if (cache->associativity == FULLY_ASSOC) {
-        return 0;  /* Fully-assoc has only 1 set */
-    }
+    uint32_t block = addr >> cache->offset_bits;
     
-    /* Extract index bits */
-    uint32_t index_mask = (1 << cache->index_bits) - 1;
-    return (addr >> cache->offset_bits) & index_mask;
+    switch (cache->index_mode) {
+        case INDEX_MODULO:
+            return block % cache->num_sets;
+        case INDEX_HASH:
+            return hash_set_index(block, cache->num_sets);
+        default:
+            /* Extract index bits (no bits for a single set) */
+            return block & ((1u << cache->index_bits) - 1);
+    }
 }
 
 uint32_t cache_get_tag(const cache_t *cache, uint32_t addr) {
-    uint32_t shift = cache->offset_bits + cache->index_bits;
-    return addr >> shift;
+    uint32_t block = addr >> cache->offset_bits;
+    
+    switch (cache->index_mode) {
+        case INDEX_MODULO:
+            return block / cache->num_sets;
+        case INDEX_HASH:
+            return block;
+        default:
+            return block >> cache->index_bits;
+    }
+}
+
+/**
+ * @brief Rebuild the block address held in a way from its tag and set
+ */
+static uint32_t cache_block_addr(const cache_t *cache, uint32_t tag, uint32_t index) {
+    switch (cache->index_mode) {
+        case INDEX_MODULO:
+            return (tag * cache->num_sets + index) << cache->offset_bits;
+        case INDEX_HASH:
+            return tag << cache->offset_bits;
+        default:
+            return (tag << (cache->offset_bits + cache->index_bits)) |
+                   (index << cache->offset_bits);
+    }
 }
 
 uint32_t cache_get_offset(const cache_t *cache, uint32_t addr) {
@@ -186,6 +175,209 @@ uint32_t cache_get_offset(const cache_t *cache, uint32_t addr) {
     return addr & offset_mask;
 }
 
+/* ============================================================================
+ * Access Paths
+ * ============================================================================ */
+
+/* Geometry an access path is compiled for */
+#define GEOM_ANY       0    /* Anything (runtime ways, index mode, tag index) */
+#define GEOM_SETS      1    /* Bit-sliced sets with a constant way count */
+#define GEOM_FA        2    /* One set, tags scanned */
+#define GEOM_FA_INDEX  3    /* One set, tags found through the tag index */
+
+#if defined(__GNUC__) || defined(__clang__)
+#define ACCESS_INLINE static inline __attribute__((always_inline))
+#else
+#define ACCESS_INLINE static inline
+#endif
+
+/**
+ * @brief Access body shared by all paths
+ * 
+ * geom and const_ways are compile-time constants in every caller, so each
+ * instantiation keeps only the index arithmetic, tag search and
+ * replacement branches of its own geometry. const_ways == 0 reads the
+ * way count from the cache.
+ */
+ACCESS_INLINE cache_result_t access_body(cache_t *cache, uint32_t addr, bool is_write,
+                                         const int geom, const uint32_t const_ways) {
+    const uint32_t ways = const_ways ? const_ways : cache->ways_per_set;
+    
+    /* Update access statistics */
+    cache->accesses++;
+    if (is_write) {
+        cache->writes++;
+    } else {
+        cache->reads++;
+    }
+    
+    /* Parse address */
+    uint32_t index, tag;
+    if (geom == GEOM_ANY) {
+        index = cache_get_index(cache, addr);
+        tag = cache_get_tag(cache, addr);
+    } else if (geom == GEOM_SETS) {
+        index = (addr >> cache->offset_bits) & (cache->num_sets - 1);
+        tag = addr >> (cache->offset_bits + cache->index_bits);
+    } else {
+        index = 0;
+        tag = addr >> cache->offset_bits;
+    }
+    
+    /* Get the appropriate cache set */
+    cache_set_t *set = get_set(cache, index);
+    uint32_t *tags = set_tags(set);
+    uint8_t *state = (uint8_t *)(tags + ways);
+    
+    /* Search for matching tag (cache hit?) */
+    uint32_t way;
+    if (geom == GEOM_ANY) {
+        way = find_way(cache, set, tag);
+    } else if (geom == GEOM_FA_INDEX) {
+        way = way_index_find(&cache->tag_index, tag);
+    } else {
+        way = tag_match(tags, set->fill, tag);
+    }
+    
+    if (way != WAY_NONE) {
+        /* CACHE HIT */
+        cache->hits++;
+        if (is_write) {
+            cache->write_hits++;
+            state[way] |= LINE_DIRTY;  /* Mark as dirty for write-back */
+        } else {
+            cache->read_hits++;
+        }
+        
+        /* Update replacement state */
+        if (ways > 1) {
+            cache->repl->touch(set_repl(cache, set), ways, way, cache->next_use);
+        }
+        
+        return CACHE_HIT;
+    }
+    
+    /* CACHE MISS */
+    cache->misses++;
+    
+    /* Select victim: a free way first, then the replacement policy */
+    uint32_t victim;
+    if (set->fill < ways) {
+        victim = set->fill++;
+    } else if (ways == 1) {
+        victim = 0;  /* Direct-mapped: only one choice */
+    } else {
+        victim = cache->repl->victim(set_repl(cache, set), ways);
+    }
+    
+    /* Evict victim if necessary (write-back policy) */
+    if ((state[victim] & (LINE_VALID | LINE_DIRTY)) == (LINE_VALID | LINE_DIRTY)) {
+        /* Write dirty block back to memory */
+        uint32_t victim_addr = (geom == GEOM_ANY) ?
+            cache_block_addr(cache, tags[victim], index) :
+            (tags[victim] << (cache->offset_bits + cache->index_bits)) |
+            (index << cache->offset_bits);
+        write_block_to_memory(cache, victim_addr);
+    }
+    
+    /* Keep the tag index in step with the eviction and fill */
+    if (geom == GEOM_FA_INDEX || (geom == GEOM_ANY && cache->tag_index.slots)) {
+        if (state[victim] & LINE_VALID) {
+            way_index_remove(&cache->tag_index, tags[victim]);
+        }
+        way_index_insert(&cache->tag_index, tag, victim);
+    }
+    
+    /* Install new block (dirty if write miss: write-allocate) */
+    tags[victim] = tag;
+    state[victim] = LINE_VALID | (is_write ? LINE_DIRTY : 0);
+    
+    /* Read block from memory */
+    read_block_from_memory(addr);
+    
+    /* Update replacement state for the new block */
+    if (ways > 1) {
+        cache->repl->insert(set_repl(cache, set), ways, victim, cache->next_use);
+    }
+    
+    return CACHE_MISS;
+}
+
+#define DEFINE_CACHE_ACCESS(name, geom, ways)                                  \
+    static cache_result_t name(cache_t *cache, uint32_t addr, bool is_write) { \
+        return access_body(cache, addr, is_write, geom, ways);                 \
+    }
+
+DEFINE_CACHE_ACCESS(access_generic, GEOM_ANY, 0)
+
+#ifndef GENERIC_ACCESS_ONLY
+DEFINE_CACHE_ACCESS(access_dm, GEOM_SETS, 1)
+DEFINE_CACHE_ACCESS(access_2way, GEOM_SETS, 2)
+DEFINE_CACHE_ACCESS(access_4way, GEOM_SETS, 4)
+DEFINE_CACHE_ACCESS(access_8way, GEOM_SETS, 8)
+DEFINE_CACHE_ACCESS(access_16way, GEOM_SETS, 16)
+DEFINE_CACHE_ACCESS(access_fa, GEOM_FA, 0)
+DEFINE_CACHE_ACCESS(access_fa_indexed, GEOM_FA_INDEX, 0)
+#endif
+
+/**
+ * @brief Describe the geometry of a cache for checkpoints
+ */
+static void cache_geometry(const cache_t *cache, ckpt_geometry_t *geo) {
+    memset(geo, 0, sizeof(*geo));
+    geo->sets = cache->num_sets;
+    geo->ways = cache->ways_per_set;
+    geo->index_mode = (uint32_t)cache->index_mode;
+    geo->block_size = cache->block_size;
+    geo->state_bytes = (uint64_t)cache->num_sets * cache->set_stride;
+    if (cache->tag_index.slots) {
+        geo->state_bytes += ((uint64_t)cache->tag_index.mask + 1) * sizeof(way_index_slot_t);
+    }
+    strncpy(geo->policy, cache->repl->name, sizeof(geo->policy) - 1);
+}
+
+/**
+ * @brief Pick the access path of a fully-initialized cache
+ * 
+ * Building with -DGENERIC_ACCESS_ONLY (make SPECIALIZE=0) keeps only the
+ * generic path, as a reference for the specialized ones.
+ */
+static cache_access_fn select_access(const cache_t *cache) {
+#ifndef GENERIC_ACCESS_ONLY
+    if (cache->index_mode == INDEX_BITS) {
+        if (cache->num_sets == 1) {
+            return cache->tag_index.slots ? access_fa_indexed : access_fa;
+        }
+        switch (cache->ways_per_set) {
+            case 1:  return access_dm;
+            case 2:  return access_2way;
+            case 4:  return access_4way;
+            case 8:  return access_8way;
+            case 16: return access_16way;
+            default: break;
+        }
+    }
+#endif
+    (void)cache;
+    return access_generic;
+}
+
+/**
+ * @brief Access path of a classified cache
+ * 
+ * Runs the geometry's own path, then shows the outcome to the classifier.
+ * A miss into a full set is an eviction (lines are never invalidated).
+ */
+static cache_result_t access_classified(cache_t *cache, uint32_t addr, bool is_write) {
+    uint32_t index = cache_get_index(cache, addr);
+    bool full = get_set(cache, index)->fill == cache->ways_per_set;
+    
+    cache_result_t result = cache->unclassified(cache, addr, is_write);
+    classify_access(cache->classify, addr >> cache->offset_bits, index,
+                    result == CACHE_MISS, result == CACHE_MISS && full);
+    return result;
+}
+
 /* ============================================================================
  * Public API Implementation
  * ============================================================================ */
@@ -223,6 +415,11 @@ cache_t* cache_init(cache_config_t config) {
             cache->num_sets = config.size / (config.block_size * 4);
             break;
             
+        case N_WAY:
+            cache->ways_per_set = config.ways;
+            cache->num_sets = config.size / (config.block_size * config.ways);
+            break;
+            
         default:
             free(cache);
             return NULL;
@@ -230,44 +427,56 @@ cache_t* cache_init(cache_config_t config) {
     
     /* Calculate bit field sizes */
     cache->offset_bits = log2_uint32(config.block_size);
-    cache->index_bits = (config.associativity == FULLY_ASSOC) ? 
-                        0 : log2_uint32(cache->num_sets);
+    if (config.hash_index && cache->num_sets > 1) {
+        cache->index_mode = INDEX_HASH;
+    } else if (cache->num_sets & (cache->num_sets - 1)) {
+        cache->index_mode = INDEX_MODULO;
+    } else {
+        cache->index_mode = INDEX_BITS;
+        cache->index_bits = log2_uint32(cache->num_sets);
+    }
     cache->tag_bits = 32 - cache->offset_bits - cache->index_bits;
     
-    /* Allocate cache sets */
-    cache->sets = calloc(cache->num_sets, sizeof(cache_set_t));
-    if (!cache->sets) {
+    /* Replacement policy (direct-mapped sets have no choice to make) */
+    cache->repl = repl_get_ops(config.policy);
+    if (!cache->repl) {
         free(cache);
         return NULL;
     }
+    cache->repl_size = (cache->ways_per_set > 1) ?
+                       REPL_ALIGN_UP(cache->repl->state_size(cache->ways_per_set)) : 0;
+    cache->repl_offset = REPL_ALIGN_UP(sizeof(cache_set_t) +
+                                       cache->ways_per_set * (sizeof(uint32_t) + 1));
     
-    /* Initialize each set */
-    for (uint32_t i = 0; i < cache->num_sets; i++) {
-        cache->sets[i].num_ways = cache->ways_per_set;
-        cache->sets[i].lines = calloc(cache->ways_per_set, sizeof(cache_line_t));
-        
-        if (!cache->sets[i].lines) {
-            /* Cleanup on failure */
-            for (uint32_t j = 0; j < i; j++) {
-                for (uint32_t k = 0; k < cache->sets[j].num_ways; k++) {
-                    free(cache->sets[j].lines[k].data);
-                }
-                free(cache->sets[j].lines);
-            }
-            free(cache->sets);
-            free(cache);
-            return NULL;
-        }
-        
-        /* Initialize each line in the set */
-        for (uint32_t j = 0; j < cache->ways_per_set; j++) {
-            init_cache_line(&cache->sets[i].lines[j], config.block_size);
+    /* Allocate all set blocks in one aligned chunk */
+    cache->set_stride = compute_set_stride(cache);
+    size_t bytes = (size_t)cache->num_sets * cache->set_stride;
+    cache->set_data = aligned_alloc(SET_ALIGN, (bytes + SET_ALIGN - 1) / SET_ALIGN * SET_ALIGN);
+    if (!cache->set_data) {
+        free(cache);
+        return NULL;
+    }
+    memset(cache->set_data, 0, bytes);
+    
+    /* Initialize replacement state of each set (tags and state start zeroed) */
+    if (cache->repl_size) {
+        for (uint32_t i = 0; i < cache->num_sets; i++) {
+            cache->repl->init(set_repl(cache, get_set(cache, i)), cache->ways_per_set,
+                              repl_set_seed(config.seed, i));
         }
-        
-        /* Initialize LRU list */
-        init_lru_list(&cache->sets[i]);
     }
     
+    /* Large fully-associative caches find tags through a hash index */
+    if (cache->num_sets == 1 &&
+        cache->ways_per_set > WAY_INDEX_MIN_WAYS &&
+        !way_index_init(&cache->tag_index, cache->ways_per_set)) {
+        free(cache->set_data);
+        free(cache);
+        return NULL;
+    }
+    
+    cache->access = select_access(cache);
+    
     /* Initialize statistics */
     cache->accesses = 0;
     cache->hits = 0;
@@ -276,101 +485,259 @@ cache_t* cache_init(cache_config_t config) {
     cache->read_hits = 0;
     cache->writes = 0;
     cache->write_hits = 0;
+    cache->writebacks = 0;
+    cache->writebacks_in = 0;
+    cache->writeback_misses = 0;
     
     return cache;
 }
 
-cache_result_t cache_access(cache_t *cache, uint32_t addr, bool is_write) {
-    /* Update access statistics */
-    cache->accesses++;
-    if (is_write) {
-        cache->writes++;
-    } else {
-        cache->reads++;
+bool cache_enable_classify(cache_t *cache) {
+    if (cache->classify) {
+        return true;
     }
     
-    /* Parse address */
-    uint32_t index = cache_get_index(cache, addr);
-    uint32_t tag = cache_get_tag(cache, addr);
+    cache->classify = classify_create(cache->num_sets, cache->ways_per_set,
+                                      cache->block_size);
+    if (!cache->classify) {
+        return false;
+    }
+    cache->unclassified = cache->access;
+    cache->access = access_classified;
+    return true;
+}
+
+cache_result_t cache_access(cache_t *cache, uint32_t addr, bool is_write) {
+    return cache->access(cache, addr, is_write);
+}
+
+cache_result_t cache_write_back(cache_t *cache, uint32_t addr) {
+    /* Regular write path (classifiers follow demand accesses only), then
+     * take the write back out of the demand counters */
+    uint64_t stats[] = { cache->accesses, cache->hits, cache->misses, cache->writes,
+                         cache->write_hits };
+    cache_access_fn access = cache->classify ? cache->unclassified : cache->access;
+    cache_result_t result = access(cache, addr, true);
     
-    /* Get the appropriate cache set */
-    cache_set_t *set = &cache->sets[index];
+    cache->accesses = stats[0];
+    cache->hits = stats[1];
+    cache->misses = stats[2];
+    cache->writes = stats[3];
+    cache->write_hits = stats[4];
+    cache->writebacks_in++;
+    if (result != CACHE_HIT) {
+        cache->writeback_misses++;
+    }
+    return result;
+}
+
+void cache_set_writeback_log(cache_t *cache, cache_writeback_t *log) {
+    cache->wb_log = log;
+    cache->wb_count = 0;
+}
+
+void cache_set_next_use(cache_t *cache, uint64_t next_use) {
+    cache->next_use = next_use;
+}
+
+void cache_prefetch(const cache_t *cache, uint32_t addr) {
+    const uint8_t *block = (const uint8_t *)get_set(cache, cache_get_index(cache, addr));
+    PREFETCH(block);
+    if (cache->set_stride > SET_ALIGN) {
+        PREFETCH(block + SET_ALIGN);  /* 8-way and wider sets span two lines */
+    }
+}
+
+void cache_access_batch(cache_t *cache, const uint32_t *addrs,
+                        const bool *is_write, size_t n,
+                        cache_result_t *results) {
+    cache_access_fn access = cache->access;
     
-    /* Search for matching tag (cache hit?) */
-    cache_line_t *line = find_line(set, tag);
+    /* Each set is one contiguous block, so one prefetch stage suffices */
+    for (size_t i = 0; i < n && i < PREFETCH_DISTANCE; i++) {
+        cache_prefetch(cache, addrs[i]);
+    }
     
-    if (line) {
-        /* CACHE HIT */
-        cache->hits++;
-        if (is_write) {
-            cache->write_hits++;
-            line->dirty = true;  /* Mark as dirty for write-back */
-        } else {
-            cache->read_hits++;
+    for (size_t i = 0; i < n; i++) {
+        if (i + PREFETCH_DISTANCE < n) {
+            cache_prefetch(cache, addrs[i + PREFETCH_DISTANCE]);
         }
-        
-        /* Update LRU (mark as most recently used) */
-        lru_move_to_head(set, line);
-        
-        return CACHE_HIT;
+        results[i] = access(cache, addrs[i], is_write[i]);
+    }
+}
+
+cache_t* cache_view_create(const cache_t *cache) {
+    /* Views of caches with a shared tag index or classifier would race */
+    if (cache->tag_index.slots || cache->classify) {
+        return NULL;
     }
     
-    /* CACHE MISS */
-    cache->misses++;
+    cache_t *view = malloc(sizeof(cache_t));
+    if (!view) {
+        return NULL;
+    }
     
-    /* Select victim for replacement */
-    cache_line_t *victim = select_victim(set);
+    *view = *cache;
+    view->accesses = 0;
+    view->hits = 0;
+    view->misses = 0;
+    view->reads = 0;
+    view->read_hits = 0;
+    view->writes = 0;
+    view->write_hits = 0;
+    view->writebacks = 0;
+    view->writebacks_in = 0;
+    view->writeback_misses = 0;
+    return view;
+}
+
+void cache_view_merge(cache_t *cache, cache_t *view) {
+    if (!view) return;
     
-    /* Evict victim if necessary (write-back policy) */
-    if (victim->valid && victim->dirty) {
-        /* Write dirty block back to memory */
-        uint32_t victim_addr = (victim->tag << (cache->offset_bits + cache->index_bits)) |
-                               (index << cache->offset_bits);
-        write_block_to_memory(victim, victim_addr);
+    cache->accesses += view->accesses;
+    cache->hits += view->hits;
+    cache->misses += view->misses;
+    cache->reads += view->reads;
+    cache->read_hits += view->read_hits;
+    cache->writes += view->writes;
+    cache->write_hits += view->write_hits;
+    cache->writebacks += view->writebacks;
+    cache->writebacks_in += view->writebacks_in;
+    cache->writeback_misses += view->writeback_misses;
+    free(view);
+}
+
+void cache_save(const cache_t *cache, ckpt_writer_t *w) {
+    ckpt_geometry_t geo;
+    cache_geometry(cache, &geo);
+    ckpt_write(w, &geo, sizeof(geo));
+    
+    ckpt_write(w, cache->set_data, (size_t)cache->num_sets * cache->set_stride);
+    if (cache->tag_index.slots) {
+        ckpt_write(w, cache->tag_index.slots,
+                   ((size_t)cache->tag_index.mask + 1) * sizeof(way_index_slot_t));
     }
     
-    /* Install new block */
-    victim->valid = true;
-    victim->dirty = is_write;  /* Dirty if write miss (write-allocate) */
-    victim->tag = tag;
+    uint64_t stats[] = { cache->accesses, cache->hits, cache->misses, cache->reads,
+                         cache->read_hits, cache->writes, cache->write_hits,
+                         cache->writebacks, cache->writebacks_in, cache->writeback_misses };
+    ckpt_write(w, stats, sizeof(stats));
+}
+
+bool cache_restore(cache_t *cache, ckpt_reader_t *r) {
+    ckpt_geometry_t geo;
+    cache_geometry(cache, &geo);
+    if (!ckpt_check_geometry(r, &geo) ||
+        !ckpt_read(r, cache->set_data, (size_t)cache->num_sets * cache->set_stride)) {
+        return false;
+    }
+    if (cache->tag_index.slots &&
+        !ckpt_read(r, cache->tag_index.slots,
+                   ((size_t)cache->tag_index.mask + 1) * sizeof(way_index_slot_t))) {
+        return false;
+    }
     
-    /* Read block from memory */
-    read_block_from_memory(victim, addr);
+    uint64_t stats[10];
+    if (!ckpt_read(r, stats, sizeof(stats))) {
+        return false;
+    }
+    cache->accesses = stats[0];
+    cache->hits = stats[1];
+    cache->misses = stats[2];
+    cache->reads = stats[3];
+    cache->read_hits = stats[4];
+    cache->writes = stats[5];
+    cache->write_hits = stats[6];
+    cache->writebacks = stats[7];
+    cache->writebacks_in = stats[8];
+    cache->writeback_misses = stats[9];
+    return true;
+}
+
+void cache_reset_stats(cache_t *cache) {
+    cache->accesses = 0;
+    cache->hits = 0;
+    cache->misses = 0;
+    cache->reads = 0;
+    cache->read_hits = 0;
+    cache->writes = 0;
+    cache->write_hits = 0;
+    cache->writebacks = 0;
+    cache->writebacks_in = 0;
+    cache->writeback_misses = 0;
+    if (cache->classify) {
+        classify_reset_stats(cache->classify);
+    }
+}
+
+void cache_fill_stats(const cache_t *cache, stats_group_t *group) {
+    stats_add_counter(group, "accesses", "total accesses", cache->accesses);
+    stats_add_counter(group, "hits", "hits", cache->hits);
+    stats_add_counter(group, "misses", "misses", cache->misses);
+    stats_add_counter(group, "reads", "total reads", cache->reads);
+    stats_add_counter(group, "read_hits", "read hits", cache->read_hits);
+    stats_add_counter(group, "writes", "total writes", cache->writes);
+    stats_add_counter(group, "write_hits", "write hits", cache->write_hits);
+    stats_add_counter(group, "writebacks", "", cache->writebacks);
+    stats_add_counter(group, "writebacks_in", "", cache->writebacks_in);
+    stats_add_counter(group, "writeback_misses", "", cache->writeback_misses);
+}
+
+stats_group_t* cache_register_stats(const cache_t *cache, stats_registry_t *reg,
+                                    const char *key, const char *label) {
+    char title[STATS_TITLE_SIZE];
+    snprintf(title, sizeof(title), "%s Statistics", label ? label : "Cache");
     
-    /* Move to head of LRU (most recently used) */
-    lru_move_to_head(set, victim);
+    stats_group_t *group = stats_add_group(reg, key, title);
+    if (!group) {
+        return NULL;
+    }
+    cache_fill_stats(cache, group);
+    uint32_t at = reg->num_groups - 1;
     
-    return CACHE_MISS;
+    if (cache->classify) {
+        char class_key[24];
+        snprintf(class_key, sizeof(class_key), "%s_3c", key);
+        snprintf(title, sizeof(title), "%s Miss Classification", label ? label : "Cache");
+        stats_group_t *classes = stats_add_group(reg, class_key, title);
+        if (!classes) {
+            return NULL;
+        }
+        classify_fill_stats(cache->classify, classes);
+    }
+    return &reg->groups[at];  /* Adding a group may have moved the registry */
 }
 
 void cache_print_stats(const cache_t *cache, const char *label) {
-    if (label) {
-        printf("\n* %s Statistics *\n", label);
-    } else {
-        printf("\n* Cache Statistics *\n");
-    }
+    stats_group_t group;
+    char title[STATS_TITLE_SIZE];
+    snprintf(title, sizeof(title), "%s Statistics", label ? label : "Cache");
     
-    printf("total accesses: %llu\n", (unsigned long long)cache->accesses);
-    printf("hits: %llu\n", (unsigned long long)cache->hits);
-    printf("misses: %llu\n", (unsigned long long)cache->misses);
-    printf("total reads: %llu\n", (unsigned long long)cache->reads);
-    printf("read hits: %llu\n", (unsigned long long)cache->read_hits);
-    printf("total writes: %llu\n", (unsigned long long)cache->writes);
-    printf("write hits: %llu\n", (unsigned long long)cache->write_hits);
+    stats_group_init(&group, "cache", title);
+    cache_fill_stats(cache, &group);
+    stats_print_group(&group, stdout);
 }
 
-void cache_destroy(cache_t *cache) {
-    if (!cache) return;
+void cache_print_sweep(cache_t *const *caches, uint32_t n) {
+    printf("\n* Configuration Sweep *\n");
+    printf("size block sets ways accesses hits misses miss-ratio\n");
     
-    /* Free all cache lines and their data */
-    for (uint32_t i = 0; i < cache->num_sets; i++) {
-        for (uint32_t j = 0; j < cache->sets[i].num_ways; j++) {
-            free(cache->sets[i].lines[j].data);
-        }
-        free(cache->sets[i].lines);
+    for (uint32_t i = 0; i < n; i++) {
+        const cache_t *cache = caches[i];
+        printf("%u %u %u %u %llu %llu %llu %.6f\n",
+               cache->size, cache->block_size, cache->num_sets, cache->ways_per_set,
+               (unsigned long long)cache->accesses,
+               (unsigned long long)cache->hits,
+               (unsigned long long)cache->misses,
+               cache->accesses ? (double)cache->misses / (double)cache->accesses : 0.0);
     }
+}
+
+void cache_destroy(cache_t *cache) {
+    if (!cache) return;
     
-    free(cache->sets);
+    classify_destroy(cache->classify);
+    way_index_free(&cache->tag_index);
+    free(cache->set_data);
     free(cache);
 }
-
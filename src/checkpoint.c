@@ -0,0 +1,146 @@
+/**
+ * @file checkpoint.c
+ * @brief Versioned binary checkpoints of the simulator state
+ * @author Amir Noohi
+ * @copyright Copyright (c) 2025 Amir Noohi. All rights reserved.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "checkpoint.h"
+#include "types.h"
+
+#define CKPT_MAGIC "VMSIMCKP"
+
+/* Byte-order probe stored in the header (files are not portable across
+ * endianness) */
+#define CKPT_BYTE_ORDER 0x01020304u
+
+/**
+ * @brief File header
+ */
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t byte_order;
+    ckpt_position_t pos;
+} ckpt_header_t;
+
+struct ckpt_writer_s {
+    FILE *file;
+    bool ok;
+};
+
+struct ckpt_reader_s {
+    const uint8_t *base;           /* Mapping of the whole file */
+    size_t size;
+    size_t pos;
+};
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+ckpt_writer_t* ckpt_create(const char *path, const ckpt_position_t *pos) {
+    ckpt_writer_t *w = calloc(1, sizeof(ckpt_writer_t));
+    if (!w) {
+        return NULL;
+    }
+
+    w->file = fopen(path, "wb");
+    if (!w->file) {
+        free(w);
+        return NULL;
+    }
+    w->ok = true;
+
+    ckpt_header_t header = { 0 };
+    memcpy(header.magic, CKPT_MAGIC, sizeof(header.magic));
+    header.version = CKPT_VERSION;
+    header.byte_order = CKPT_BYTE_ORDER;
+    header.pos = *pos;
+    ckpt_write(w, &header, sizeof(header));
+    return w;
+}
+
+void ckpt_write(ckpt_writer_t *w, const void *data, size_t len) {
+    if (w->ok && len > 0 && fwrite(data, 1, len, w->file) != len) {
+        w->ok = false;
+    }
+}
+
+bool ckpt_close(ckpt_writer_t *w) {
+    bool ok = w->ok;
+    if (fclose(w->file) != 0) {
+        ok = false;
+    }
+    free(w);
+    return ok;
+}
+
+ckpt_reader_t* ckpt_open(const char *path, ckpt_position_t *pos) {
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || (size_t)st.st_size < sizeof(ckpt_header_t)) {
+        close(fd);
+        return NULL;
+    }
+
+    void *base = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (base == MAP_FAILED) {
+        return NULL;
+    }
+
+    ckpt_reader_t *r = calloc(1, sizeof(ckpt_reader_t));
+    if (!r) {
+        munmap(base, (size_t)st.st_size);
+        return NULL;
+    }
+    r->base = base;
+    r->size = (size_t)st.st_size;
+
+    ckpt_header_t header;
+    ckpt_read(r, &header, sizeof(header));
+    if (memcmp(header.magic, CKPT_MAGIC, sizeof(header.magic)) != 0 ||
+        header.version != CKPT_VERSION || header.byte_order != CKPT_BYTE_ORDER) {
+        ckpt_release(r);
+        return NULL;
+    }
+
+    *pos = header.pos;
+    return r;
+}
+
+bool ckpt_read(ckpt_reader_t *r, void *data, size_t len) {
+    if (len > r->size - r->pos) {
+        return false;
+    }
+    memcpy(data, r->base + r->pos, len);
+    r->pos += len;
+    return true;
+}
+
+bool ckpt_check_geometry(ckpt_reader_t *r, const ckpt_geometry_t *expected) {
+    ckpt_geometry_t saved;
+    return ckpt_read(r, &saved, sizeof(saved)) &&
+           memcmp(&saved, expected, sizeof(saved)) == 0;
+}
+
+bool ckpt_release(ckpt_reader_t *r) {
+    bool complete = r->pos == r->size;
+    munmap((void *)r->base, r->size);
+    free(r);
+    return complete;
+}
@@ -0,0 +1,216 @@
+/**
+ * @file classify.c
+ * @brief 3C miss classification and per-set conflict heatmaps
+ * @author Amir Noohi
+ * @copyright Copyright (c) 2025 Amir Noohi. All rights reserved.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "classify.h"
+#include "way_index.h"
+#include "types.h"
+
+/**
+ * @brief Counters of one set
+ */
+typedef struct {
+    uint64_t accesses;
+    uint64_t misses;
+    uint64_t compulsory;
+    uint64_t capacity;
+    uint64_t conflict;
+    uint64_t evictions;
+} classify_set_t;
+
+struct classify_s {
+    /* Shadow fully-associative LRU cache */
+    uint32_t capacity;             /* Blocks (sets * ways of the real cache) */
+    uint32_t fill;                 /* Slots in use */
+    uint32_t *blocks;              /* Block held by each slot */
+    uint32_t *prev;                /* LRU list: towards the MRU slot */
+    uint32_t *next;                /* LRU list: towards the LRU slot */
+    uint32_t head;                 /* MRU slot */
+    uint32_t tail;                 /* LRU slot */
+    way_index_t index;             /* Block -> slot */
+
+    /* First-touch set */
+    uint8_t *touched;              /* One bit per block of physical memory */
+    uint32_t num_blocks;
+
+    /* Statistics */
+    uint32_t num_sets;
+    classify_set_t *sets;
+    classify_set_t total;
+};
+
+/* ============================================================================
+ * Helper Functions
+ * ============================================================================ */
+
+static void list_unlink(classify_t *cls, uint32_t slot) {
+    if (cls->prev[slot] != WAY_NONE) {
+        cls->next[cls->prev[slot]] = cls->next[slot];
+    } else {
+        cls->head = cls->next[slot];
+    }
+    if (cls->next[slot] != WAY_NONE) {
+        cls->prev[cls->next[slot]] = cls->prev[slot];
+    } else {
+        cls->tail = cls->prev[slot];
+    }
+}
+
+static void list_push_head(classify_t *cls, uint32_t slot) {
+    cls->prev[slot] = WAY_NONE;
+    cls->next[slot] = cls->head;
+    if (cls->head != WAY_NONE) {
+        cls->prev[cls->head] = slot;
+    } else {
+        cls->tail = slot;
+    }
+    cls->head = slot;
+}
+
+/**
+ * @brief Access the shadow cache
+ *
+ * @return true on a hit
+ */
+static bool shadow_access(classify_t *cls, uint32_t block) {
+    uint32_t slot = way_index_find(&cls->index, block);
+    if (slot != WAY_NONE) {
+        if (slot != cls->head) {
+            list_unlink(cls, slot);
+            list_push_head(cls, slot);
+        }
+        return true;
+    }
+
+    if (cls->fill < cls->capacity) {
+        slot = cls->fill++;
+    } else {
+        slot = cls->tail;
+        list_unlink(cls, slot);
+        way_index_remove(&cls->index, cls->blocks[slot]);
+    }
+    cls->blocks[slot] = block;
+    way_index_insert(&cls->index, block, slot);
+    list_push_head(cls, slot);
+    return false;
+}
+
+/**
+ * @brief Mark a block as referenced
+ *
+ * @return true on its first reference
+ */
+static bool first_touch(classify_t *cls, uint32_t block) {
+    if (block >= cls->num_blocks) {
+        return false;  /* Outside the simulated memory: not tracked */
+    }
+    uint8_t bit = (uint8_t)(1u << (block & 7));
+    if (cls->touched[block >> 3] & bit) {
+        return false;
+    }
+    cls->touched[block >> 3] |= bit;
+    return true;
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+classify_t* classify_create(uint32_t num_sets, uint32_t ways, uint32_t block_size) {
+    if (num_sets == 0 || ways == 0 || block_size == 0) {
+        return NULL;
+    }
+
+    classify_t *cls = calloc(1, sizeof(classify_t));
+    if (!cls) {
+        return NULL;
+    }
+
+    cls->capacity = num_sets * ways;
+    cls->num_sets = num_sets;
+    cls->num_blocks = PAGE_SIZE * NUM_PHYSICAL_PAGES / block_size;
+    cls->head = WAY_NONE;
+    cls->tail = WAY_NONE;
+
+    cls->blocks = malloc((size_t)cls->capacity * sizeof(uint32_t));
+    cls->prev = malloc((size_t)cls->capacity * sizeof(uint32_t));
+    cls->next = malloc((size_t)cls->capacity * sizeof(uint32_t));
+    cls->touched = calloc((cls->num_blocks + 7) / 8, 1);
+    cls->sets = calloc(num_sets, sizeof(classify_set_t));
+    if (!cls->blocks || !cls->prev || !cls->next || !cls->touched || !cls->sets ||
+        !way_index_init(&cls->index, cls->capacity)) {
+        classify_destroy(cls);
+        return NULL;
+    }
+
+    return cls;
+}
+
+void classify_access(classify_t *cls, uint32_t block, uint32_t set, bool miss, bool evicted) {
+    bool first = first_touch(cls, block);
+    bool shadow_hit = shadow_access(cls, block);
+
+    classify_set_t *s = &cls->sets[set];
+    s->accesses++;
+    cls->total.accesses++;
+    if (evicted) {
+        s->evictions++;
+        cls->total.evictions++;
+    }
+    if (!miss) {
+        return;
+    }
+
+    s->misses++;
+    cls->total.misses++;
+    if (first) {
+        s->compulsory++;
+        cls->total.compulsory++;
+    } else if (!shadow_hit) {
+        s->capacity++;
+        cls->total.capacity++;
+    } else {
+        s->conflict++;
+        cls->total.conflict++;
+    }
+}
+
+void classify_reset_stats(classify_t *cls) {
+    memset(cls->sets, 0, (size_t)cls->num_sets * sizeof(classify_set_t));
+    memset(&cls->total, 0, sizeof(cls->total));
+}
+
+void classify_fill_stats(const classify_t *cls, stats_group_t *group) {
+    stats_add_counter(group, "compulsory", "compulsory misses", cls->total.compulsory);
+    stats_add_counter(group, "capacity", "capacity misses", cls->total.capacity);
+    stats_add_counter(group, "conflict", "conflict misses", cls->total.conflict);
+    stats_add_counter(group, "evictions", "evictions", cls->total.evictions);
+}
+
+void classify_write_heatmap(const classify_t *cls, const char *name, FILE *out) {
+    for (uint32_t i = 0; i < cls->num_sets; i++) {
+        const classify_set_t *s = &cls->sets[i];
+        fprintf(out, "%s,%u,%llu,%llu,%llu,%llu,%llu,%llu\n", name, i,
+                (unsigned long long)s->accesses, (unsigned long long)s->misses,
+                (unsigned long long)s->compulsory, (unsigned long long)s->capacity,
+                (unsigned long long)s->conflict, (unsigned long long)s->evictions);
+    }
+}
+
+void classify_destroy(classify_t *cls) {
+    if (!cls) return;
+
+    way_index_free(&cls->index);
+    free(cls->blocks);
+    free(cls->prev);
+    free(cls->next);
+    free(cls->touched);
+    free(cls->sets);
+    free(cls);
+}
@@ -10,9 +10,13 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <ctype.h>
+#include <errno.h>
 #include <unistd.h>
 #include <sys/stat.h>
 #include "config.h"
+#include "trace.h"
+#include "replacement.h"
 #include "types.h"
 
 /**
@@ -28,6 +32,50 @@ static assoc_type_t parse_assoc(int code) {
     }
 }
 
+/**
+ * @brief Parse an associativity argument: a code (1-4) or "<N>w" for N ways
+ * 
+ * Codes keep their historical meaning (unknown codes select fully-assoc).
+ * 
+ * @return false for a malformed way count ("0w", "12x", ...)
+ */
+static bool parse_assoc_arg(const char *arg, assoc_type_t *assoc, uint32_t *ways) {
+    size_t len = strlen(arg);
+    if (len == 0 || arg[len - 1] != 'w') {
+        *assoc = parse_assoc(atoi(arg));
+        *ways = 0;
+        return true;
+    }
+    
+    char *end;
+    unsigned long n = strtoul(arg, &end, 10);
+    if (end != arg + len - 1 || n == 0 || n > UINT32_MAX) {
+        fprintf(stderr, "Invalid configuration\n");
+        return false;
+    }
+    *assoc = N_WAY;
+    *ways = (uint32_t)n;
+    return true;
+}
+
+/**
+ * @brief Check that an N-way geometry divides into whole sets
+ */
+static bool valid_ways(assoc_type_t assoc, uint32_t ways, uint32_t blocks) {
+    return assoc != N_WAY || (ways <= blocks && blocks % ways == 0);
+}
+
+/**
+ * @brief Parse a replacement policy name, reporting unknown names
+ */
+static bool parse_policy(const char *name, repl_policy_t *policy) {
+    if (!repl_parse(name, policy)) {
+        fprintf(stderr, "Invalid configuration\n");
+        return false;
+    }
+    return true;
+}
+
 /**
  * @brief Check if a number is a power of 2
  */
@@ -35,6 +83,313 @@ static bool is_power_of_2(uint32_t n) {
     return n > 0 && (n & (n - 1)) == 0;
 }
 
+/**
+ * @brief Append a cache configuration to the sweep list
+ */
+static bool add_sweep(sim_config_t *config, cache_config_t cache) {
+    cache_config_t *sweep = realloc(config->sweep,
+                                    (config->num_sweep + 1) * sizeof(cache_config_t));
+    if (!sweep) {
+        return false;
+    }
+    config->sweep = sweep;
+    config->sweep[config->num_sweep++] = cache;
+    return true;
+}
+
+/**
+ * @brief Parse a "-C size,block,assoc" tuple
+ */
+static bool parse_sweep_config(sim_config_t *config, const char *arg) {
+    char buf[64];
+    if (strlen(arg) >= sizeof(buf)) {
+        return false;
+    }
+    strcpy(buf, arg);
+    
+    char *size = strtok(buf, ",");
+    char *block = strtok(NULL, ",");
+    char *assoc = strtok(NULL, ",");
+    if (!size || !block || !assoc || strtok(NULL, ",")) {
+        return false;
+    }
+    
+    cache_config_t cache = {0};
+    cache.size = atoi(size);
+    cache.block_size = atoi(block);
+    if (cache.block_size == 0 || !parse_assoc_arg(assoc, &cache.associativity, &cache.ways)) {
+        return false;
+    }
+    return add_sweep(config, cache);
+}
+
+/**
+ * @brief Parse an unsigned option value (decimal, 0x hex or 0 octal)
+ *
+ * Rejects empty values, signs, trailing characters and values above max.
+ */
+static bool parse_u64(const char *arg, uint64_t max, uint64_t *value) {
+    if (!isdigit((unsigned char)arg[0])) {
+        return false;
+    }
+    char *end;
+    errno = 0;
+    unsigned long long v = strtoull(arg, &end, 0);
+    if (*end != '\0' || errno == ERANGE || v > max) {
+        return false;
+    }
+    *value = v;
+    return true;
+}
+
+/**
+ * @brief parse_u64() into a 32-bit field
+ */
+static bool parse_u32(const char *arg, uint32_t *value) {
+    uint64_t v;
+    if (!parse_u64(arg, UINT32_MAX, &v)) {
+        return false;
+    }
+    *value = (uint32_t)v;
+    return true;
+}
+
+/**
+ * @brief Parse a non-negative decimal option value, rejecting trailing
+ * characters
+ */
+static bool parse_fraction(const char *arg, double *value) {
+    if (!isdigit((unsigned char)arg[0]) && arg[0] != '.') {
+        return false;
+    }
+    char *end;
+    double v = strtod(arg, &end);
+    if (*end != '\0') {
+        return false;
+    }
+    *value = v;
+    return true;
+}
+
+/**
+ * @brief Parse "min:max[:step]" (step 0 when omitted: doubling)
+ */
+static bool parse_range(const char *arg, unsigned long *min, unsigned long *max,
+                        unsigned long *step) {
+    char *end;
+    *min = strtoul(arg, &end, 0);
+    if (*end != ':') {
+        return false;
+    }
+    *max = strtoul(end + 1, &end, 0);
+    *step = 0;
+    if (*end == ':') {
+        *step = strtoul(end + 1, &end, 0);
+        if (*step == 0) {
+            return false;
+        }
+    }
+    return *end == '\0' && *min > 0 && *min <= *max && *max <= UINT32_MAX;
+}
+
+/**
+ * @brief Next value of a range
+ */
+static unsigned long range_next(unsigned long value, unsigned long step) {
+    return step ? value + step : value * 2;
+}
+
+/**
+ * @brief Parse "--sweep min:max[:step]": sizes from min to max, doubling or
+ * in steps of step bytes, all with the -B/-A geometry
+ */
+static bool parse_sweep_range(sim_config_t *config, const char *arg) {
+    unsigned long min, max, step;
+    if (!parse_range(arg, &min, &max, &step)) {
+        return false;
+    }
+    
+    /* Geometry is filled in from -B/-A once all arguments are parsed */
+    for (unsigned long size = min; size <= max; size = range_next(size, step)) {
+        cache_config_t cache = {0};
+        cache.size = (uint32_t)size;
+        if (!add_sweep(config, cache)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Append a value to a grid dimension
+ */
+static bool grid_append(uint32_t **list, uint32_t *count, uint32_t value) {
+    uint32_t *grown = realloc(*list, (*count + 1) * sizeof(uint32_t));
+    if (!grown) {
+        return false;
+    }
+    *list = grown;
+    grown[(*count)++] = value;
+    return true;
+}
+
+/**
+ * @brief Parse a grid list of sizes: "a,b,c" or "min:max[:step]"
+ */
+static bool parse_grid_sizes(const char *arg, uint32_t **list, uint32_t *count) {
+    unsigned long min, max, step;
+    if (strchr(arg, ':')) {
+        if (!parse_range(arg, &min, &max, &step)) {
+            return false;
+        }
+        for (unsigned long v = min; v <= max; v = range_next(v, step)) {
+            if (!grid_append(list, count, (uint32_t)v)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    
+    const char *p = arg;
+    for (;;) {
+        char *end;
+        unsigned long v = strtoul(p, &end, 0);
+        if (end == p || v == 0 || v > UINT32_MAX ||
+            !grid_append(list, count, (uint32_t)v)) {
+            return false;
+        }
+        if (*end == '\0') {
+            return true;
+        }
+        if (*end != ',') {
+            return false;
+        }
+        p = end + 1;
+    }
+}
+
+/**
+ * @brief Append an associativity to the grid
+ */
+static bool grid_add_assoc(grid_config_t *grid, assoc_type_t assoc, uint32_t ways) {
+    assoc_type_t *types = realloc(grid->assoc, (grid->num_assoc + 1) * sizeof(assoc_type_t));
+    if (!types) {
+        return false;
+    }
+    grid->assoc = types;
+    
+    uint32_t *counts = realloc(grid->ways, (grid->num_assoc + 1) * sizeof(uint32_t));
+    if (!counts) {
+        return false;
+    }
+    grid->ways = counts;
+    
+    types[grid->num_assoc] = assoc;
+    counts[grid->num_assoc++] = ways;
+    return true;
+}
+
+/**
+ * @brief Parse a grid list of associativities: "1,3,4,8w" (as -A)
+ */
+static bool parse_grid_assoc(grid_config_t *grid, const char *arg) {
+    char *buf = strdup(arg);
+    if (!buf) {
+        return false;
+    }
+    
+    bool ok = true;
+    for (char *item = strtok(buf, ","); ok && item; item = strtok(NULL, ",")) {
+        assoc_type_t assoc;
+        uint32_t ways;
+        ok = parse_assoc_arg(item, &assoc, &ways) && grid_add_assoc(grid, assoc, ways);
+    }
+    
+    free(buf);
+    return ok && grid->num_assoc > 0;
+}
+
+/**
+ * @brief Parse "--latency l1=4,l2=12,...": cycles of the named components
+ */
+static bool parse_latency(latency_config_t *lat, const char *arg) {
+    char *buf = strdup(arg);
+    if (!buf) {
+        return false;
+    }
+    
+    bool ok = true;
+    for (char *item = strtok(buf, ","); ok && item; item = strtok(NULL, ",")) {
+        char *value = strchr(item, '=');
+        if (!value) {
+            ok = false;
+            break;
+        }
+        *value++ = '\0';
+        
+        uint32_t *field = NULL;
+        if (strcmp(item, "l1") == 0) {
+            field = &lat->l1;
+        } else if (strcmp(item, "l2") == 0) {
+            field = &lat->l2;
+        } else if (strcmp(item, "mem") == 0) {
+            field = &lat->memory;
+        } else if (strcmp(item, "walk") == 0) {
+            field = &lat->page_walk;
+        } else if (strcmp(item, "fault") == 0) {
+            field = &lat->page_fault;
+        }
+        
+        char *end;
+        unsigned long cycles = strtoul(value, &end, 0);
+        ok = field && end != value && *end == '\0' && cycles <= UINT32_MAX;
+        if (ok) {
+            *field = (uint32_t)cycles;
+        }
+    }
+    
+    free(buf);
+    return ok;
+}
+
+/**
+ * @brief Validate the geometry of one cache (single-level, level or sweep)
+ */
+static bool valid_cache(const cache_config_t *cache) {
+    /* Cache size must be positive and multiple of 4 */
+    if (cache->size <= 0 || cache->size % 4 != 0) {
+        return false;
+    }
+    
+    /* Block size must be >= 4 and multiple of 4 */
+    if (cache->block_size < 4 || cache->block_size % 4 != 0) {
+        return false;
+    }
+    
+    /* Block size cannot exceed cache size */
+    if (cache->block_size > cache->size) {
+        return false;
+    }
+    
+    /* Validate associativity constraints */
+    switch (cache->associativity) {
+        case TWO_WAY:
+            if (cache->size % (cache->block_size * 2) != 0) {
+                return false;
+            }
+            break;
+        case FOUR_WAY:
+            if (cache->size % (cache->block_size * 4) != 0) {
+                return false;
+            }
+            break;
+        default:
+            break;
+    }
+    return valid_ways(cache->associativity, cache->ways,
+                      cache->size / cache->block_size);
+}
+
 /**
  * @brief Check if file exists
  */
@@ -61,6 +416,15 @@ sim_config_t* parse_arguments(int argc, char *argv[]) {
     config->verbose = false;
     config->trace_file = NULL;
     config->num_levels = 0;
+    config->seed = DEFAULT_SEED;
+    config->mrc_sets = 1;
+    config->shards_rate = 1.0;
+    config->threads = 1;
+    config->latency.l1 = DEFAULT_L1_LATENCY;
+    config->latency.l2 = DEFAULT_L2_LATENCY;
+    config->latency.memory = DEFAULT_MEMORY_LATENCY;
+    config->latency.page_walk = DEFAULT_PAGE_WALK_LATENCY;
+    config->latency.page_fault = DEFAULT_PAGE_FAULT_LATENCY;
     
     /* Parse arguments manually to handle -S1, -S2, etc. */
     bool has_l1 = false, has_l2 = false;
@@ -81,15 +445,188 @@ sim_config_t* parse_arguments(int argc, char *argv[]) {
         } else if (strcmp(argv[i], "-B2") == 0 && i + 1 < argc) {
             config->levels[1].block_size = atoi(argv[++i]);
         } else if (strcmp(argv[i], "-A") == 0 && i + 1 < argc) {
-            config->cache.associativity = parse_assoc(atoi(argv[++i]));
+            if (!parse_assoc_arg(argv[++i], &config->cache.associativity, &config->cache.ways)) {
+                free_config(config);
+                return NULL;
+            }
         } else if (strcmp(argv[i], "-A1") == 0 && i + 1 < argc) {
-            config->levels[0].associativity = parse_assoc(atoi(argv[++i]));
+            if (!parse_assoc_arg(argv[++i], &config->levels[0].associativity, &config->levels[0].ways)) {
+                free_config(config);
+                return NULL;
+            }
         } else if (strcmp(argv[i], "-A2") == 0 && i + 1 < argc) {
-            config->levels[1].associativity = parse_assoc(atoi(argv[++i]));
+            if (!parse_assoc_arg(argv[++i], &config->levels[1].associativity, &config->levels[1].ways)) {
+                free_config(config);
+                return NULL;
+            }
         } else if (strcmp(argv[i], "-T") == 0 && i + 1 < argc) {
             config->tlb.num_entries = atoi(argv[++i]);
         } else if (strcmp(argv[i], "-L") == 0 && i + 1 < argc) {
-            config->tlb.associativity = parse_assoc(atoi(argv[++i]));
+            if (!parse_assoc_arg(argv[++i], &config->tlb.associativity, &config->tlb.ways)) {
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "-P") == 0 && i + 1 < argc) {
+            if (!parse_policy(argv[++i], &config->cache.policy)) {
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "-P1") == 0 && i + 1 < argc) {
+            if (!parse_policy(argv[++i], &config->levels[0].policy)) {
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "-P2") == 0 && i + 1 < argc) {
+            if (!parse_policy(argv[++i], &config->levels[1].policy)) {
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "-PT") == 0 && i + 1 < argc) {
+            if (!parse_policy(argv[++i], &config->tlb.policy)) {
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "--opt") == 0) {
+            config->opt = true;
+        } else if (strcmp(argv[i], "-C") == 0 && i + 1 < argc) {
+            if (!parse_sweep_config(config, argv[++i])) {
+                fprintf(stderr, "Invalid configuration\n");
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "--sweep") == 0 && i + 1 < argc) {
+            if (!parse_sweep_range(config, argv[++i])) {
+                fprintf(stderr, "Invalid configuration\n");
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "--grid-sizes") == 0 && i + 1 < argc) {
+            if (!parse_grid_sizes(argv[++i], &config->grid.sizes, &config->grid.num_sizes)) {
+                fprintf(stderr, "Invalid configuration\n");
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "--grid-assoc") == 0 && i + 1 < argc) {
+            if (!parse_grid_assoc(&config->grid, argv[++i])) {
+                fprintf(stderr, "Invalid configuration\n");
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "--grid-tlb") == 0 && i + 1 < argc) {
+            if (!parse_grid_sizes(argv[++i], &config->grid.tlb_entries, &config->grid.num_tlb)) {
+                fprintf(stderr, "Invalid configuration\n");
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "--grid-threads") == 0 && i + 1 < argc) {
+            if (!parse_u32(argv[++i], &config->grid.threads)) {
+                fprintf(stderr, "Invalid configuration\n");
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "--grid-format") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "csv") == 0) {
+                config->grid.format = GRID_CSV;
+            } else if (strcmp(argv[i], "json") == 0) {
+                config->grid.format = GRID_JSON;
+            } else {
+                fprintf(stderr, "Invalid configuration\n");
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "--pipeline") == 0) {
+            config->pipeline = true;
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            if (!parse_u32(argv[++i], &config->threads)) {
+                fprintf(stderr, "Invalid configuration\n");
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "--checkpoint-at") == 0 && i + 2 < argc) {
+            if (!parse_u64(argv[++i], UINT64_MAX, &config->checkpoint_at)) {
+                fprintf(stderr, "Invalid configuration\n");
+                free_config(config);
+                return NULL;
+            }
+            free(config->checkpoint_file);
+            config->checkpoint_file = strdup(argv[++i]);
+        } else if (strcmp(argv[i], "--stats-format") == 0 && i + 1 < argc) {
+            i++;
+            if (strcmp(argv[i], "text") == 0) {
+                config->stats_format = STATS_TEXT;
+            } else if (strcmp(argv[i], "json") == 0) {
+                config->stats_format = STATS_JSON;
+            } else if (strcmp(argv[i], "csv") == 0) {
+                config->stats_format = STATS_CSV;
+            } else {
+                fprintf(stderr, "Invalid configuration\n");
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "--timing") == 0) {
+            config->timing = true;
+        } else if (strcmp(argv[i], "--latency") == 0 && i + 1 < argc) {
+            config->timing = true;
+            if (!parse_latency(&config->latency, argv[++i])) {
+                fprintf(stderr, "Invalid configuration\n");
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "--writebacks") == 0) {
+            config->writebacks = true;
+        } else if (strcmp(argv[i], "--warmup") == 0 && i + 1 < argc) {
+            if (!parse_u64(argv[++i], UINT64_MAX, &config->warmup)) {
+                fprintf(stderr, "Invalid configuration\n");
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "--interval") == 0 && i + 1 < argc) {
+            if (!parse_u64(argv[++i], UINT64_MAX, &config->interval)) {
+                fprintf(stderr, "Invalid configuration\n");
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "--restore") == 0 && i + 1 < argc) {
+            free(config->restore_file);
+            config->restore_file = strdup(argv[++i]);
+        } else if (strcmp(argv[i], "--mrc") == 0) {
+            config->mrc = true;
+        } else if (strcmp(argv[i], "--mrc-sets") == 0 && i + 1 < argc) {
+            config->mrc = true;
+            if (!parse_u32(argv[++i], &config->mrc_sets)) {
+                fprintf(stderr, "Invalid configuration\n");
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "--shards-rate") == 0 && i + 1 < argc) {
+            config->mrc = true;
+            if (!parse_fraction(argv[++i], &config->shards_rate)) {
+                fprintf(stderr, "Invalid configuration\n");
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "--shards-budget") == 0 && i + 1 < argc) {
+            config->mrc = true;
+            if (!parse_u32(argv[++i], &config->shards_budget)) {
+                fprintf(stderr, "Invalid configuration\n");
+                free_config(config);
+                return NULL;
+            }
+        } else if (strcmp(argv[i], "--classify") == 0) {
+            config->classify = true;
+        } else if (strcmp(argv[i], "--heatmap") == 0 && i + 1 < argc) {
+            config->classify = true;
+            free(config->heatmap_file);
+            config->heatmap_file = strdup(argv[++i]);
+        } else if (strcmp(argv[i], "--hash-index") == 0) {
+            config->hash_index = true;
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            if (!parse_u32(argv[++i], &config->seed)) {
+                fprintf(stderr, "Invalid configuration\n");
+                free_config(config);
+                return NULL;
+            }
         } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
             config->trace_file = strdup(argv[++i]);
         } else if (strcmp(argv[i], "-v") == 0) {
@@ -115,6 +652,62 @@ sim_config_t* parse_arguments(int argc, char *argv[]) {
             config->levels[1].associativity = FULLY_ASSOC;
     }
     
+    /* Offline mode: Belady OPT replaces every policy */
+    if (config->opt) {
+        config->cache.policy = REPL_OPT;
+        config->tlb.policy = REPL_OPT;
+        for (uint32_t i = 0; i < MAX_CACHE_LEVELS; i++) {
+            config->levels[i].policy = REPL_OPT;
+        }
+    }
+    
+    /* Every structure draws its random state from the same seed */
+    config->cache.seed = config->seed;
+    config->tlb.seed = config->seed;
+    for (uint32_t i = 0; i < MAX_CACHE_LEVELS; i++) {
+        config->levels[i].seed = config->seed;
+    }
+    
+    /* Sweep caches use the -P policy; --sweep sizes take the -B/-A geometry */
+    for (uint32_t i = 0; i < config->num_sweep; i++) {
+        cache_config_t *cache = &config->sweep[i];
+        if (cache->block_size == 0) {
+            cache->block_size = config->cache.block_size;
+            cache->associativity = config->cache.associativity;
+            cache->ways = config->cache.ways;
+        }
+        cache->policy = config->cache.policy;
+        cache->seed = config->seed;
+        cache->hash_index = config->hash_index;
+    }
+    
+    /* Grid dimensions that were not given take the single -S/-A/-T value */
+    grid_config_t *grid = &config->grid;
+    if (grid->num_sizes || grid->num_assoc || grid->num_tlb) {
+        bool ok = true;
+        if (grid->num_sizes == 0) {
+            ok = grid_append(&grid->sizes, &grid->num_sizes, config->cache.size);
+        }
+        if (ok && grid->num_assoc == 0) {
+            ok = grid_add_assoc(grid, config->cache.associativity, config->cache.ways);
+        }
+        if (ok && grid->num_tlb == 0) {
+            ok = grid_append(&grid->tlb_entries, &grid->num_tlb, config->tlb.num_entries);
+        }
+        if (!ok) {
+            fprintf(stderr, "Memory allocation failed\n");
+            free_config(config);
+            return NULL;
+        }
+    }
+    
+    /* Hashed set indexing applies to every structure */
+    config->cache.hash_index = config->hash_index;
+    config->tlb.hash_index = config->hash_index;
+    for (uint32_t i = 0; i < MAX_CACHE_LEVELS; i++) {
+        config->levels[i].hash_index = config->hash_index;
+    }
+    
     /* Detect task */
     config->task = detect_task(config);
     
@@ -137,76 +730,17 @@ int detect_task(const sim_config_t *config) {
 bool validate_config(const sim_config_t *config) {
     /* Validate single-level cache */
     if (config->num_levels == 0) {
-        /* Cache size must be positive and multiple of 4 */
-        if (config->cache.size <= 0 || config->cache.size % 4 != 0) {
-            fprintf(stderr, "Invalid configuration\n");
-            return false;
-        }
-        
-        /* Block size must be >= 4 and multiple of 4 */
-        if (config->cache.block_size < 4 || config->cache.block_size % 4 != 0) {
-            fprintf(stderr, "Invalid configuration\n");
-            return false;
-        }
-        
-        /* Block size cannot exceed cache size */
-        if (config->cache.block_size > config->cache.size) {
+        if (!valid_cache(&config->cache)) {
             fprintf(stderr, "Invalid configuration\n");
             return false;
         }
-        
-        /* Validate associativity constraints */
-        switch (config->cache.associativity) {
-            case TWO_WAY:
-                if (config->cache.size % (config->cache.block_size * 2) != 0) {
-                    fprintf(stderr, "Invalid configuration\n");
-                    return false;
-                }
-                break;
-            case FOUR_WAY:
-                if (config->cache.size % (config->cache.block_size * 4) != 0) {
-                    fprintf(stderr, "Invalid configuration\n");
-                    return false;
-                }
-                break;
-            default:
-                break;
-        }
     } else {
         /* Validate multi-level cache */
         for (uint32_t i = 0; i < config->num_levels; i++) {
-            if (config->levels[i].size <= 0 || config->levels[i].size % 4 != 0) {
-                fprintf(stderr, "Invalid configuration\n");
-                return false;
-            }
-            if (config->levels[i].block_size < 4 || config->levels[i].block_size % 4 != 0) {
+            if (!valid_cache(&config->levels[i])) {
                 fprintf(stderr, "Invalid configuration\n");
                 return false;
             }
-            
-            /* Block size cannot exceed cache size */
-            if (config->levels[i].block_size > config->levels[i].size) {
-                fprintf(stderr, "Invalid configuration\n");
-                return false;
-            }
-            
-            /* Check associativity constraints */
-            switch (config->levels[i].associativity) {
-                case TWO_WAY:
-                    if (config->levels[i].size % (config->levels[i].block_size * 2) != 0) {
-                        fprintf(stderr, "Invalid configuration\n");
-                        return false;
-                    }
-                    break;
-                case FOUR_WAY:
-                    if (config->levels[i].size % (config->levels[i].block_size * 4) != 0) {
-                        fprintf(stderr, "Invalid configuration\n");
-                        return false;
-                    }
-                    break;
-                default:
-                    break;
-            }
         }
         
         /* L2 must be >= L1 */
@@ -223,7 +757,13 @@ bool validate_config(const sim_config_t *config) {
         fprintf(stderr, "Invalid configuration\n");
         return false;
     }
-    if (!is_power_of_2(config->tlb.num_entries)) {
+    /* Explicit way counts may give any whole number of sets */
+    if (config->tlb.associativity == N_WAY) {
+        if (!valid_ways(N_WAY, config->tlb.ways, config->tlb.num_entries)) {
+            fprintf(stderr, "Invalid configuration\n");
+            return false;
+        }
+    } else if (!is_power_of_2(config->tlb.num_entries)) {
         fprintf(stderr, "Invalid configuration\n");
         return false;
     }
@@ -246,12 +786,118 @@ bool validate_config(const sim_config_t *config) {
             break;
     }
     
+    /* Sweep caches (-C, --sweep) see the regular (non-OPT) address stream */
+    for (uint32_t i = 0; i < config->num_sweep; i++) {
+        if (config->opt || !valid_cache(&config->sweep[i])) {
+            fprintf(stderr, "Invalid configuration\n");
+            return false;
+        }
+    }
+    
+    /* Miss-ratio curves profile the regular (non-OPT) address stream, in
+     * blocks of the (L1) cache */
+    if (config->mrc) {
+        uint32_t block_size = config->num_levels ? config->levels[0].block_size
+                                                 : config->cache.block_size;
+        if (config->opt || config->mrc_sets == 0 ||
+            config->mrc_sets > PAGE_SIZE * NUM_PHYSICAL_PAGES / block_size ||
+            !(config->shards_rate > 0.0 && config->shards_rate <= 1.0)) {
+            fprintf(stderr, "Invalid configuration\n");
+            return false;
+        }
+    }
+    
+    /* Grid points are standalone single-level runs, each valid on its own */
+    if (config->grid.num_sizes > 0) {
+        uint64_t points = (uint64_t)config->grid.num_sizes * config->grid.num_assoc *
+                          config->grid.num_tlb;
+        if (config->num_levels > 0 || config->verbose || config->opt ||
+            config->mrc || config->num_sweep > 0 || points > UINT32_MAX) {
+            fprintf(stderr, "Invalid configuration\n");
+            return false;
+        }
+        for (uint32_t i = 0; i < (uint32_t)points; i++) {
+            sim_config_t point;
+            config_grid_point(config, i, &point);
+            if (!validate_config(&point)) {
+                return false;
+            }
+        }
+    }
+    
+    /* Set sharding covers the single-level cache only, without per-access
+     * results (-v) or the offline OPT replay */
+    if (config->threads == 0 ||
+        (config->threads > 1 && (config->num_levels > 0 || config->verbose ||
+                                 config->opt || config->grid.num_sizes > 0))) {
+        fprintf(stderr, "Invalid configuration\n");
+        return false;
+    }
+    
+    /* The OPT replay runs its own multi-pass schedule */
+    if (config->pipeline && config->opt) {
+        fprintf(stderr, "Invalid configuration\n");
+        return false;
+    }
+    
+    /* Checkpoints cover the regular simulation of one configuration; the
+     * OPT replay and the profiler's stack are not saved */
+    if ((config->checkpoint_file || config->restore_file) &&
+        (config->opt || config->mrc || config->grid.num_sizes > 0)) {
+        fprintf(stderr, "Invalid configuration\n");
+        return false;
+    }
+    
+    /* The OPT replay and grid points run the whole trace in one pass */
+    if ((config->warmup > 0 || config->interval > 0) &&
+        (config->opt || config->grid.num_sizes > 0)) {
+        fprintf(stderr, "Invalid configuration\n");
+        return false;
+    }
+    
+    /* Machine-readable reports hold the registry only: no per-access lines,
+     * curve or interval table mixed in */
+    if (config->stats_format != STATS_TEXT &&
+        (config->verbose || config->mrc || config->interval > 0 ||
+         config->grid.num_sizes > 0)) {
+        fprintf(stderr, "Invalid configuration\n");
+        return false;
+    }
+    
+    /* Cache levels need a latency to take part in AMAT; timing needs the
+     * result of every access, which the shards and the OPT replay do not
+     * report, and its counts are not saved in checkpoints */
+    if (config->latency.l1 == 0 || config->latency.l2 == 0 ||
+        (config->timing &&
+         (config->opt || config->threads > 1 || config->grid.num_sizes > 0 ||
+          config->checkpoint_file || config->restore_file))) {
+        fprintf(stderr, "Invalid configuration\n");
+        return false;
+    }
+    
+    /* Writebacks travel between cache levels; the OPT replay runs each
+     * level in its own pass, so it cannot interleave them */
+    if (config->writebacks && (config->num_levels == 0 || config->opt)) {
+        fprintf(stderr, "Invalid configuration\n");
+        return false;
+    }
+    
+    /* The classifiers follow one cache's sequential access stream: their
+     * shadow state is neither shared by shards nor saved in checkpoints */
+    if (config->classify &&
+        (config->opt || config->threads > 1 || config->grid.num_sizes > 0 ||
+         config->checkpoint_file || config->restore_file)) {
+        fprintf(stderr, "Invalid configuration\n");
+        return false;
+    }
+    
     /* Validate trace file */
     if (!config->trace_file) {
         fprintf(stderr, "Invalid configuration\n");
         return false;
     }
-    if (!file_exists(config->trace_file)) {
+    if (strcmp(config->trace_file, TRACE_STDIN) != 0 &&
+        !file_exists(config->trace_file)) {
         fprintf(stderr, "Invalid configuration\n");
         return false;
     }
@@ -259,11 +905,38 @@ bool validate_config(const sim_config_t *config) {
     return true;
 }
 
+uint32_t config_grid_points(const sim_config_t *config) {
+    return config->grid.num_sizes * config->grid.num_assoc * config->grid.num_tlb;
+}
+
+void config_grid_point(const sim_config_t *config, uint32_t index, sim_config_t *point) {
+    const grid_config_t *grid = &config->grid;
+    uint32_t tlb = index % grid->num_tlb;
+    uint32_t assoc = index / grid->num_tlb % grid->num_assoc;
+    uint32_t size = index / grid->num_tlb / grid->num_assoc;
+    
+    *point = *config;
+    memset(&point->grid, 0, sizeof(point->grid));
+    point->cache.size = grid->sizes[size];
+    point->cache.associativity = grid->assoc[assoc];
+    point->cache.ways = grid->ways[assoc];
+    point->tlb.num_entries = grid->tlb_entries[tlb];
+    point->task = detect_task(point);
+}
+
 void free_config(sim_config_t *config) {
     if (config) {
         if (config->trace_file) {
             free(config->trace_file);
         }
+        free(config->checkpoint_file);
+        free(config->restore_file);
+        free(config->heatmap_file);
+        free(config->sweep);
+        free(config->grid.sizes);
+        free(config->grid.assoc);
+        free(config->grid.ways);
+        free(config->grid.tlb_entries);
         free(config);
     }
 }
@@ -273,18 +946,20 @@ void print_config(const sim_config_t *config) {
     printf("Task: %d\n", config->task);
     
     if (config->num_levels == 0) {
-        printf("Cache: Size=%u, Block=%u, Assoc=%d\n",
-               config->cache.size, config->cache.block_size, config->cache.associativity);
+        printf("Cache: Size=%u, Block=%u, Assoc=%d, Policy=%s\n",
+               config->cache.size, config->cache.block_size, config->cache.associativity,
+               repl_name(config->cache.policy));
     } else {
         for (uint32_t i = 0; i < config->num_levels; i++) {
-            printf("L%u Cache: Size=%u, Block=%u, Assoc=%d\n",
+            printf("L%u Cache: Size=%u, Block=%u, Assoc=%d, Policy=%s\n",
                    i+1, config->levels[i].size, config->levels[i].block_size,
-                   config->levels[i].associativity);
+                   config->levels[i].associativity, repl_name(config->levels[i].policy));
         }
     }
     
-    printf("TLB: Entries=%u, Assoc=%d\n",
-           config->tlb.num_entries, config->tlb.associativity);
+    printf("TLB: Entries=%u, Assoc=%d, Policy=%s\n",
+           config->tlb.num_entries, config->tlb.associativity,
+           repl_name(config->tlb.policy));
     printf("Trace: %s\n", config->trace_file);
     printf("Verbose: %s\n", config->verbose ? "Yes" : "No");
     printf("====================\n\n");
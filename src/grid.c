@@ -0,0 +1,188 @@
+/**
+ * @file grid.c
+ * @brief Parallel parameter-grid driver (--grid-*)
+ * @author Amir Noohi
+ * @copyright Copyright (c) 2025 Amir Noohi. All rights reserved.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdatomic.h>
+#include "grid.h"
+#include "config.h"
+#include "pool.h"
+#include "sim.h"
+#include "trace.h"
+#include "types.h"
+
+/* Initial capacity of the decoded trace buffer (records) */
+#define GRID_TRACE_CHUNK (1 << 16)
+
+/**
+ * @brief Work shared by all grid tasks
+ */
+typedef struct {
+    const sim_config_t *points;    /* Configuration of each point */
+    sim_stats_t *results;          /* Result of each point */
+    const trace_record_t *recs;    /* Decoded trace (read-only) */
+    size_t num_recs;
+    atomic_bool failed;
+} grid_job_t;
+
+/* ============================================================================
+ * Helper Functions
+ * ============================================================================ */
+
+/**
+ * @brief Decode a whole trace into memory
+ */
+static trace_record_t* load_trace(const char *path, size_t *count) {
+    trace_reader_t *trace = trace_open(path);
+    if (!trace) {
+        return NULL;
+    }
+
+    size_t capacity = GRID_TRACE_CHUNK;
+    size_t n = 0;
+    trace_record_t *recs = malloc(capacity * sizeof(trace_record_t));
+
+    while (recs) {
+        if (n == capacity) {
+            trace_record_t *grown = realloc(recs, 2 * capacity * sizeof(trace_record_t));
+            if (!grown) {
+                free(recs);
+                recs = NULL;
+                break;
+            }
+            recs = grown;
+            capacity *= 2;
+        }
+        if (!trace_next(trace, &recs[n])) {
+            break;
+        }
+        n++;
+    }
+
+    if (trace_failed(trace)) {
+        free(recs);
+        recs = NULL;
+    }
+    trace_close(trace);
+    *count = n;
+    return recs;
+}
+
+/**
+ * @brief Simulate one grid point (pool task)
+ */
+static void run_point(void *arg, size_t index) {
+    grid_job_t *job = arg;
+    sim_ctx_t *sim = sim_create(&job->points[index]);
+
+    if (!sim || !sim_run_records(sim, job->recs, job->num_recs)) {
+        atomic_store(&job->failed, true);
+    } else {
+        sim_get_stats(sim, &job->results[index]);
+    }
+    sim_destroy(sim);
+}
+
+static double miss_ratio(const sim_stats_t *r) {
+    return r->cache_accesses ? (double)r->cache_misses / (double)r->cache_accesses : 0.0;
+}
+
+static void print_csv(const sim_config_t *points, const sim_stats_t *results, uint32_t n) {
+    printf("size,block,sets,ways,tlb_entries,tlb_hits,tlb_misses,"
+           "page_faults,page_faults_dirty,accesses,hits,misses,miss_ratio\n");
+
+    for (uint32_t i = 0; i < n; i++) {
+        const sim_config_t *p = &points[i];
+        const sim_stats_t *r = &results[i];
+        printf("%u,%u,%u,%u,%u,%llu,%llu,%llu,%llu,%llu,%llu,%llu,%.6f\n",
+               p->cache.size, p->cache.block_size, r->cache_sets, r->cache_ways,
+               p->tlb.num_entries,
+               (unsigned long long)r->tlb_hits,
+               (unsigned long long)r->tlb_misses,
+               (unsigned long long)r->page_faults,
+               (unsigned long long)r->page_faults_dirty,
+               (unsigned long long)r->cache_accesses,
+               (unsigned long long)r->cache_hits,
+               (unsigned long long)r->cache_misses,
+               miss_ratio(r));
+    }
+}
+
+static void print_json(const sim_config_t *points, const sim_stats_t *results, uint32_t n) {
+    printf("[\n");
+
+    for (uint32_t i = 0; i < n; i++) {
+        const sim_config_t *p = &points[i];
+        const sim_stats_t *r = &results[i];
+        printf("  {\"size\": %u, \"block\": %u, \"sets\": %u, \"ways\": %u, "
+               "\"tlb_entries\": %u, \"tlb_hits\": %llu, \"tlb_misses\": %llu, "
+               "\"page_faults\": %llu, \"page_faults_dirty\": %llu, "
+               "\"accesses\": %llu, \"hits\": %llu, \"misses\": %llu, "
+               "\"miss_ratio\": %.6f}%s\n",
+               p->cache.size, p->cache.block_size, r->cache_sets, r->cache_ways,
+               p->tlb.num_entries,
+               (unsigned long long)r->tlb_hits,
+               (unsigned long long)r->tlb_misses,
+               (unsigned long long)r->page_faults,
+               (unsigned long long)r->page_faults_dirty,
+               (unsigned long long)r->cache_accesses,
+               (unsigned long long)r->cache_hits,
+               (unsigned long long)r->cache_misses,
+               miss_ratio(r), i + 1 < n ? "," : "");
+    }
+
+    printf("]\n");
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+bool grid_run(const sim_config_t *config) {
+    uint32_t n = config_grid_points(config);
+    grid_job_t job = { 0 };
+    sim_config_t *points = calloc(n, sizeof(sim_config_t));
+    sim_stats_t *results = calloc(n, sizeof(sim_stats_t));
+    trace_record_t *recs = NULL;
+
+    if (points && results) {
+        recs = load_trace(config->trace_file, &job.num_recs);
+    }
+    if (!recs) {
+        fprintf(stderr, "Invalid configuration\n");
+        free(points);
+        free(results);
+        return false;
+    }
+
+    for (uint32_t i = 0; i < n; i++) {
+        config_grid_point(config, i, &points[i]);
+    }
+    job.points = points;
+    job.results = results;
+    job.recs = recs;
+    atomic_init(&job.failed, false);
+
+    uint32_t threads = config->grid.threads ? config->grid.threads : pool_cpu_count();
+    pool_run(threads, n, run_point, &job);
+
+    bool ok = !atomic_load(&job.failed);
+    if (ok) {
+        if (config->grid.format == GRID_JSON) {
+            print_json(points, results, n);
+        } else {
+            print_csv(points, results, n);
+        }
+    } else {
+        fprintf(stderr, "Grid simulation failed\n");
+    }
+
+    free(recs);
+    free(points);
+    free(results);
+    return ok;
+}
@@ -0,0 +1,393 @@
+/**
+ * @file mrc.c
+ * @brief Single-pass LRU miss-ratio curves (Mattson stack distances)
+ * @author Amir Noohi
+ * @copyright Copyright (c) 2025 Amir Noohi. All rights reserved.
+ *
+ * Each set numbers its accesses 0, 1, 2, ... and keeps a Fenwick tree
+ * with a 1 at the time of every block's latest access. The stack distance
+ * of a re-access is the number of 1s after the block's previous time.
+ *
+ * SHARDS sampling keeps a block only if hash(block) < T (out of 2^24), a
+ * rate R = T / 2^24. Distances among sampled blocks are divided by R and
+ * each sampled access counts 1/R times. With a memory budget, the tracked
+ * block with the largest hash is dropped whenever the budget is exceeded
+ * and T falls to its hash, so R adapts to the trace footprint.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "mrc.h"
+#include "types.h"
+
+/* External functions from cache.c */
+extern uint32_t log2_uint32(uint32_t n);
+extern uint32_t hash_set_index(uint32_t block, uint32_t num_sets);
+
+/* Time slots of a set before its first renumbering */
+#define MRC_INITIAL_SLOTS 16
+
+/* "Not accessed yet" (block) and "free slot" (time) marker */
+#define MRC_NONE UINT32_MAX
+
+/* Sampling hashes are compared against a threshold out of 2^24 */
+#define SHARDS_BITS 24
+#define SHARDS_MOD (1u << SHARDS_BITS)
+
+/**
+ * @brief Access times of one set
+ */
+typedef struct {
+    uint32_t *tree;                /* Fenwick tree over slots (1-based) */
+    uint32_t *owner;               /* Block whose latest access is the slot */
+    uint32_t slots;                /* Capacity of tree and owner */
+    uint32_t now;                  /* Next free slot */
+    uint32_t live;                 /* Blocks with a mark in the tree */
+} mrc_set_t;
+
+struct mrc_s {
+    uint32_t block_size;
+    uint32_t offset_bits;
+    uint32_t num_sets;
+    bool hash_index;
+
+    mrc_set_t *sets;
+    uint32_t *last;                /* Slot of each block's latest access */
+    uint32_t num_blocks;           /* Blocks of physical memory */
+
+    double *hist;                  /* hist[d]: accesses at stack distance d */
+    uint32_t max_distance;         /* Largest distance seen + 1 */
+    uint64_t accesses;             /* All accesses, sampled or not */
+    double weight;                 /* Accesses represented by the samples */
+    double cold;                   /* First accesses (infinite distance) */
+
+    /* SHARDS sampling (threshold == SHARDS_MOD: every block is kept) */
+    uint32_t threshold;
+    uint32_t budget;               /* Max tracked blocks, 0 = fixed rate */
+    uint32_t *heap;                /* Tracked blocks, max-heap on hash */
+    uint32_t tracked;
+};
+
+/* ============================================================================
+ * Fenwick Tree
+ * ============================================================================ */
+
+static void fenwick_add(uint32_t *tree, uint32_t slots, uint32_t pos, int32_t delta) {
+    for (uint32_t i = pos + 1; i <= slots; i += i & (~i + 1)) {
+        tree[i] += (uint32_t)delta;
+    }
+}
+
+/**
+ * @brief Number of marks in slots [0, pos)
+ */
+static uint32_t fenwick_prefix(const uint32_t *tree, uint32_t pos) {
+    uint32_t sum = 0;
+    for (uint32_t i = pos; i > 0; i -= i & (~i + 1)) {
+        sum += tree[i];
+    }
+    return sum;
+}
+
+/**
+ * @brief Renumber the live marks of a set to slots [0, live)
+ *
+ * The tree doubles when more than half of it would stay occupied, so
+ * renumbering costs O(1) amortized per access.
+ */
+static bool compact_set(mrc_t *mrc, mrc_set_t *set) {
+    uint32_t slots = set->slots;
+    if (set->live * 2 > slots) {
+        slots *= 2;
+        uint32_t *owner = realloc(set->owner, slots * sizeof(uint32_t));
+        if (!owner) {
+            return false;
+        }
+        set->owner = owner;
+        free(set->tree);
+        set->tree = malloc(((size_t)slots + 1) * sizeof(uint32_t));
+        if (!set->tree) {
+            return false;
+        }
+    }
+
+    /* Slide live entries down, keeping their order */
+    uint32_t j = 0;
+    for (uint32_t t = 0; t < set->now; t++) {
+        uint32_t block = set->owner[t];
+        if (block != MRC_NONE) {
+            set->owner[j] = block;
+            mrc->last[block] = j++;
+        }
+    }
+    for (uint32_t t = j; t < slots; t++) {
+        set->owner[t] = MRC_NONE;
+    }
+
+    /* Rebuild the tree in linear time */
+    set->tree[0] = 0;
+    for (uint32_t i = 1; i <= slots; i++) {
+        set->tree[i] = (i <= j) ? 1 : 0;
+    }
+    for (uint32_t i = 1; i <= slots; i++) {
+        uint32_t parent = i + (i & (~i + 1));
+        if (parent <= slots) {
+            set->tree[parent] += set->tree[i];
+        }
+    }
+
+    set->slots = slots;
+    set->now = j;
+    return true;
+}
+
+/* ============================================================================
+ * SHARDS Sampling
+ * ============================================================================ */
+
+/**
+ * @brief Sampling hash of a block (murmur3 finalizer, SHARDS_BITS bits)
+ */
+static uint32_t shards_hash(uint32_t block) {
+    uint32_t h = block;
+    h ^= h >> 16;
+    h *= 0x85ebca6bu;
+    h ^= h >> 13;
+    h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h & (SHARDS_MOD - 1);
+}
+
+static void heap_push(mrc_t *mrc, uint32_t block) {
+    uint32_t i = mrc->tracked++;
+    uint32_t h = shards_hash(block);
+    while (i > 0) {
+        uint32_t parent = (i - 1) / 2;
+        if (shards_hash(mrc->heap[parent]) >= h) {
+            break;
+        }
+        mrc->heap[i] = mrc->heap[parent];
+        i = parent;
+    }
+    mrc->heap[i] = block;
+}
+
+static uint32_t heap_pop(mrc_t *mrc) {
+    uint32_t top = mrc->heap[0];
+    uint32_t block = mrc->heap[--mrc->tracked];
+    uint32_t h = shards_hash(block);
+    uint32_t i = 0;
+    for (;;) {
+        uint32_t child = 2 * i + 1;
+        if (child >= mrc->tracked) {
+            break;
+        }
+        if (child + 1 < mrc->tracked &&
+            shards_hash(mrc->heap[child + 1]) > shards_hash(mrc->heap[child])) {
+            child++;
+        }
+        if (shards_hash(mrc->heap[child]) <= h) {
+            break;
+        }
+        mrc->heap[i] = mrc->heap[child];
+        i = child;
+    }
+    mrc->heap[i] = block;
+    return top;
+}
+
+/**
+ * @brief Set index of a block, as selected by the cache
+ */
+static uint32_t block_set(const mrc_t *mrc, uint32_t block) {
+    return mrc->hash_index ? hash_set_index(block, mrc->num_sets)
+                           : block % mrc->num_sets;
+}
+
+/**
+ * @brief Forget the latest access of a block
+ */
+static void untrack(mrc_t *mrc, mrc_set_t *set, uint32_t block) {
+    uint32_t prev = mrc->last[block];
+    fenwick_add(set->tree, set->slots, prev, -1);
+    set->owner[prev] = MRC_NONE;
+    set->live--;
+    mrc->last[block] = MRC_NONE;
+}
+
+/**
+ * @brief Drop the largest-hash blocks until the budget holds again
+ */
+static void enforce_budget(mrc_t *mrc) {
+    while (mrc->tracked > mrc->budget) {
+        uint32_t block = heap_pop(mrc);
+        untrack(mrc, &mrc->sets[block_set(mrc, block)], block);
+        mrc->threshold = shards_hash(block);
+    }
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+mrc_t* mrc_create(uint32_t block_size, uint32_t num_sets, bool hash_index) {
+    mrc_t *mrc = calloc(1, sizeof(mrc_t));
+    if (!mrc) {
+        return NULL;
+    }
+
+    mrc->block_size = block_size;
+    mrc->offset_bits = log2_uint32(block_size);
+    mrc->num_sets = num_sets;
+    mrc->hash_index = hash_index && num_sets > 1;
+    mrc->num_blocks = (uint32_t)((uint64_t)PAGE_SIZE * NUM_PHYSICAL_PAGES / block_size);
+
+    mrc->sets = calloc(num_sets, sizeof(mrc_set_t));
+    mrc->last = malloc(mrc->num_blocks * sizeof(uint32_t));
+    mrc->hist = calloc((size_t)mrc->num_blocks + 1, sizeof(double));
+    mrc->threshold = SHARDS_MOD;
+    if (!mrc->sets || !mrc->last || !mrc->hist) {
+        mrc_destroy(mrc);
+        return NULL;
+    }
+
+    for (uint32_t b = 0; b < mrc->num_blocks; b++) {
+        mrc->last[b] = MRC_NONE;
+    }
+
+    for (uint32_t s = 0; s < num_sets; s++) {
+        mrc_set_t *set = &mrc->sets[s];
+        set->slots = MRC_INITIAL_SLOTS;
+        set->tree = calloc(set->slots + 1, sizeof(uint32_t));
+        set->owner = malloc(set->slots * sizeof(uint32_t));
+        if (!set->tree || !set->owner) {
+            mrc_destroy(mrc);
+            return NULL;
+        }
+        for (uint32_t t = 0; t < set->slots; t++) {
+            set->owner[t] = MRC_NONE;
+        }
+    }
+
+    return mrc;
+}
+
+bool mrc_set_sampling(mrc_t *mrc, double rate, uint32_t budget) {
+    if (budget > 0) {
+        mrc->heap = malloc(((size_t)budget + 1) * sizeof(uint32_t));
+        if (!mrc->heap) {
+            return false;
+        }
+        mrc->budget = budget;
+        mrc->threshold = SHARDS_MOD;
+    } else {
+        mrc->threshold = (uint32_t)ceil(rate * SHARDS_MOD);
+    }
+    return true;
+}
+
+bool mrc_access(mrc_t *mrc, uint32_t paddr) {
+    uint32_t block = (paddr >> mrc->offset_bits) % mrc->num_blocks;
+
+    mrc->accesses++;
+
+    /* Spatial sampling: a block is either always or never profiled */
+    if (mrc->threshold < SHARDS_MOD && shards_hash(block) >= mrc->threshold) {
+        return true;
+    }
+
+    mrc_set_t *set = &mrc->sets[block_set(mrc, block)];
+    double rate = (double)mrc->threshold / SHARDS_MOD;
+    mrc->weight += 1.0 / rate;
+
+    /* Distance = blocks of the set accessed since this block's last access */
+    uint32_t prev = mrc->last[block];
+    if (prev != MRC_NONE) {
+        uint32_t distance = set->live - fenwick_prefix(set->tree, prev + 1);
+        if (rate < 1.0) {
+            distance = (uint32_t)fmin(distance / rate, mrc->num_blocks);
+        }
+        mrc->hist[distance] += 1.0 / rate;
+        if (distance >= mrc->max_distance) {
+            mrc->max_distance = distance + 1;
+        }
+
+        untrack(mrc, set, block);
+    } else {
+        mrc->cold += 1.0 / rate;
+        if (mrc->budget) {
+            heap_push(mrc, block);
+        }
+    }
+
+    /* Mark the block at the current time */
+    if (set->now == set->slots && !compact_set(mrc, set)) {
+        fprintf(stderr, "Out of memory for miss-ratio curve\n");
+        return false;
+    }
+    uint32_t now = set->now++;
+    fenwick_add(set->tree, set->slots, now, 1);
+    set->owner[now] = block;
+    set->live++;
+    mrc->last[block] = now;
+
+    if (mrc->budget) {
+        enforce_budget(mrc);
+    }
+    return true;
+}
+
+void mrc_reset_stats(mrc_t *mrc) {
+    memset(mrc->hist, 0, (size_t)mrc->max_distance * sizeof(double));
+    mrc->max_distance = 0;
+    mrc->accesses = 0;
+    mrc->weight = 0.0;
+    mrc->cold = 0.0;
+}
+
+void mrc_print(const mrc_t *mrc) {
+    printf("\n* Miss-Ratio Curve *\n");
+    printf("block size: %u\n", mrc->block_size);
+    printf("sets: %u\n", mrc->num_sets);
+    if (mrc->threshold < SHARDS_MOD) {
+        printf("sampling rate: %.6f\n", (double)mrc->threshold / SHARDS_MOD);
+    }
+    printf("accesses: %llu\n", (unsigned long long)mrc->accesses);
+
+    /* Sampled counts are scaled to the real number of accesses */
+    double scale = mrc->weight > 0 ? (double)mrc->accesses / mrc->weight : 0.0;
+    printf("cold misses: %llu\n", (unsigned long long)llround(mrc->cold * scale));
+    printf("ways size misses miss-ratio\n");
+
+    /* Ways W hit every access with distance < W */
+    double misses = mrc->weight;
+    for (uint32_t d = 0; d < mrc->max_distance; d++) {
+        if (mrc->hist[d] == 0) {
+            continue;
+        }
+        misses -= mrc->hist[d];
+        uint32_t ways = d + 1;
+        printf("%u %llu %llu %.6f\n", ways,
+               (unsigned long long)ways * mrc->num_sets * mrc->block_size,
+               (unsigned long long)llround(misses * scale),
+               mrc->weight > 0 ? misses / mrc->weight : 0.0);
+    }
+}
+
+void mrc_destroy(mrc_t *mrc) {
+    if (!mrc) return;
+
+    if (mrc->sets) {
+        for (uint32_t s = 0; s < mrc->num_sets; s++) {
+            free(mrc->sets[s].tree);
+            free(mrc->sets[s].owner);
+        }
+        free(mrc->sets);
+    }
+    free(mrc->last);
+    free(mrc->hist);
+    free(mrc->heap);
+    free(mrc);
+}
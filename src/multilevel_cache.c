@@ -10,10 +10,27 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <stdint.h>
 #include "multilevel_cache.h"
 #include "cache.h"
+#include "stats.h"
 #include "types.h"
 
+/* Accesses pushed through the levels together by the batch path */
+#define MULTILEVEL_BATCH 256
+
+/* level_op_t.pos of a writeback */
+#define WRITEBACK_OP SIZE_MAX
+
+/**
+ * @brief One operation reaching a level below L1 (--writebacks batch path)
+ */
+typedef struct {
+    size_t pos;                    /* Index into results, or WRITEBACK_OP */
+    uint32_t addr;
+    bool is_write;
+} level_op_t;
+
 /**
  * @brief Encode hit result based on level number
  */
@@ -22,12 +39,102 @@ static cache_result_t encode_hit_level(uint32_t level) {
     return CACHE_HIT_L1 + level;
 }
 
+/**
+ * @brief Write the logged dirty victims of a level into the next one
+ * 
+ * Victims that the next level evicts in turn are passed on likewise.
+ */
+static void drain_writebacks(multilevel_cache_t *mlc, uint32_t level) {
+    cache_t *cache = mlc->levels[level];
+    for (uint32_t i = 0; i < cache->wb_count; i++) {
+        cache_write_back(mlc->levels[level + 1], cache->wb_log[i].addr);
+    }
+    cache->wb_count = 0;
+    
+    if (level + 2 < mlc->num_levels) {
+        drain_writebacks(mlc, level + 1);
+    }
+}
+
+/**
+ * @brief Batch path with writeback propagation
+ * 
+ * L1 only sees demand accesses and keeps the batched path. Every other
+ * level gets, in order, each demand miss of the level above followed by
+ * the victim that miss wrote back, and passes its own misses and victims
+ * on the same way.
+ */
+static void access_batch_writeback(multilevel_cache_t *mlc, const uint32_t *addrs,
+                                   const bool *is_write, size_t n,
+                                   cache_result_t *results) {
+    /* A level below L1 gets at most one demand access and one writeback
+     * per access of the batch from each level above */
+    level_op_t ops[2][MULTILEVEL_BATCH * MAX_CACHE_LEVELS];
+    cache_result_t l1_results[MULTILEVEL_BATCH];
+    cache_t *l1 = mlc->levels[0];
+    
+    for (size_t base = 0; base < n; base += MULTILEVEL_BATCH) {
+        size_t count = n - base < MULTILEVEL_BATCH ? n - base : MULTILEVEL_BATCH;
+        
+        uint64_t first_op = l1->accesses + l1->writebacks_in;
+        cache_access_batch(l1, addrs + base, is_write + base, count, l1_results);
+        
+        /* Operations reaching L2: each L1 miss, then its victim */
+        level_op_t *cur = ops[0];
+        size_t num_ops = 0;
+        uint32_t wb = 0;
+        for (size_t i = 0; i < count; i++) {
+            if (l1_results[i] == CACHE_HIT) {
+                results[base + i] = encode_hit_level(0);
+                continue;
+            }
+            results[base + i] = CACHE_MISS_ALL_LEVELS;
+            cur[num_ops++] = (level_op_t){ base + i, addrs[base + i], is_write[base + i] };
+            if (wb < l1->wb_count && l1->wb_log[wb].op == first_op + i + 1) {
+                cur[num_ops++] = (level_op_t){ WRITEBACK_OP, l1->wb_log[wb++].addr, true };
+            }
+        }
+        l1->wb_count = 0;
+        
+        for (uint32_t level = 1; level < mlc->num_levels && num_ops > 0; level++) {
+            cache_t *cache = mlc->levels[level];
+            bool last = (level + 1 == mlc->num_levels);
+            level_op_t *next = ops[level & 1];
+            size_t num_next = 0;
+            
+            for (size_t k = 0; k < num_ops; k++) {
+                const level_op_t *op = &cur[k];
+                if (op->pos == WRITEBACK_OP) {
+                    cache_write_back(cache, op->addr);
+                } else {
+                    mlc->level_accesses[level]++;
+                    if (cache_access(cache, op->addr, op->is_write) == CACHE_HIT) {
+                        results[op->pos] = encode_hit_level(level);
+                    } else if (!last) {
+                        next[num_next++] = *op;
+                    }
+                }
+                
+                if (!last) {
+                    for (uint32_t i = 0; i < cache->wb_count; i++) {
+                        next[num_next++] = (level_op_t){ WRITEBACK_OP, cache->wb_log[i].addr, true };
+                    }
+                    cache->wb_count = 0;
+                }
+            }
+            
+            cur = next;
+            num_ops = num_next;
+        }
+    }
+}
+
 /**
  * @brief Validate 2-level cache hierarchy
  * 
  * Ensures that L2 size >= L1 size and block sizes are compatible.
  */
-static bool validate_hierarchy(cache_config_t *configs, uint32_t num_levels) {
+static bool validate_hierarchy(const cache_config_t *configs, uint32_t num_levels) {
     for (uint32_t i = 1; i < num_levels; i++) {
         /* Each level should be >= previous level */
         if (configs[i].size < configs[i-1].size) {
@@ -45,7 +152,7 @@ static bool validate_hierarchy(cache_config_t *configs, uint32_t num_levels) {
     return true;
 }
 
-multilevel_cache_t* multilevel_cache_init(cache_config_t *configs, uint32_t num_levels) {
+multilevel_cache_t* multilevel_cache_init(const cache_config_t *configs, uint32_t num_levels) {
     /* Validate input - Task 4 requires exactly 2 levels */
     if (num_levels != 2) {
         fprintf(stderr, "Invalid number of cache levels: %u (Task 4 requires exactly 2 levels)\n",
@@ -102,6 +209,7 @@ cache_result_t multilevel_cache_access(multilevel_cache_t *mlc,
      * 2-level cache access pattern for Task 4
      * Check L1 first, then L2 on miss
      */
+    cache_result_t hit = CACHE_MISS_ALL_LEVELS;
     for (uint32_t level = 0; level < mlc->num_levels; level++) {
         cache_t *cache = mlc->levels[level];
         
@@ -118,44 +226,188 @@ cache_result_t multilevel_cache_access(multilevel_cache_t *mlc,
              * HIT at this level (L1 or L2)
              * Return encoded result indicating which level hit
              */
-            return encode_hit_level(level);
+            hit = encode_hit_level(level);
+            break;
         }
     }
     
     /*
      * Missed at both L1 and L2 - fetch from memory
-     * The cache_access() calls already handle installation
+     * The cache_access() calls already handle installation; dirty victims
+     * follow the demand access into the next level
      */
+    if (mlc->propagate_writebacks) {
+        drain_writebacks(mlc, 0);
+    }
+    return hit;
+}
+
+bool multilevel_cache_propagate_writebacks(multilevel_cache_t *mlc) {
+    /* The last level's victims go to memory and are only counted */
+    for (uint32_t i = 0; i + 1 < mlc->num_levels; i++) {
+        if (!mlc->wb_log[i]) {
+            mlc->wb_log[i] = malloc(MULTILEVEL_BATCH * sizeof(cache_writeback_t));
+            if (!mlc->wb_log[i]) {
+                return false;
+            }
+        }
+        cache_set_writeback_log(mlc->levels[i], mlc->wb_log[i]);
+    }
+    mlc->propagate_writebacks = true;
+    return true;
+}
+
+cache_result_t multilevel_cache_access_level(multilevel_cache_t *mlc,
+                                             uint32_t level, uint32_t addr,
+                                             bool is_write) {
+    if (level > 0) {
+        mlc->level_accesses[level]++;
+    }
+    
+    if (cache_access(mlc->levels[level], addr, is_write) == CACHE_HIT) {
+        return encode_hit_level(level);
+    }
     return CACHE_MISS_ALL_LEVELS;
 }
 
-void multilevel_cache_print_stats(const multilevel_cache_t *mlc) {
-    if (!mlc) return;
+void multilevel_cache_access_batch(multilevel_cache_t *mlc,
+                                   const uint32_t *addrs,
+                                   const bool *is_write, size_t n,
+                                   cache_result_t *results) {
+    if (mlc->propagate_writebacks) {
+        access_batch_writeback(mlc, addrs, is_write, n, results);
+        return;
+    }
     
-    /* Print statistics for each level */
+    size_t pos[MULTILEVEL_BATCH];          /* Index into results */
+    uint32_t pending_addrs[MULTILEVEL_BATCH];
+    bool pending_write[MULTILEVEL_BATCH];
+    cache_result_t level_results[MULTILEVEL_BATCH];
+
+    for (size_t base = 0; base < n; base += MULTILEVEL_BATCH) {
+        size_t pending = n - base < MULTILEVEL_BATCH ? n - base : MULTILEVEL_BATCH;
+
+        for (size_t i = 0; i < pending; i++) {
+            pos[i] = base + i;
+            pending_addrs[i] = addrs[base + i];
+            pending_write[i] = is_write[base + i];
+            results[base + i] = CACHE_MISS_ALL_LEVELS;
+        }
+
+        /*
+         * Levels do not interact, so running each level over all of the
+         * accesses that reach it keeps every level's access order intact
+         */
+        for (uint32_t level = 0; level < mlc->num_levels && pending > 0; level++) {
+            if (level > 0) {
+                mlc->level_accesses[level] += pending;
+            }
+
+            cache_access_batch(mlc->levels[level], pending_addrs,
+                               pending_write, pending, level_results);
+
+            /* Compact the misses for the next level */
+            size_t missed = 0;
+            for (size_t i = 0; i < pending; i++) {
+                if (level_results[i] == CACHE_HIT) {
+                    results[pos[i]] = encode_hit_level(level);
+                } else {
+                    pos[missed] = pos[i];
+                    pending_addrs[missed] = pending_addrs[i];
+                    pending_write[missed] = pending_write[i];
+                    missed++;
+                }
+            }
+            pending = missed;
+        }
+    }
+}
+
+void multilevel_cache_save(const multilevel_cache_t *mlc, ckpt_writer_t *w) {
+    ckpt_write(w, &mlc->num_levels, sizeof(mlc->num_levels));
+    ckpt_write(w, mlc->level_accesses, sizeof(mlc->level_accesses));
+    for (uint32_t i = 0; i < mlc->num_levels; i++) {
+        cache_save(mlc->levels[i], w);
+    }
+}
+
+bool multilevel_cache_restore(multilevel_cache_t *mlc, ckpt_reader_t *r) {
+    uint32_t num_levels;
+    if (!ckpt_read(r, &num_levels, sizeof(num_levels)) ||
+        num_levels != mlc->num_levels ||
+        !ckpt_read(r, mlc->level_accesses, sizeof(mlc->level_accesses))) {
+        return false;
+    }
     for (uint32_t i = 0; i < mlc->num_levels; i++) {
+        if (!cache_restore(mlc->levels[i], r)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void multilevel_cache_reset_stats(multilevel_cache_t *mlc) {
+    for (uint32_t i = 0; i < mlc->num_levels; i++) {
+        mlc->level_accesses[i] = 0;
+        cache_reset_stats(mlc->levels[i]);
+    }
+}
+
+void multilevel_cache_register_stats(const multilevel_cache_t *mlc, stats_registry_t *reg) {
+    /* One group per level */
+    for (uint32_t i = 0; i < mlc->num_levels; i++) {
+        char key[16];
         char label[32];
+        snprintf(key, sizeof(key), "l%u", i + 1);
         snprintf(label, sizeof(label), "L%u Cache", i + 1);
-        cache_print_stats(mlc->levels[i], label);
+        cache_register_stats(mlc->levels[i], reg, key, label);
     }
     
-    /* Optional: Print hierarchy-specific statistics */
+    /* Hierarchy-specific statistics */
     if (mlc->num_levels >= 2) {
-        printf("\n* Multi-Level Cache Summary *\n");
-        for (uint32_t i = 0; i < mlc->num_levels; i++) {
-            printf("L%u accesses: %llu\n", i + 1, 
-                   (unsigned long long)(i == 0 ? mlc->levels[i]->accesses : 
-                                                 mlc->level_accesses[i]));
+        stats_group_t *group = stats_add_group(reg, "hierarchy", "Multi-Level Cache Summary");
+        for (uint32_t i = 0; group && i < mlc->num_levels; i++) {
+            char key[24];
+            char label[32];
+            snprintf(key, sizeof(key), "l%u_accesses", i + 1);
+            snprintf(label, sizeof(label), "L%u accesses", i + 1);
+            stats_add_counter(group, key, label,
+                              i == 0 ? mlc->levels[i]->accesses : mlc->level_accesses[i]);
+        }
+        
+        /* Writeback traffic between the levels and to memory */
+        for (uint32_t i = 0; group && mlc->propagate_writebacks && i < mlc->num_levels; i++) {
+            char key[24];
+            char label[32];
+            if (i + 1 < mlc->num_levels) {
+                snprintf(key, sizeof(key), "l%u_writebacks", i + 1);
+                snprintf(label, sizeof(label), "L%u writebacks to L%u", i + 1, i + 2);
+            } else {
+                snprintf(key, sizeof(key), "memory_writebacks");
+                snprintf(label, sizeof(label), "memory writebacks");
+            }
+            stats_add_counter(group, key, label, mlc->levels[i]->writebacks);
         }
     }
 }
 
+void multilevel_cache_print_stats(const multilevel_cache_t *mlc) {
+    if (!mlc) return;
+    
+    stats_registry_t reg;
+    stats_init(&reg);
+    multilevel_cache_register_stats(mlc, &reg);
+    stats_emit(&reg, stats_get_sink(STATS_TEXT), stdout);
+    stats_free(&reg);
+}
+
 void multilevel_cache_destroy(multilevel_cache_t *mlc) {
     if (!mlc) return;
     
     /* Destroy all cache levels */
     for (uint32_t i = 0; i < mlc->num_levels; i++) {
         cache_destroy(mlc->levels[i]);
+        free(mlc->wb_log[i]);
     }
     
     free(mlc);
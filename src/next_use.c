@@ -0,0 +1,130 @@
+/**
+ * @file next_use.c
+ * @brief Disk-backed next-use streams for offline (Belady OPT) replay
+ * @author Amir Noohi
+ * @copyright Copyright (c) 2025 Amir Noohi. All rights reserved.
+ *
+ * next_use_finish() walks the key file from its end in chunks. Within a
+ * chunk, keys are visited backwards while a table remembers the position
+ * at which each key was last seen, which is exactly the next use of the
+ * current occurrence. Each chunk of results is written at its final
+ * offset, so the result file can then be read front to back.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/types.h>
+#include "next_use.h"
+#include "replacement.h"
+#include "types.h"
+
+/* Keys processed per chunk of the backward pass */
+#define NEXT_USE_CHUNK (1 << 16)
+
+/* Largest supported key space */
+#define NEXT_USE_MAX_KEY_BITS 24
+
+struct next_use_s {
+    FILE *keys;                    /* uint32_t key sequence */
+    FILE *next;                    /* uint64_t next-use positions */
+    uint64_t count;                /* Keys appended */
+    uint32_t key_mask;
+};
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+next_use_t* next_use_create(uint32_t key_bits) {
+    if (key_bits > NEXT_USE_MAX_KEY_BITS) {
+        return NULL;
+    }
+
+    next_use_t *nu = calloc(1, sizeof(next_use_t));
+    if (!nu) {
+        return NULL;
+    }
+
+    nu->keys = tmpfile();
+    nu->next = tmpfile();
+    if (!nu->keys || !nu->next) {
+        fprintf(stderr, "Failed to create temporary file for OPT replay\n");
+        next_use_destroy(nu);
+        return NULL;
+    }
+
+    nu->key_mask = (1u << key_bits) - 1;
+    return nu;
+}
+
+bool next_use_append(next_use_t *nu, uint32_t key) {
+    key &= nu->key_mask;
+    if (fwrite(&key, sizeof(key), 1, nu->keys) != 1) {
+        return false;
+    }
+    nu->count++;
+    return true;
+}
+
+bool next_use_finish(next_use_t *nu) {
+    uint64_t *last = malloc(((size_t)nu->key_mask + 1) * sizeof(uint64_t));
+    uint32_t *keys = malloc(NEXT_USE_CHUNK * sizeof(uint32_t));
+    uint64_t *next = malloc(NEXT_USE_CHUNK * sizeof(uint64_t));
+    bool ok = last && keys && next && fflush(nu->keys) == 0;
+
+    if (ok) {
+        for (size_t k = 0; k <= nu->key_mask; k++) {
+            last[k] = REPL_NEVER;
+        }
+    }
+
+    /* Walk the sequence backwards, one chunk at a time */
+    uint64_t hi = nu->count;
+    while (ok && hi > 0) {
+        uint64_t lo = hi > NEXT_USE_CHUNK ? hi - NEXT_USE_CHUNK : 0;
+        size_t n = (size_t)(hi - lo);
+
+        ok = fseeko(nu->keys, (off_t)(lo * sizeof(uint32_t)), SEEK_SET) == 0 &&
+             fread(keys, sizeof(uint32_t), n, nu->keys) == n;
+        if (!ok) {
+            break;
+        }
+
+        for (size_t i = n; i-- > 0;) {
+            next[i] = last[keys[i]];
+            last[keys[i]] = lo + i;
+        }
+
+        ok = fseeko(nu->next, (off_t)(lo * sizeof(uint64_t)), SEEK_SET) == 0 &&
+             fwrite(next, sizeof(uint64_t), n, nu->next) == n;
+        hi = lo;
+    }
+
+    free(last);
+    free(keys);
+    free(next);
+
+    if (!ok) {
+        fprintf(stderr, "Failed to compute next-use times for OPT replay\n");
+        return false;
+    }
+
+    /* The key file is no longer needed; results are read from the start */
+    fclose(nu->keys);
+    nu->keys = NULL;
+    return fflush(nu->next) == 0 && fseeko(nu->next, 0, SEEK_SET) == 0;
+}
+
+bool next_use_read(next_use_t *nu, uint64_t *next) {
+    return fread(next, sizeof(*next), 1, nu->next) == 1;
+}
+
+void next_use_destroy(next_use_t *nu) {
+    if (!nu) return;
+
+    if (nu->keys) fclose(nu->keys);
+    if (nu->next) fclose(nu->next);
+    free(nu);
+}
@@ -0,0 +1,79 @@
+/**
+ * @file output.c
+ * @brief Buffered, allocation-free text output
+ * @author Amir Noohi
+ * @copyright Copyright (c) 2025 Amir Noohi. All rights reserved.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "output.h"
+#include "types.h"
+
+/* Two lowercase hex digits for every byte value */
+static const char hex_pairs[256][2] = {
+#define HEX_ROW(h) \
+    {h, '0'}, {h, '1'}, {h, '2'}, {h, '3'}, {h, '4'}, {h, '5'}, {h, '6'}, {h, '7'}, \
+    {h, '8'}, {h, '9'}, {h, 'a'}, {h, 'b'}, {h, 'c'}, {h, 'd'}, {h, 'e'}, {h, 'f'}
+    HEX_ROW('0'), HEX_ROW('1'), HEX_ROW('2'), HEX_ROW('3'),
+    HEX_ROW('4'), HEX_ROW('5'), HEX_ROW('6'), HEX_ROW('7'),
+    HEX_ROW('8'), HEX_ROW('9'), HEX_ROW('a'), HEX_ROW('b'),
+    HEX_ROW('c'), HEX_ROW('d'), HEX_ROW('e'), HEX_ROW('f')
+#undef HEX_ROW
+};
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+void out_init(out_writer_t *w, FILE *file) {
+    w->file = file;
+    w->len = 0;
+}
+
+void out_flush(out_writer_t *w) {
+    if (w->len > 0) {
+        fwrite(w->buf, 1, w->len, w->file);
+        w->len = 0;
+    }
+}
+
+void out_write(out_writer_t *w, const char *s, size_t len) {
+    if (w->len + len > OUT_BUFFER_SIZE) {
+        out_flush(w);
+        if (len > OUT_BUFFER_SIZE) {
+            fwrite(s, 1, len, w->file);
+            return;
+        }
+    }
+    memcpy(w->buf + w->len, s, len);
+    w->len += len;
+}
+
+void out_char(out_writer_t *w, char c) {
+    if (w->len == OUT_BUFFER_SIZE) {
+        out_flush(w);
+    }
+    w->buf[w->len++] = c;
+}
+
+void out_hex(out_writer_t *w, uint32_t value, int min_digits) {
+    if (w->len + OUT_MAX_ITEM > OUT_BUFFER_SIZE) {
+        out_flush(w);
+    }
+
+    /* Format all 8 digits, then keep the significant/padded tail */
+    char digits[8];
+    memcpy(digits + 0, hex_pairs[(value >> 24) & 0xff], 2);
+    memcpy(digits + 2, hex_pairs[(value >> 16) & 0xff], 2);
+    memcpy(digits + 4, hex_pairs[(value >> 8) & 0xff], 2);
+    memcpy(digits + 6, hex_pairs[value & 0xff], 2);
+
+    int len = 8;
+    while (len > min_digits && digits[8 - len] == '0') {
+        len--;
+    }
+
+    memcpy(w->buf + w->len, digits + 8 - len, (size_t)len);
+    w->len += (size_t)len;
+}
@@ -4,7 +4,8 @@
  * @author Amir Noohi
  * @copyright Copyright (c) 2025 Amir Noohi. All rights reserved.
  * 
- * Linear page table with LRU page replacement.
+ * Linear page table with LRU page replacement (or Belady OPT, --opt).
+ * All state lives in a pagetable_t, so several page tables can coexist.
  * Students implement this module for the assignment.
  */
 
@@ -12,30 +13,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include "pagetable.h"
+#include "checkpoint.h"
+#include "stats.h"
+#include "output.h"
 #include "ll.h"
 #include "types.h"
 
-/* ============================================================================
- * Global State
- * ============================================================================ */
-
-/* Page table array */
-static pte_t page_table[PAGE_TABLE_ENTRIES];
-
-/* Free page list */
-static page_t *free_page_list = NULL;
-
-/* Used page list (for LRU tracking) */
-static page_t *used_page_list = NULL;
-
-/* Hash table for quick frame lookup */
-static page_t *frame_table[NUM_PHYSICAL_PAGES];
-
-/* Statistics */
-static uint64_t pt_accesses = 0;
-static uint64_t page_faults = 0;
-static uint64_t page_faults_dirty = 0;
-
 /* ============================================================================
  * Helper Functions
  * ============================================================================ */
@@ -59,26 +42,41 @@ static page_t* create_page(uint32_t frame_id) {
 /**
  * @brief Get a free page from the free list
  */
-static page_t* get_free_page(void) {
-    if (!free_page_list) {
+static page_t* get_free_page(pagetable_t *pt) {
+    if (!pt->free_page_list) {
         return NULL;  /* No free pages */
     }
     
     /* Remove from free list */
-    page_t *page = ll_remove_head(&free_page_list);
+    page_t *page = ll_remove_head(&pt->free_page_list);
     return page;
 }
 
 /**
- * @brief Get LRU victim page for eviction
+ * @brief Get the used page accessed furthest in the future (OPT)
+ */
+static page_t* get_opt_page(pagetable_t *pt) {
+    page_t *victim = pt->used_page_list;
+    
+    for (page_t *page = pt->used_page_list; page; page = page->next) {
+        if (page->next_use > victim->next_use) {
+            victim = page;
+        }
+    }
+    
+    return victim;
+}
+
+/**
+ * @brief Get victim page for eviction (LRU, or OPT if enabled)
  */
-static page_t* get_victim_page(void) {
-    /* Get tail of used list (LRU page) */
-    page_t *victim = ll_get_tail(used_page_list);
+static page_t* get_victim_page(pagetable_t *pt) {
+    /* LRU: tail of used list; OPT: furthest next use */
+    page_t *victim = pt->opt_enabled ? get_opt_page(pt) : ll_get_tail(pt->used_page_list);
     
     if (victim) {
         /* Remove from used list */
-        ll_remove_page(&used_page_list, victim);
+        ll_remove_page(&pt->used_page_list, victim);
         
         /* Mark PTE as not present */
         if (victim->pte) {
@@ -89,6 +87,19 @@ static page_t* get_victim_page(void) {
     return victim;
 }
 
+/**
+ * @brief Describe the page table for checkpoints
+ */
+static void pagetable_geometry(ckpt_geometry_t *geo) {
+    memset(geo, 0, sizeof(*geo));
+    geo->sets = PAGE_TABLE_ENTRIES;
+    geo->ways = NUM_PHYSICAL_PAGES;
+    geo->block_size = PAGE_SIZE;
+    geo->state_bytes = sizeof(pte_t) * PAGE_TABLE_ENTRIES +
+                       sizeof(uint32_t) * (NUM_PHYSICAL_PAGES + 1);
+    strncpy(geo->policy, "lru", sizeof(geo->policy) - 1);
+}
+
 /* ============================================================================
  * Dummy I/O Functions (PROVIDED)
  * ============================================================================ */
@@ -108,49 +119,61 @@ void write_page_to_disk(const uint8_t *page_data) {
  * Public API Implementation
  * ============================================================================ */
 
-void pagetable_init(void) {
+pagetable_t* pagetable_init(void) {
+    pagetable_t *pt = calloc(1, sizeof(pagetable_t));
+    if (!pt) {
+        return NULL;
+    }
+    
     /* Initialize page table entries */
     for (uint32_t i = 0; i < PAGE_TABLE_ENTRIES; i++) {
-        page_table[i].present = false;
-        page_table[i].dirty = false;
-        page_table[i].ppn = 0;
+        pt->page_table[i].present = false;
+        pt->page_table[i].dirty = false;
+        pt->page_table[i].ppn = 0;
     }
     
     /* Initialize frame table */
     for (uint32_t i = 0; i < NUM_PHYSICAL_PAGES; i++) {
-        frame_table[i] = NULL;
+        pt->frame_table[i] = NULL;
     }
     
     /* Create free page list (all physical pages initially free) */
     for (int i = NUM_PHYSICAL_PAGES - 1; i >= 0; i--) {
         page_t *page = create_page(i);
-        if (page) {
-            frame_table[i] = page;
-            ll_insert_head(&free_page_list, page);
+        if (!page) {
+            pagetable_destroy(pt);
+            return NULL;
         }
+        pt->frame_table[i] = page;
+        ll_insert_head(&pt->free_page_list, page);
     }
     
-    used_page_list = NULL;
+    pt->used_page_list = NULL;
     
     /* Reset statistics */
-    pt_accesses = 0;
-    page_faults = 0;
-    page_faults_dirty = 0;
+    pt->accesses = 0;
+    pt->page_faults = 0;
+    pt->page_faults_dirty = 0;
+    
+    return pt;
 }
 
-pt_result_t pagetable_lookup(uint32_t vpn, uint32_t *ppn, bool *dirty) {
-    pt_accesses++;
+pt_result_t pagetable_lookup(pagetable_t *pt, uint32_t vpn, uint32_t *ppn, bool *dirty) {
+    pt->accesses++;
     
     /* Check if page is present */
-    if (page_table[vpn].present) {
+    if (pt->page_table[vpn].present) {
         /* Page hit */
-        *ppn = page_table[vpn].ppn;
-        *dirty = page_table[vpn].dirty;
+        *ppn = pt->page_table[vpn].ppn;
+        *dirty = pt->page_table[vpn].dirty;
         
         /* Update LRU - move page to head of used list */
-        page_t *page = frame_table[page_table[vpn].ppn];
-        if (page && page != used_page_list) {
-            ll_move_to_head(&used_page_list, page);
+        page_t *page = pt->frame_table[pt->page_table[vpn].ppn];
+        if (page && page != pt->used_page_list) {
+            ll_move_to_head(&pt->used_page_list, page);
+        }
+        if (page) {
+            page->next_use = pt->opt_next_use;
         }
         
         return PT_HIT;
@@ -160,17 +183,17 @@ pt_result_t pagetable_lookup(uint32_t vpn, uint32_t *ppn, bool *dirty) {
     return PT_MISS;
 }
 
-uint32_t pagetable_handle_fault(uint32_t vpn) {
-    page_faults++;
+uint32_t pagetable_handle_fault(pagetable_t *pt, uint32_t vpn) {
+    pt->page_faults++;
     
     page_t *page = NULL;
     
     /* Try to get a free page */
-    page = get_free_page();
+    page = get_free_page(pt);
     
     if (!page) {
         /* No free pages - must evict */
-        page = get_victim_page();
+        page = get_victim_page(pt);
         
         if (!page) {
             fprintf(stderr, "FATAL: No pages available for allocation\n");
@@ -179,7 +202,7 @@ uint32_t pagetable_handle_fault(uint32_t vpn) {
         
         /* Write back if dirty */
         if (page->pte && page->pte->dirty) {
-            page_faults_dirty++;
+            pt->page_faults_dirty++;
             write_page_to_disk(page->data);
             page->pte->dirty = false;
         }
@@ -189,56 +212,173 @@ uint32_t pagetable_handle_fault(uint32_t vpn) {
     read_page_from_disk(page->data, vpn);
     
     /* Update page table entry */
-    page_table[vpn].present = true;
-    page_table[vpn].dirty = false;
-    page_table[vpn].ppn = page->frame_id;
+    pt->page_table[vpn].present = true;
+    pt->page_table[vpn].dirty = false;
+    pt->page_table[vpn].ppn = page->frame_id;
     
     /* Link page to PTE */
-    page->pte = &page_table[vpn];
+    page->pte = &pt->page_table[vpn];
+    page->next_use = pt->opt_next_use;
     
     /* Add to head of used list (most recently used) */
-    ll_insert_head(&used_page_list, page);
+    ll_insert_head(&pt->used_page_list, page);
     
     return page->frame_id;
 }
 
-void pagetable_set_dirty(uint32_t vpn) {
-    if (page_table[vpn].present) {
-        page_table[vpn].dirty = true;
+void pagetable_set_dirty(pagetable_t *pt, uint32_t vpn) {
+    if (pt->page_table[vpn].present) {
+        pt->page_table[vpn].dirty = true;
     }
 }
 
-void pagetable_print_stats(void) {
-    printf("\n* Page Table Statistics *\n");
-    printf("total accesses: %llu\n", (unsigned long long)pt_accesses);
-    printf("page faults: %llu\n", (unsigned long long)page_faults);
-    printf("page faults with a dirty bit: %llu\n", (unsigned long long)page_faults_dirty);
+void pagetable_use_opt(pagetable_t *pt, bool enable) {
+    pt->opt_enabled = enable;
+}
+
+void pagetable_set_next_use(pagetable_t *pt, uint64_t next_use) {
+    pt->opt_next_use = next_use;
 }
 
-void pagetable_print_entries(void) {
-    printf("\nPage Table Entries (Present-Bit Dirty-Bit VPN PPN)\n");
+void pagetable_prefetch(const pagetable_t *pt, uint32_t vpn) {
+    if (vpn < PAGE_TABLE_ENTRIES) {
+        PREFETCH(&pt->page_table[vpn]);
+    }
+}
+
+void pagetable_save(const pagetable_t *pt, ckpt_writer_t *w) {
+    ckpt_geometry_t geo;
+    pagetable_geometry(&geo);
+    ckpt_write(w, &geo, sizeof(geo));
+    ckpt_write(w, pt->page_table, sizeof(pt->page_table));
+    
+    /* Frame ids in list order: used (MRU first), then free */
+    uint32_t frames[NUM_PHYSICAL_PAGES];
+    uint32_t used = 0;
+    uint32_t n = 0;
+    for (const page_t *page = pt->used_page_list; page; page = page->next) {
+        frames[n++] = page->frame_id;
+        used++;
+    }
+    for (const page_t *page = pt->free_page_list; page; page = page->next) {
+        frames[n++] = page->frame_id;
+    }
+    ckpt_write(w, &used, sizeof(used));
+    ckpt_write(w, frames, sizeof(frames));
+    
+    uint64_t stats[] = { pt->accesses, pt->page_faults, pt->page_faults_dirty };
+    ckpt_write(w, stats, sizeof(stats));
+}
+
+bool pagetable_restore(pagetable_t *pt, ckpt_reader_t *r) {
+    ckpt_geometry_t geo;
+    uint32_t frames[NUM_PHYSICAL_PAGES];
+    uint32_t used;
+    uint64_t stats[3];
+    
+    pagetable_geometry(&geo);
+    if (!ckpt_check_geometry(r, &geo) ||
+        !ckpt_read(r, pt->page_table, sizeof(pt->page_table)) ||
+        !ckpt_read(r, &used, sizeof(used)) ||
+        !ckpt_read(r, frames, sizeof(frames)) ||
+        !ckpt_read(r, stats, sizeof(stats)) ||
+        used > NUM_PHYSICAL_PAGES) {
+        return false;
+    }
+    
+    /* Every frame must appear exactly once */
+    bool seen[NUM_PHYSICAL_PAGES] = { false };
+    for (uint32_t i = 0; i < NUM_PHYSICAL_PAGES; i++) {
+        if (frames[i] >= NUM_PHYSICAL_PAGES || seen[frames[i]]) {
+            return false;
+        }
+        seen[frames[i]] = true;
+    }
+    
+    /* Rebuild both lists back to front, then relink pages to their PTEs */
+    pt->used_page_list = NULL;
+    pt->free_page_list = NULL;
+    for (uint32_t i = NUM_PHYSICAL_PAGES; i-- > 0; ) {
+        page_t *page = pt->frame_table[frames[i]];
+        page->pte = NULL;
+        ll_insert_head(i < used ? &pt->used_page_list : &pt->free_page_list, page);
+    }
+    for (uint32_t vpn = 0; vpn < PAGE_TABLE_ENTRIES; vpn++) {
+        if (pt->page_table[vpn].present) {
+            if (pt->page_table[vpn].ppn >= NUM_PHYSICAL_PAGES) {
+                return false;
+            }
+            pt->frame_table[pt->page_table[vpn].ppn]->pte = &pt->page_table[vpn];
+        }
+    }
+    
+    pt->accesses = stats[0];
+    pt->page_faults = stats[1];
+    pt->page_faults_dirty = stats[2];
+    return true;
+}
+
+void pagetable_reset_stats(pagetable_t *pt) {
+    pt->accesses = 0;
+    pt->page_faults = 0;
+    pt->page_faults_dirty = 0;
+}
+
+/**
+ * @brief Add the page table counters to a statistics group
+ */
+static void pagetable_fill_stats(const pagetable_t *pt, stats_group_t *group) {
+    stats_add_counter(group, "accesses", "total accesses", pt->accesses);
+    stats_add_counter(group, "page_faults", "page faults", pt->page_faults);
+    stats_add_counter(group, "page_faults_dirty", "page faults with a dirty bit",
+                      pt->page_faults_dirty);
+}
+
+void pagetable_register_stats(const pagetable_t *pt, stats_registry_t *reg) {
+    stats_group_t *group = stats_add_group(reg, "pagetable", "Page Table Statistics");
+    if (group) {
+        pagetable_fill_stats(pt, group);
+    }
+}
+
+void pagetable_print_stats(const pagetable_t *pt) {
+    stats_group_t group;
+    stats_group_init(&group, "pagetable", "Page Table Statistics");
+    pagetable_fill_stats(pt, &group);
+    stats_print_group(&group, stdout);
+}
+
+void pagetable_print_entries(const pagetable_t *pt) {
+    out_writer_t out;
+    out_init(&out, stdout);
+    
+    OUT_LIT(&out, "\nPage Table Entries (Present-Bit Dirty-Bit VPN PPN)\n");
     
     for (uint32_t i = 0; i < PAGE_TABLE_ENTRIES; i++) {
-        if (page_table[i].present) {
-            printf("%d %d 0x%05x 0x%05x\n",
-                   1,
-                   page_table[i].dirty ? 1 : 0,
-                   i,
-                   page_table[i].ppn);
+        if (pt->page_table[i].present) {
+            OUT_LIT(&out, "1 ");
+            out_char(&out, pt->page_table[i].dirty ? '1' : '0');
+            OUT_LIT(&out, " 0x");
+            out_hex(&out, i, 5);
+            OUT_LIT(&out, " 0x");
+            out_hex(&out, pt->page_table[i].ppn, 5);
+            out_char(&out, '\n');
         }
     }
+    
+    out_flush(&out);
 }
 
-void pagetable_destroy(void) {
+void pagetable_destroy(pagetable_t *pt) {
+    if (!pt) return;
+    
     /* Free all pages */
     for (uint32_t i = 0; i < NUM_PHYSICAL_PAGES; i++) {
-        if (frame_table[i]) {
-            free(frame_table[i]);
-            frame_table[i] = NULL;
+        if (pt->frame_table[i]) {
+            free(pt->frame_table[i]);
+            pt->frame_table[i] = NULL;
         }
     }
     
-    free_page_list = NULL;
-    used_page_list = NULL;
+    free(pt);
 }
-
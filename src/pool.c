@@ -0,0 +1,191 @@
+/**
+ * @file pool.c
+ * @brief Work-stealing thread pool for independent tasks
+ * @author Amir Noohi
+ * @copyright Copyright (c) 2025 Amir Noohi. All rights reserved.
+ *
+ * Each worker's remaining range [lo, hi) is packed into one 64-bit atomic
+ * word, so the owner popping from the front and thieves cutting off the
+ * back both update it with a single compare-and-swap. A thief publishes
+ * the stolen range as its own only once its previous range is empty;
+ * ranges always hold unclaimed tasks, so a stale compare-and-swap can
+ * never succeed on a recycled value.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "pool.h"
+#include "types.h"
+
+/* Keep each worker's range on its own hardware cache line */
+#define POOL_CACHELINE 64
+
+typedef struct {
+    alignas(POOL_CACHELINE) atomic_uint_fast64_t range;  /* lo << 32 | hi */
+} pool_slot_t;
+
+typedef struct {
+    pool_slot_t *slots;
+    uint32_t num_workers;
+    pool_task_fn fn;
+    void *arg;
+} pool_t;
+
+typedef struct {
+    pool_t *pool;
+    uint32_t id;
+} pool_worker_t;
+
+/* ============================================================================
+ * Helper Functions
+ * ============================================================================ */
+
+static uint64_t pack(uint32_t lo, uint32_t hi) {
+    return ((uint64_t)lo << 32) | hi;
+}
+
+static uint32_t range_lo(uint64_t range) {
+    return (uint32_t)(range >> 32);
+}
+
+static uint32_t range_hi(uint64_t range) {
+    return (uint32_t)range;
+}
+
+/**
+ * @brief Take the first task of a worker's own range
+ */
+static bool pop(pool_slot_t *slot, uint32_t *task) {
+    uint64_t range = atomic_load_explicit(&slot->range, memory_order_acquire);
+    while (range_lo(range) < range_hi(range)) {
+        uint64_t next = pack(range_lo(range) + 1, range_hi(range));
+        if (atomic_compare_exchange_weak_explicit(&slot->range, &range, next,
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            *task = range_lo(range);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Cut the back half off another worker's range
+ */
+static bool steal(pool_slot_t *victim, uint32_t *lo, uint32_t *hi) {
+    uint64_t range = atomic_load_explicit(&victim->range, memory_order_acquire);
+    while (range_lo(range) < range_hi(range)) {
+        uint32_t take = (range_hi(range) - range_lo(range) + 1) / 2;
+        uint64_t next = pack(range_lo(range), range_hi(range) - take);
+        if (atomic_compare_exchange_weak_explicit(&victim->range, &range, next,
+                                                  memory_order_acq_rel,
+                                                  memory_order_acquire)) {
+            *lo = range_hi(range) - take;
+            *hi = range_hi(range);
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Run own tasks, then steal until every range is empty
+ */
+static void* worker_main(void *arg) {
+    pool_worker_t *worker = arg;
+    pool_t *pool = worker->pool;
+    pool_slot_t *own = &pool->slots[worker->id];
+    uint32_t task;
+
+    for (;;) {
+        while (pop(own, &task)) {
+            pool->fn(pool->arg, task);
+        }
+
+        /* Own range is empty: steal from the next worker that has work */
+        bool stolen = false;
+        for (uint32_t k = 1; !stolen && k < pool->num_workers; k++) {
+            uint32_t lo, hi;
+            pool_slot_t *victim = &pool->slots[(worker->id + k) % pool->num_workers];
+            if (steal(victim, &lo, &hi)) {
+                /* Run the first stolen task; the rest become stealable */
+                atomic_store_explicit(&own->range, pack(lo + 1, hi), memory_order_release);
+                pool->fn(pool->arg, lo);
+                stolen = true;
+            }
+        }
+
+        /* No task is ever added, so one empty pass means we are done */
+        if (!stolen) {
+            return NULL;
+        }
+    }
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+void pool_run(uint32_t num_threads, size_t num_tasks, pool_task_fn fn, void *arg) {
+    if (num_tasks == 0) {
+        return;
+    }
+    if (num_threads == 0) {
+        num_threads = 1;
+    }
+    if (num_threads > num_tasks) {
+        num_threads = (uint32_t)num_tasks;
+    }
+
+    pool_t pool = { .num_workers = num_threads, .fn = fn, .arg = arg };
+    pool_worker_t *workers = calloc(num_threads, sizeof(pool_worker_t));
+    pthread_t *threads = calloc(num_threads, sizeof(pthread_t));
+    pool.slots = aligned_alloc(POOL_CACHELINE, num_threads * sizeof(pool_slot_t));
+
+    if (!workers || !threads || !pool.slots) {
+        /* Run everything on the calling thread */
+        for (size_t t = 0; t < num_tasks; t++) {
+            fn(arg, t);
+        }
+        free(workers);
+        free(threads);
+        free(pool.slots);
+        return;
+    }
+
+    /* Even split: worker i starts with tasks [i*n/w, (i+1)*n/w) */
+    for (uint32_t i = 0; i < num_threads; i++) {
+        uint32_t lo = (uint32_t)(num_tasks * i / num_threads);
+        uint32_t hi = (uint32_t)(num_tasks * (i + 1) / num_threads);
+        atomic_init(&pool.slots[i].range, pack(lo, hi));
+        workers[i].pool = &pool;
+        workers[i].id = i;
+    }
+
+    /* Workers whose thread fails to start are drained by the others */
+    uint32_t started = 1;
+    for (uint32_t i = 1; i < num_threads; i++) {
+        if (pthread_create(&threads[started], NULL, worker_main, &workers[i]) == 0) {
+            started++;
+        }
+    }
+
+    worker_main(&workers[0]);
+    for (uint32_t i = 1; i < started; i++) {
+        pthread_join(threads[i], NULL);
+    }
+
+    free(workers);
+    free(threads);
+    free(pool.slots);
+}
+
+uint32_t pool_cpu_count(void) {
+    long n = sysconf(_SC_NPROCESSORS_ONLN);
+    return n > 0 ? (uint32_t)n : 1;
+}
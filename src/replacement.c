@@ -0,0 +1,463 @@
+/**
+ * @file replacement.c
+ * @brief Pluggable replacement policies for caches and TLBs
+ * @author Amir Noohi
+ * @copyright Copyright (c) 2025 Amir Noohi. All rights reserved.
+ *
+ * Per-set state layouts (all start 4-byte aligned):
+ *
+ *   lru:    uint32_t head, tail | uint32_t prev[ways] | uint32_t next[ways]
+ *   plru:   bit array of the tree, node n at bit n (n = 1 .. leaves-1)
+ *   fifo:   uint32_t next victim
+ *   random: uint32_t rng
+ *   srrip:  uint8_t rrpv[ways]
+ *   brrip:  uint32_t rng | uint8_t rrpv[ways]
+ *   opt:    uint32_t size, pad | uint64_t next_use[ways] |
+ *           uint32_t heap[ways] | uint32_t pos[ways]   (8-byte aligned)
+ */
+
+#include <string.h>
+#include "replacement.h"
+#include "types.h"
+
+/* RRIP: 2-bit re-reference prediction values */
+#define RRPV_MAX 3                  /* Distant re-reference (evict first) */
+#define RRPV_LONG (RRPV_MAX - 1)    /* SRRIP insertion value */
+
+/* BRRIP inserts at RRPV_LONG once every this many fills (on average) */
+#define BRRIP_LONG_PERIOD 32
+
+/* ============================================================================
+ * Helper Functions
+ * ============================================================================ */
+
+/**
+ * @brief Advance a xorshift32 generator
+ */
+static inline uint32_t rng_next(uint32_t *state) {
+    uint32_t x = *state;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *state = x;
+    return x;
+}
+
+/**
+ * @brief Number of tree leaves for tree-PLRU (next power of 2)
+ */
+static uint32_t plru_leaves(uint32_t ways) {
+    uint32_t leaves = 1;
+    while (leaves < ways) {
+        leaves <<= 1;
+    }
+    return leaves;
+}
+
+/* ============================================================================
+ * True LRU
+ * ============================================================================ */
+
+static size_t lru_state_size(uint32_t ways) {
+    return (2 + 2 * (size_t)ways) * sizeof(uint32_t);
+}
+
+static void lru_init(void *state, uint32_t ways, uint32_t seed) {
+    uint32_t *s = state;
+    uint32_t *prev = s + 2;
+    uint32_t *next = prev + ways;
+    (void)seed;
+
+    /* Ways ordered 0 (MRU) .. ways-1 (LRU) */
+    s[0] = 0;
+    s[1] = ways - 1;
+    for (uint32_t i = 0; i < ways; i++) {
+        prev[i] = (i > 0) ? i - 1 : WAY_NONE;
+        next[i] = (i < ways - 1) ? i + 1 : WAY_NONE;
+    }
+}
+
+static void lru_touch(void *state, uint32_t ways, uint32_t way, uint64_t next_use) {
+    (void)next_use;
+    uint32_t *s = state;
+    uint32_t *prev = s + 2;
+    uint32_t *next = prev + ways;
+
+    if (way == s[0]) {
+        return;  /* Already MRU */
+    }
+
+    /* Unlink (not the head, so prev exists) */
+    next[prev[way]] = next[way];
+    if (next[way] != WAY_NONE) {
+        prev[next[way]] = prev[way];
+    } else {
+        s[1] = prev[way];
+    }
+
+    /* Relink at head */
+    prev[way] = WAY_NONE;
+    next[way] = s[0];
+    prev[s[0]] = way;
+    s[0] = way;
+}
+
+static uint32_t lru_victim(void *state, uint32_t ways) {
+    (void)ways;
+    return ((uint32_t *)state)[1];
+}
+
+/* ============================================================================
+ * Tree Pseudo-LRU
+ * ============================================================================ */
+
+static size_t plru_state_size(uint32_t ways) {
+    return (plru_leaves(ways) + 7) / 8;
+}
+
+static void plru_init(void *state, uint32_t ways, uint32_t seed) {
+    (void)seed;
+    memset(state, 0, plru_state_size(ways));
+}
+
+/**
+ * @brief Point every node on the way's path away from it
+ */
+static void plru_touch(void *state, uint32_t ways, uint32_t way, uint64_t next_use) {
+    (void)next_use;
+    uint8_t *bits = state;
+    uint32_t node = plru_leaves(ways) + way;
+
+    while (node > 1) {
+        uint32_t parent = node >> 1;
+        if (node & 1) {
+            bits[parent >> 3] &= (uint8_t)~(1u << (parent & 7));  /* Go left */
+        } else {
+            bits[parent >> 3] |= (uint8_t)(1u << (parent & 7));   /* Go right */
+        }
+        node = parent;
+    }
+}
+
+/**
+ * @brief Follow the tree bits to a leaf
+ *
+ * With a non-power-of-2 way count the tree has unused leaves on the
+ * right; a subtree that holds no real way is never entered.
+ */
+static uint32_t plru_victim(void *state, uint32_t ways) {
+    const uint8_t *bits = state;
+    uint32_t node = 1;
+    uint32_t lo = 0;
+    uint32_t size = plru_leaves(ways);
+
+    while (size > 1) {
+        uint32_t half = size >> 1;
+        uint32_t right = (bits[node >> 3] >> (node & 7)) & 1;
+        if (right && lo + half >= ways) {
+            right = 0;
+        }
+        if (right) {
+            lo += half;
+        }
+        node = 2 * node + right;
+        size = half;
+    }
+    return lo;
+}
+
+/* ============================================================================
+ * FIFO
+ * ============================================================================ */
+
+/* Shared by policies whose state is a single word */
+static size_t word_state_size(uint32_t ways) {
+    (void)ways;
+    return sizeof(uint32_t);
+}
+
+static void fifo_init(void *state, uint32_t ways, uint32_t seed) {
+    (void)ways;
+    (void)seed;
+    *(uint32_t *)state = 0;
+}
+
+/* Shared by policies that ignore an event */
+static void nop_update(void *state, uint32_t ways, uint32_t way, uint64_t next_use) {
+    (void)next_use;
+    (void)state;
+    (void)ways;
+    (void)way;
+}
+
+/**
+ * @brief Advance the pointer past the way just filled
+ *
+ * Ways are filled in order and then replaced at the pointer, so the
+ * pointer always names the oldest way.
+ */
+static void fifo_insert(void *state, uint32_t ways, uint32_t way, uint64_t next_use) {
+    (void)next_use;
+    uint32_t *next = state;
+    if (way == *next) {
+        *next = (way + 1 == ways) ? 0 : way + 1;
+    }
+}
+
+static uint32_t fifo_victim(void *state, uint32_t ways) {
+    (void)ways;
+    return *(uint32_t *)state;
+}
+
+/* ============================================================================
+ * Random
+ * ============================================================================ */
+
+static void random_init(void *state, uint32_t ways, uint32_t seed) {
+    (void)ways;
+    *(uint32_t *)state = seed;
+}
+
+static uint32_t random_victim(void *state, uint32_t ways) {
+    return rng_next(state) % ways;
+}
+
+/* ============================================================================
+ * SRRIP / BRRIP
+ * ============================================================================ */
+
+static size_t srrip_state_size(uint32_t ways) {
+    return ways;
+}
+
+static void srrip_init(void *state, uint32_t ways, uint32_t seed) {
+    (void)seed;
+    memset(state, RRPV_MAX, ways);
+}
+
+static void rrip_touch(void *state, uint32_t ways, uint32_t way, uint64_t next_use) {
+    (void)next_use;
+    (void)ways;
+    ((uint8_t *)state)[way] = 0;  /* Hit promotion: near re-reference */
+}
+
+static void srrip_insert(void *state, uint32_t ways, uint32_t way, uint64_t next_use) {
+    (void)next_use;
+    (void)ways;
+    ((uint8_t *)state)[way] = RRPV_LONG;
+}
+
+/**
+ * @brief First way with the largest RRPV, after ageing the set
+ *
+ * Equivalent to the hardware loop "increment all RRPVs until one reaches
+ * RRPV_MAX", done in two passes.
+ */
+static uint32_t rrip_select(uint8_t *rrpv, uint32_t ways) {
+    uint32_t victim = 0;
+    for (uint32_t i = 1; i < ways; i++) {
+        if (rrpv[i] > rrpv[victim]) {
+            victim = i;
+        }
+    }
+
+    uint8_t age = (uint8_t)(RRPV_MAX - rrpv[victim]);
+    if (age) {
+        for (uint32_t i = 0; i < ways; i++) {
+            rrpv[i] = (uint8_t)(rrpv[i] + age);
+        }
+    }
+    return victim;
+}
+
+static uint32_t srrip_victim(void *state, uint32_t ways) {
+    return rrip_select(state, ways);
+}
+
+static size_t brrip_state_size(uint32_t ways) {
+    return sizeof(uint32_t) + ways;
+}
+
+static void brrip_init(void *state, uint32_t ways, uint32_t seed) {
+    *(uint32_t *)state = seed;
+    memset((uint8_t *)state + sizeof(uint32_t), RRPV_MAX, ways);
+}
+
+static void brrip_touch(void *state, uint32_t ways, uint32_t way, uint64_t next_use) {
+    rrip_touch((uint8_t *)state + sizeof(uint32_t), ways, way, next_use);
+}
+
+static void brrip_insert(void *state, uint32_t ways, uint32_t way, uint64_t next_use) {
+    (void)next_use;
+    uint8_t *rrpv = (uint8_t *)state + sizeof(uint32_t);
+    (void)ways;
+    rrpv[way] = (rng_next(state) % BRRIP_LONG_PERIOD == 0) ? RRPV_LONG : RRPV_MAX;
+}
+
+static uint32_t brrip_victim(void *state, uint32_t ways) {
+    return rrip_select((uint8_t *)state + sizeof(uint32_t), ways);
+}
+
+/* ============================================================================
+ * Belady OPT
+ * ============================================================================ */
+
+/*
+ * Indexed max-heap of ways keyed by next-use time: the root is the way
+ * whose block is needed furthest in the future. Ways enter the heap as
+ * they are first filled, so the heap is complete once the set is full.
+ */
+
+static size_t opt_state_size(uint32_t ways) {
+    return 2 * sizeof(uint32_t) + (size_t)ways * (sizeof(uint64_t) + 2 * sizeof(uint32_t));
+}
+
+static inline uint64_t* opt_keys(void *state) {
+    return (uint64_t *)((uint32_t *)state + 2);
+}
+
+static inline uint32_t* opt_heap(void *state, uint32_t ways) {
+    return (uint32_t *)(opt_keys(state) + ways);
+}
+
+static inline uint32_t* opt_pos(void *state, uint32_t ways) {
+    return opt_heap(state, ways) + ways;
+}
+
+static void opt_swap(uint32_t *heap, uint32_t *pos, uint32_t a, uint32_t b) {
+    uint32_t way = heap[a];
+    heap[a] = heap[b];
+    heap[b] = way;
+    pos[heap[a]] = a;
+    pos[heap[b]] = b;
+}
+
+/**
+ * @brief Restore heap order around slot i after its key changed
+ */
+static void opt_fix(void *state, uint32_t ways, uint32_t i) {
+    uint32_t size = *(uint32_t *)state;
+    const uint64_t *key = opt_keys(state);
+    uint32_t *heap = opt_heap(state, ways);
+    uint32_t *pos = opt_pos(state, ways);
+
+    /* Sift up */
+    while (i > 0 && key[heap[(i - 1) / 2]] < key[heap[i]]) {
+        opt_swap(heap, pos, i, (i - 1) / 2);
+        i = (i - 1) / 2;
+    }
+
+    /* Sift down */
+    for (;;) {
+        uint32_t largest = i;
+        uint32_t l = 2 * i + 1;
+        uint32_t r = l + 1;
+        if (l < size && key[heap[l]] > key[heap[largest]]) {
+            largest = l;
+        }
+        if (r < size && key[heap[r]] > key[heap[largest]]) {
+            largest = r;
+        }
+        if (largest == i) {
+            break;
+        }
+        opt_swap(heap, pos, i, largest);
+        i = largest;
+    }
+}
+
+static void opt_init(void *state, uint32_t ways, uint32_t seed) {
+    uint32_t *pos = opt_pos(state, ways);
+    (void)seed;
+
+    ((uint32_t *)state)[0] = 0;
+    ((uint32_t *)state)[1] = 0;
+    for (uint32_t i = 0; i < ways; i++) {
+        pos[i] = WAY_NONE;
+    }
+}
+
+static void opt_touch(void *state, uint32_t ways, uint32_t way, uint64_t next_use) {
+    opt_keys(state)[way] = next_use;
+    opt_fix(state, ways, opt_pos(state, ways)[way]);
+}
+
+static void opt_insert(void *state, uint32_t ways, uint32_t way, uint64_t next_use) {
+    uint32_t *pos = opt_pos(state, ways);
+
+    if (pos[way] == WAY_NONE) {
+        /* First fill of this way: append to the heap */
+        uint32_t *size = state;
+        opt_heap(state, ways)[*size] = way;
+        pos[way] = (*size)++;
+    }
+    opt_touch(state, ways, way, next_use);
+}
+
+static uint32_t opt_victim(void *state, uint32_t ways) {
+    return opt_heap(state, ways)[0];
+}
+
+/* ============================================================================
+ * Policy Table
+ * ============================================================================ */
+
+static const repl_ops_t repl_ops[] = {
+    [REPL_LRU]    = { "lru",    lru_state_size,   lru_init,    lru_touch,
+                      lru_touch,    lru_victim },
+    [REPL_PLRU]   = { "plru",   plru_state_size,  plru_init,   plru_touch,
+                      plru_touch,   plru_victim },
+    [REPL_FIFO]   = { "fifo",   word_state_size,  fifo_init,   nop_update,
+                      fifo_insert,  fifo_victim },
+    [REPL_RANDOM] = { "random", word_state_size,  random_init, nop_update,
+                      nop_update,   random_victim },
+    [REPL_SRRIP]  = { "srrip",  srrip_state_size, srrip_init,  rrip_touch,
+                      srrip_insert, srrip_victim },
+    [REPL_BRRIP]  = { "brrip",  brrip_state_size, brrip_init,  brrip_touch,
+                      brrip_insert, brrip_victim },
+    [REPL_OPT]    = { "opt",    opt_state_size,   opt_init,    opt_touch,
+                      opt_insert,   opt_victim },
+};
+
+#define NUM_REPL_POLICIES (sizeof(repl_ops) / sizeof(repl_ops[0]))
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+const repl_ops_t* repl_get_ops(repl_policy_t policy) {
+    if ((size_t)policy >= NUM_REPL_POLICIES) {
+        return NULL;
+    }
+    return &repl_ops[policy];
+}
+
+bool repl_parse(const char *name, repl_policy_t *policy) {
+    /* OPT needs next-use times, so it is only reachable through --opt */
+    for (size_t i = 0; i < NUM_REPL_POLICIES; i++) {
+        if (i == REPL_OPT) {
+            continue;
+        }
+        if (strcmp(name, repl_ops[i].name) == 0) {
+            *policy = (repl_policy_t)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+const char* repl_name(repl_policy_t policy) {
+    const repl_ops_t *ops = repl_get_ops(policy);
+    return ops ? ops->name : "unknown";
+}
+
+uint32_t repl_set_seed(uint32_t seed, uint32_t set_index) {
+    /* Mix (seed, set) through a murmur3-style finalizer */
+    uint32_t x = seed ^ (set_index * 0x9E3779B1u);
+    x ^= x >> 16;
+    x *= 0x85EBCA6Bu;
+    x ^= x >> 13;
+    x *= 0xC2B2AE35u;
+    x ^= x >> 16;
+    return x ? x : 1;  /* xorshift must not start at 0 */
+}
@@ -0,0 +1,149 @@
+/**
+ * @file ring.c
+ * @brief Bounded lock-free single-producer/single-consumer ring
+ * @author Amir Noohi
+ * @copyright Copyright (c) 2025 Amir Noohi. All rights reserved.
+ *
+ * head counts committed slots, tail counts released slots; both only grow
+ * and are masked into the slot array. Each index is written by one side
+ * only, so release/acquire ordering on the two counters is all the
+ * synchronization needed.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <stdalign.h>
+#include <stdatomic.h>
+#include <sched.h>
+#include <time.h>
+#include "ring.h"
+#include "types.h"
+
+/* Keep producer and consumer counters on separate hardware cache lines */
+#define RING_CACHELINE 64
+
+/* Backoff schedule while the ring is full/empty */
+#define RING_SPIN_ROUNDS 64
+#define RING_YIELD_ROUNDS 256
+#define RING_SLEEP_NS 20000
+
+struct ring_s {
+    alignas(RING_CACHELINE) atomic_size_t head;   /* Written by producer */
+    alignas(RING_CACHELINE) atomic_size_t tail;   /* Written by consumer */
+    alignas(RING_CACHELINE) atomic_bool closed;
+
+    size_t mask;
+    size_t slot_size;
+    unsigned char *slots;
+};
+
+/* ============================================================================
+ * Helper Functions
+ * ============================================================================ */
+
+/**
+ * @brief Wait a little longer each round
+ */
+static void backoff(unsigned *round) {
+    if (*round < RING_SPIN_ROUNDS) {
+        /* Busy spin: the other side is usually mid-batch */
+    } else if (*round < RING_SPIN_ROUNDS + RING_YIELD_ROUNDS) {
+        sched_yield();
+    } else {
+        struct timespec ts = { 0, RING_SLEEP_NS };
+        nanosleep(&ts, NULL);
+    }
+    (*round)++;
+}
+
+static unsigned char* slot_at(const ring_t *ring, size_t index) {
+    return ring->slots + (index & ring->mask) * ring->slot_size;
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+ring_t* ring_create(size_t num_slots, size_t slot_size) {
+    size_t slots = 1;
+    while (slots < num_slots) {
+        slots <<= 1;
+    }
+
+    ring_t *ring = aligned_alloc(RING_CACHELINE,
+                                 (sizeof(ring_t) + RING_CACHELINE - 1) /
+                                 RING_CACHELINE * RING_CACHELINE);
+    if (!ring) {
+        return NULL;
+    }
+
+    ring->slots = malloc(slots * slot_size);
+    if (!ring->slots) {
+        free(ring);
+        return NULL;
+    }
+
+    atomic_init(&ring->head, 0);
+    atomic_init(&ring->tail, 0);
+    atomic_init(&ring->closed, false);
+    ring->mask = slots - 1;
+    ring->slot_size = slot_size;
+
+    return ring;
+}
+
+void* ring_write_acquire(ring_t *ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    unsigned round = 0;
+
+    for (;;) {
+        if (atomic_load_explicit(&ring->closed, memory_order_acquire)) {
+            return NULL;  /* Nobody will consume what we produce */
+        }
+        if (head - atomic_load_explicit(&ring->tail, memory_order_acquire) <=
+            ring->mask) {
+            return slot_at(ring, head);
+        }
+        backoff(&round);
+    }
+}
+
+void ring_write_commit(ring_t *ring) {
+    size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+    atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+}
+
+void* ring_read_acquire(ring_t *ring) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    unsigned round = 0;
+
+    while (atomic_load_explicit(&ring->head, memory_order_acquire) == tail) {
+        if (atomic_load_explicit(&ring->closed, memory_order_acquire)) {
+            /* Re-check: the producer may have committed just before closing */
+            if (atomic_load_explicit(&ring->head, memory_order_acquire) == tail) {
+                return NULL;
+            }
+            break;
+        }
+        backoff(&round);
+    }
+
+    return slot_at(ring, tail);
+}
+
+void ring_read_release(ring_t *ring) {
+    size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+    atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+}
+
+void ring_close(ring_t *ring) {
+    atomic_store_explicit(&ring->closed, true, memory_order_release);
+}
+
+void ring_destroy(ring_t *ring) {
+    if (!ring) return;
+
+    free(ring->slots);
+    free(ring);
+}
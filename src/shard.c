@@ -0,0 +1,160 @@
+/**
+ * @file shard.c
+ * @brief Set-sharded parallel simulation of one cache (--threads)
+ * @author Amir Noohi
+ * @copyright Copyright (c) 2025 Amir Noohi. All rights reserved.
+ *
+ * The producer fills one batch slot per shard in place and commits it
+ * when full; shard threads run each batch through cache_access_batch()
+ * on their view, so set prefetching works as in a sequential run.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "shard.h"
+#include "cache.h"
+#include "ring.h"
+#include "types.h"
+
+/* Accesses per ring slot */
+#define SHARD_BATCH 512
+
+/* Ring slots per shard */
+#define SHARD_RING_SLOTS 64
+
+typedef struct {
+    uint32_t n;
+    uint32_t addrs[SHARD_BATCH];
+    bool is_write[SHARD_BATCH];
+} shard_batch_t;
+
+typedef struct {
+    cache_t *view;                 /* Statistics of this shard's sets */
+    ring_t *ring;
+    shard_batch_t *fill;           /* Slot being filled (producer), or NULL */
+    pthread_t thread;
+    bool started;
+} shard_t;
+
+struct shard_run_s {
+    cache_t *cache;
+    uint32_t num_shards;
+    shard_t *shards;
+};
+
+/* ============================================================================
+ * Helper Functions
+ * ============================================================================ */
+
+/**
+ * @brief Shard thread: simulate batches until the ring is closed
+ */
+static void* shard_main(void *arg) {
+    shard_t *shard = arg;
+    cache_result_t results[SHARD_BATCH];
+    shard_batch_t *batch;
+
+    while ((batch = ring_read_acquire(shard->ring)) != NULL) {
+        cache_access_batch(shard->view, batch->addrs, batch->is_write,
+                           batch->n, results);
+        ring_read_release(shard->ring);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Publish a shard's partly filled slot
+ */
+static void shard_flush(shard_t *shard) {
+    if (shard->fill) {
+        ring_write_commit(shard->ring);
+        shard->fill = NULL;
+    }
+}
+
+/**
+ * @brief Stop every started thread and free all shards
+ */
+static void shard_stop(shard_run_t *run) {
+    for (uint32_t i = 0; i < run->num_shards; i++) {
+        shard_t *shard = &run->shards[i];
+        if (shard->ring) {
+            shard_flush(shard);
+            ring_close(shard->ring);
+        }
+    }
+    for (uint32_t i = 0; i < run->num_shards; i++) {
+        shard_t *shard = &run->shards[i];
+        if (shard->started) {
+            pthread_join(shard->thread, NULL);
+        }
+        cache_view_merge(run->cache, shard->view);
+        ring_destroy(shard->ring);
+    }
+    free(run->shards);
+    free(run);
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+shard_run_t* shard_start(cache_t *cache, uint32_t num_shards) {
+    if (num_shards == 0 || num_shards > cache->num_sets) {
+        return NULL;
+    }
+
+    shard_run_t *run = calloc(1, sizeof(shard_run_t));
+    if (!run) {
+        return NULL;
+    }
+    run->cache = cache;
+    run->num_shards = num_shards;
+    run->shards = calloc(num_shards, sizeof(shard_t));
+    if (!run->shards) {
+        free(run);
+        return NULL;
+    }
+
+    bool ok = true;
+    for (uint32_t i = 0; ok && i < num_shards; i++) {
+        shard_t *shard = &run->shards[i];
+        shard->view = cache_view_create(cache);
+        shard->ring = ring_create(SHARD_RING_SLOTS, sizeof(shard_batch_t));
+        ok = shard->view && shard->ring &&
+             pthread_create(&shard->thread, NULL, shard_main, shard) == 0;
+        shard->started = ok;
+    }
+
+    if (!ok) {
+        /* Nothing was routed yet, so the merged statistics stay zero */
+        shard_stop(run);
+        return NULL;
+    }
+    return run;
+}
+
+void shard_access_batch(shard_run_t *run, const uint32_t *addrs,
+                        const bool *is_write, size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        shard_t *shard = &run->shards[cache_get_index(run->cache, addrs[i]) %
+                                      run->num_shards];
+
+        if (!shard->fill) {
+            shard->fill = ring_write_acquire(shard->ring);
+            shard->fill->n = 0;
+        }
+        shard->fill->addrs[shard->fill->n] = addrs[i];
+        shard->fill->is_write[shard->fill->n] = is_write[i];
+        if (++shard->fill->n == SHARD_BATCH) {
+            shard_flush(shard);
+        }
+    }
+}
+
+void shard_finish(shard_run_t *run) {
+    if (!run) return;
+    shard_stop(run);
+}
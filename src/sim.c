@@ -0,0 +1,1360 @@
+/**
+ * @file sim.c
+ * @brief Reentrant simulator context
+ * @author Amir Noohi
+ * @copyright Copyright (c) 2025 Amir Noohi. All rights reserved.
+ * 
+ * Orchestrates VM translation (TLB + Page Table) and cache access for
+ * Tasks 1-4. All simulation state lives in a sim_ctx_t.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "sim.h"
+#include "types.h"
+#include "cache.h"
+#include "multilevel_cache.h"
+#include "tlb.h"
+#include "pagetable.h"
+#include "trace.h"
+#include "output.h"
+#include "next_use.h"
+#include "replacement.h"
+#include "ring.h"
+#include "mrc.h"
+#include "shard.h"
+#include "checkpoint.h"
+#include "stats.h"
+#include "classify.h"
+#include "timing.h"
+
+/* Trace records simulated per batch */
+#define SIM_BATCH 256
+
+/* Batches in flight between two pipeline stages (--pipeline) */
+#define PIPE_RING_SLOTS 16
+
+/* Counters per cache level in an interval row */
+#define INTERVAL_CACHE_COUNTERS 7
+
+/* OPT replay keys: VPNs and physical block numbers both fit in 20 bits
+ * (32-bit virtual addresses, 1MB of physical memory) */
+#define OPT_KEY_BITS 20
+
+/**
+ * @brief One batch of accesses after translation
+ */
+typedef struct {
+    size_t n;
+    trace_record_t recs[SIM_BATCH];
+    uint32_t vaddrs[SIM_BATCH];
+    uint32_t paddrs[SIM_BATCH];
+    bool is_write[SIM_BATCH];
+    tlb_result_t tlb_res[SIM_BATCH];
+    pt_result_t pt_res[SIM_BATCH];
+} sim_batch_t;
+
+/**
+ * @brief Counters of every structure (cumulative, or one --interval row)
+ */
+typedef struct {
+    uint64_t end;                  /* Records simulated */
+    uint64_t tlb[3];               /* Accesses, hits, misses */
+    uint64_t pt[3];                /* Accesses, page faults, dirty faults */
+    uint64_t cache[MAX_CACHE_LEVELS][INTERVAL_CACHE_COUNTERS];
+} sim_counters_t;
+
+/**
+ * @brief Simulator context
+ */
+struct sim_ctx_s {
+    const sim_config_t *config;    /* Borrowed from the caller */
+    tlb_t *tlb;
+    pagetable_t *pagetable;
+    cache_t *single_cache;         /* Tasks 1-3 */
+    multilevel_cache_t *multi_cache; /* Task 4 */
+    mrc_t *mrc;                    /* Stack-distance profiler (--mrc) */
+    cache_t **sweep_caches;        /* Extra caches (-C, --sweep) */
+    uint32_t num_sweep;
+    uint32_t num_shards;           /* Threads of the single-level cache */
+    shard_run_t *shards;           /* Running shard threads (during a run) */
+    uint64_t records;              /* Trace records simulated */
+    bool resume;                   /* Next run continues a checkpoint */
+    ckpt_position_t resume_at;     /* Its trace position */
+    
+    /* Per-interval statistics (--interval) */
+    sim_counters_t *intervals;     /* Rows (differences) */
+    size_t num_intervals;
+    size_t cap_intervals;
+    sim_counters_t interval_base;  /* Cumulative counters at the last row */
+    
+    timing_t timing;               /* Accesses per outcome (--timing) */
+    
+    /* Verbose per-access lines are assembled here and written in blocks */
+    out_writer_t verbose_out;
+};
+
+/* ============================================================================
+ * Address Translation
+ * ============================================================================ */
+
+/**
+ * @brief Extract VPN from virtual address
+ */
+static inline uint32_t get_vpn(uint32_t vaddr) {
+    return vaddr >> 12;  /* Bits 31-12 */
+}
+
+/**
+ * @brief Extract offset from virtual address
+ */
+static inline uint32_t get_offset(uint32_t vaddr) {
+    return vaddr & 0xFFF;  /* Bits 11-0 */
+}
+
+/**
+ * @brief Construct physical address from PPN and offset
+ */
+static inline uint32_t make_paddr(uint32_t ppn, uint32_t offset) {
+    return (ppn << 12) | offset;
+}
+
+/**
+ * @brief Translate virtual address to physical address
+ * 
+ * Flow:
+ * 1. Extract VPN from virtual address
+ * 2. Check TLB for VPN -> PPN translation
+ * 3. If TLB miss, check page table
+ * 4. If page fault, handle fault (allocate page)
+ * 5. Update TLB with translation
+ * 6. Construct physical address
+ * 7. On write, set dirty bits
+ * 
+ * @param vaddr Virtual address
+ * @param is_write Whether this is a write access
+ * @param[out] tlb_result TLB lookup result
+ * @param[out] pt_result Page table lookup result
+ * @return Physical address
+ */
+static uint32_t translate_address(sim_ctx_t *ctx, uint32_t vaddr, bool is_write,
+                                  tlb_result_t *tlb_result,
+                                  pt_result_t *pt_result) {
+    uint32_t vpn = get_vpn(vaddr);
+    uint32_t offset = get_offset(vaddr);
+    uint32_t ppn;
+    bool dirty;
+    
+    /* Try TLB first */
+    *tlb_result = tlb_lookup(ctx->tlb, vpn, &ppn, &dirty);
+    
+    if (*tlb_result == TLB_HIT) {
+        /* TLB hit - we have the translation */
+        *pt_result = PT_HIT;  /* Not actually accessed, but indicate success */
+        
+        /* Update page table LRU (even on TLB hit) */
+        uint32_t dummy_ppn;
+        bool dummy_dirty;
+        pagetable_lookup(ctx->pagetable, vpn, &dummy_ppn, &dummy_dirty);
+    } else {
+        /* TLB miss - consult page table */
+        *pt_result = pagetable_lookup(ctx->pagetable, vpn, &ppn, &dirty);
+        
+        if (*pt_result == PT_MISS) {
+            /* Page fault - allocate page */
+            ppn = pagetable_handle_fault(ctx->pagetable, vpn);
+        }
+        
+        /* Update TLB with translation */
+        tlb_insert(ctx->tlb, vpn, ppn);
+    }
+    
+    /* Set dirty bits on write */
+    if (is_write) {
+        tlb_set_dirty(ctx->tlb, vpn);
+        pagetable_set_dirty(ctx->pagetable, vpn);
+    }
+    
+    return make_paddr(ppn, offset);
+}
+
+/**
+ * @brief Translate a batch of virtual addresses
+ * 
+ * Same result as calling translate_address() on each address in order.
+ * The TLB set and page table entry of the access PREFETCH_DISTANCE ahead
+ * are prefetched so their misses overlap the current translation.
+ */
+static void translate_batch(sim_ctx_t *ctx, const uint32_t *vaddrs,
+                            const bool *is_write, size_t n, uint32_t *paddrs,
+                            tlb_result_t *tlb_results,
+                            pt_result_t *pt_results) {
+    for (size_t i = 0; i < n && i < PREFETCH_DISTANCE; i++) {
+        tlb_prefetch(ctx->tlb, get_vpn(vaddrs[i]));
+        pagetable_prefetch(ctx->pagetable, get_vpn(vaddrs[i]));
+    }
+    
+    for (size_t i = 0; i < n; i++) {
+        if (i + PREFETCH_DISTANCE < n) {
+            uint32_t vpn = get_vpn(vaddrs[i + PREFETCH_DISTANCE]);
+            tlb_prefetch(ctx->tlb, vpn);
+            pagetable_prefetch(ctx->pagetable, vpn);
+        }
+        paddrs[i] = translate_address(ctx, vaddrs[i], is_write[i],
+                                      &tlb_results[i], &pt_results[i]);
+    }
+}
+
+/* ============================================================================
+ * Verbose Output
+ * ============================================================================ */
+
+/**
+ * @brief Print access result in verbose mode
+ * 
+ * Appends the line to the context's verbose writer; the caller flushes
+ * it before any printf() output.
+ */
+static void print_verbose(sim_ctx_t *ctx, char mode, uint32_t vaddr,
+                          uint32_t paddr, tlb_result_t tlb_res,
+                          pt_result_t pt_res, cache_result_t cache_res) {
+    out_writer_t *out = &ctx->verbose_out;
+    
+    out_char(out, mode);
+    OUT_LIT(out, " 0x");
+    out_hex(out, vaddr, 8);
+    OUT_LIT(out, " 0x");
+    out_hex(out, paddr, 8);
+    out_char(out, ' ');
+    
+    /* TLB status */
+    if (tlb_res == TLB_HIT) {
+        OUT_LIT(out, "TLB-HIT ");
+    } else {
+        OUT_LIT(out, "TLB-MISS ");
+    }
+    
+    /* Page table status */
+    if (tlb_res == TLB_HIT) {
+        OUT_LIT(out, "- ");  /* PT not consulted */
+    } else if (pt_res == PT_HIT) {
+        OUT_LIT(out, "PAGE-HIT ");
+    } else {
+        OUT_LIT(out, "PAGE-FAULT ");
+    }
+    
+    /* Cache status */
+    if (ctx->config->task == 4) {
+        /* Multi-level cache */
+        switch (cache_res) {
+            case CACHE_HIT_L1:
+                OUT_LIT(out, "L1-HIT L2-HIT");
+                break;
+            case CACHE_HIT_L2:
+                OUT_LIT(out, "L1-MISS L2-HIT");
+                break;
+            case CACHE_MISS_ALL_LEVELS:
+                OUT_LIT(out, "L1-MISS L2-MISS");
+                break;
+            default:
+                OUT_LIT(out, "CACHE-ERROR");
+                break;
+        }
+    } else {
+        /* Single-level cache */
+        if (cache_res == CACHE_HIT) {
+            OUT_LIT(out, "CACHE-HIT");
+        } else {
+            OUT_LIT(out, "CACHE-MISS");
+        }
+    }
+    
+    out_char(out, '\n');
+}
+
+/* ============================================================================
+ * Trace Simulation
+ * ============================================================================ */
+
+/**
+ * @brief Translate up to SIM_BATCH accesses (first half of a batch)
+ */
+static void translate_stage(sim_ctx_t *ctx, const trace_record_t *recs, size_t n,
+                            sim_batch_t *batch) {
+    batch->n = n;
+    ctx->records += n;
+    
+    /* Decode the accesses */
+    for (size_t i = 0; i < n; i++) {
+        batch->recs[i] = recs[i];
+        batch->vaddrs[i] = recs[i].vaddr;
+        batch->is_write[i] = (recs[i].mode == 'W' || recs[i].mode == 'w');
+    }
+    
+    /* Translate virtual to physical addresses */
+    translate_batch(ctx, batch->vaddrs, batch->is_write, n, batch->paddrs,
+                    batch->tlb_res, batch->pt_res);
+}
+
+/**
+ * @brief Simulate the caches of a translated batch (second half)
+ * 
+ * @return false if the miss-ratio profiler ran out of memory
+ */
+static bool cache_stage(sim_ctx_t *ctx, const sim_batch_t *batch) {
+    cache_result_t cache_res[SIM_BATCH];
+    cache_result_t sweep_res[SIM_BATCH];
+    size_t n = batch->n;
+    
+    /* Profile the physical block stream */
+    if (ctx->mrc) {
+        for (size_t i = 0; i < n; i++) {
+            if (!mrc_access(ctx->mrc, batch->paddrs[i])) {
+                return false;
+            }
+        }
+    }
+    
+    /* Access cache */
+    if (ctx->shards) {
+        /* Statistics only: -v is not allowed with --threads */
+        shard_access_batch(ctx->shards, batch->paddrs, batch->is_write, n);
+    } else if (ctx->config->task == 4) {
+        multilevel_cache_access_batch(ctx->multi_cache, batch->paddrs,
+                                      batch->is_write, n, cache_res);
+    } else {
+        cache_access_batch(ctx->single_cache, batch->paddrs, batch->is_write, n,
+                           cache_res);
+    }
+    
+    /* Cycle accounting needs every cache result (no shards with --timing) */
+    if (ctx->config->timing) {
+        timing_record_batch(&ctx->timing, batch->tlb_res, batch->pt_res, cache_res, n);
+    }
+    
+    /* Same physical stream through every sweep cache */
+    for (uint32_t k = 0; k < ctx->num_sweep; k++) {
+        cache_access_batch(ctx->sweep_caches[k], batch->paddrs, batch->is_write, n,
+                           sweep_res);
+    }
+    
+    /* Verbose output */
+    if (ctx->config->verbose) {
+        for (size_t i = 0; i < n; i++) {
+            print_verbose(ctx, batch->recs[i].mode, batch->vaddrs[i], batch->paddrs[i],
+                          batch->tlb_res[i], batch->pt_res[i], cache_res[i]);
+        }
+    }
+    
+    return true;
+}
+
+/**
+ * @brief Simulate up to SIM_BATCH accesses with the configured policies
+ * 
+ * @return false if the miss-ratio profiler ran out of memory
+ */
+static bool simulate_batch(sim_ctx_t *ctx, const trace_record_t *recs, size_t n) {
+    sim_batch_t batch;
+    translate_stage(ctx, recs, n, &batch);
+    return cache_stage(ctx, &batch);
+}
+
+/**
+ * @brief Records to read into the next batch of a run limited to limit
+ */
+static inline size_t batch_size(uint64_t limit) {
+    return limit < SIM_BATCH ? (size_t)limit : SIM_BATCH;
+}
+
+/**
+ * @brief Simulate the next limit accesses of a trace (or all of them)
+ * 
+ * @param limit Maximum number of records to simulate (UINT64_MAX: all)
+ * @return false if the miss-ratio profiler ran out of memory
+ */
+static bool simulate_trace(sim_ctx_t *ctx, trace_reader_t *trace, uint64_t limit) {
+    trace_record_t recs[SIM_BATCH];
+    size_t want, n;
+    
+    do {
+        want = batch_size(limit);
+        n = 0;
+        while (n < want && trace_next(trace, &recs[n])) {
+            n++;
+        }
+        if (!simulate_batch(ctx, recs, n)) {
+            return false;
+        }
+        limit -= n;
+    } while (n == want && limit > 0);
+    
+    return true;
+}
+
+/* ============================================================================
+ * Pipelined Simulation (--pipeline)
+ * ============================================================================ */
+
+/**
+ * @brief Decoded records passed from the parse stage to translation
+ */
+typedef struct {
+    size_t n;
+    trace_record_t recs[SIM_BATCH];
+} parse_batch_t;
+
+/**
+ * @brief Stages and rings of a pipelined run
+ */
+typedef struct {
+    sim_ctx_t *ctx;
+    trace_reader_t *trace;
+    ring_t *parsed;                /* Parse stage -> translation */
+    ring_t *translated;            /* Translation -> cache stage */
+    uint64_t limit;                /* Records left to parse */
+    bool cache_ok;                 /* Cache stage result */
+} pipeline_t;
+
+/**
+ * @brief Parse stage: decode the trace into batches
+ */
+static void* parse_main(void *arg) {
+    pipeline_t *pipe = arg;
+    parse_batch_t *batch;
+    
+    while ((batch = ring_write_acquire(pipe->parsed)) != NULL) {
+        size_t want = batch_size(pipe->limit);
+        batch->n = 0;
+        while (batch->n < want && trace_next(pipe->trace, &batch->recs[batch->n])) {
+            batch->n++;
+        }
+        ring_write_commit(pipe->parsed);
+        pipe->limit -= batch->n;
+        if (batch->n < want || pipe->limit == 0) {
+            break;
+        }
+    }
+    
+    ring_close(pipe->parsed);
+    return NULL;
+}
+
+/**
+ * @brief Cache stage: simulate the caches and print, in batch order
+ */
+static void* cache_main(void *arg) {
+    pipeline_t *pipe = arg;
+    sim_batch_t *batch;
+    
+    while ((batch = ring_read_acquire(pipe->translated)) != NULL) {
+        pipe->cache_ok = cache_stage(pipe->ctx, batch);
+        ring_read_release(pipe->translated);
+        if (!pipe->cache_ok) {
+            ring_close(pipe->translated);  /* Stop the translation stage */
+            break;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Simulate a trace with parsing, translation and the caches on
+ * three threads
+ * 
+ * Each ring has one producer and one consumer and keeps batches in order,
+ * so every structure sees the same access sequence as in simulate_trace()
+ * and verbose lines come out in trace order. Falls back to the sequential
+ * loop if the threads cannot be started.
+ * 
+ * @param limit Maximum number of records to simulate (UINT64_MAX: all)
+ * @return false if the miss-ratio profiler ran out of memory
+ */
+static bool simulate_pipelined(sim_ctx_t *ctx, trace_reader_t *trace, uint64_t limit) {
+    pipeline_t pipe = { .ctx = ctx, .trace = trace, .limit = limit, .cache_ok = true };
+    pthread_t parser, cacher;
+    
+    pipe.parsed = ring_create(PIPE_RING_SLOTS, sizeof(parse_batch_t));
+    pipe.translated = ring_create(PIPE_RING_SLOTS, sizeof(sim_batch_t));
+    if (!pipe.parsed || !pipe.translated ||
+        pthread_create(&cacher, NULL, cache_main, &pipe) != 0) {
+        ring_destroy(pipe.parsed);
+        ring_destroy(pipe.translated);
+        return simulate_trace(ctx, trace, limit);
+    }
+    if (pthread_create(&parser, NULL, parse_main, &pipe) != 0) {
+        /* Nothing has been read yet: stop the cache stage and go sequential */
+        ring_close(pipe.translated);
+        pthread_join(cacher, NULL);
+        ring_destroy(pipe.parsed);
+        ring_destroy(pipe.translated);
+        return simulate_trace(ctx, trace, limit);
+    }
+    
+    /* Translation stage on the calling thread */
+    parse_batch_t *in;
+    while ((in = ring_read_acquire(pipe.parsed)) != NULL) {
+        sim_batch_t *out = ring_write_acquire(pipe.translated);
+        if (!out) {
+            ring_close(pipe.parsed);       /* Cache stage failed: stop parsing */
+            break;
+        }
+        translate_stage(ctx, in->recs, in->n, out);
+        ring_write_commit(pipe.translated);
+        ring_read_release(pipe.parsed);
+    }
+    ring_close(pipe.translated);
+    
+    pthread_join(parser, NULL);
+    pthread_join(cacher, NULL);
+    ring_destroy(pipe.parsed);
+    ring_destroy(pipe.translated);
+    return pipe.cache_ok;
+}
+
+/* ============================================================================
+ * Belady OPT Replay (--opt)
+ * ============================================================================ */
+
+/**
+ * @brief Translation outcome of one access (kept for verbose output)
+ */
+typedef struct {
+    trace_record_t rec;
+    uint32_t paddr;
+    uint8_t tlb_res;
+    uint8_t pt_res;
+} opt_xlate_t;
+
+/**
+ * @brief One access reaching a cache level
+ */
+typedef struct {
+    uint32_t paddr;
+    bool is_write;
+} opt_access_t;
+
+/**
+ * @brief Temporary streams of an OPT replay
+ */
+typedef struct {
+    uint32_t num_levels;
+    FILE *spool;                               /* trace_record_t per access */
+    FILE *xlate;                               /* opt_xlate_t (verbose only) */
+    FILE *level_in[MAX_CACHE_LEVELS];          /* opt_access_t per level access */
+    FILE *level_res[MAX_CACHE_LEVELS];         /* uint8_t result (verbose only) */
+    next_use_t *vpn_use;                       /* Next use of each VPN */
+    next_use_t *block_use[MAX_CACHE_LEVELS];   /* Next use of each level's blocks */
+} opt_replay_t;
+
+static void opt_cleanup(opt_replay_t *opt) {
+    if (opt->spool) fclose(opt->spool);
+    if (opt->xlate) fclose(opt->xlate);
+    next_use_destroy(opt->vpn_use);
+    for (uint32_t i = 0; i < MAX_CACHE_LEVELS; i++) {
+        if (opt->level_in[i]) fclose(opt->level_in[i]);
+        if (opt->level_res[i]) fclose(opt->level_res[i]);
+        next_use_destroy(opt->block_use[i]);
+    }
+}
+
+static cache_t* opt_level_cache(sim_ctx_t *ctx, uint32_t level) {
+    return ctx->multi_cache ? ctx->multi_cache->levels[level] : ctx->single_cache;
+}
+
+/**
+ * @brief Access one cache level, returning whether it hit
+ */
+static bool opt_access_level(sim_ctx_t *ctx, uint32_t level,
+                             const opt_access_t *a, uint8_t *res) {
+    cache_result_t r;
+    bool hit;
+    
+    if (ctx->multi_cache) {
+        r = multilevel_cache_access_level(ctx->multi_cache, level, a->paddr, a->is_write);
+        hit = (r != CACHE_MISS_ALL_LEVELS);
+    } else {
+        r = cache_access(ctx->single_cache, a->paddr, a->is_write);
+        hit = (r == CACHE_HIT);
+    }
+    
+    *res = (uint8_t)r;
+    return hit;
+}
+
+/**
+ * @brief Replay a trace with Belady's optimal replacement everywhere
+ * 
+ * Each structure only sees the accesses that reach it, so the replay runs
+ * one stage at a time, streaming through temporary files:
+ * 1. Spool the trace and record its VPN sequence
+ * 2. Translate with OPT TLB and page frames (keyed by VPN next use);
+ *    record the physical accesses and the L1 block sequence
+ * 3. Replay each cache level with OPT; its misses and their block sequence
+ *    are the input of the next level (levels do not interact)
+ * 4. Verbose only: merge the recorded per-access results in trace order
+ * 
+ * @return true on success, false on I/O error
+ */
+static bool simulate_opt(sim_ctx_t *ctx, trace_reader_t *trace) {
+    opt_replay_t opt = { 0 };
+    trace_record_t rec;
+    opt_access_t access;
+    uint64_t next;
+    bool ok = true;
+    
+    opt.num_levels = ctx->multi_cache ? ctx->multi_cache->num_levels : 1;
+    opt.spool = tmpfile();
+    opt.vpn_use = next_use_create(OPT_KEY_BITS);
+    ok = opt.spool && opt.vpn_use;
+    for (uint32_t i = 0; ok && i < opt.num_levels; i++) {
+        opt.level_in[i] = tmpfile();
+        opt.block_use[i] = next_use_create(OPT_KEY_BITS);
+        ok = opt.level_in[i] && opt.block_use[i];
+        if (ok && ctx->config->verbose) {
+            opt.level_res[i] = tmpfile();
+            ok = opt.level_res[i] != NULL;
+        }
+    }
+    if (ok && ctx->config->verbose) {
+        opt.xlate = tmpfile();
+        ok = opt.xlate != NULL;
+    }
+    
+    /* Stage 1: spool the trace (it may be a pipe) and its VPN sequence */
+    while (ok && trace_next(trace, &rec)) {
+        ok = fwrite(&rec, sizeof(rec), 1, opt.spool) == 1 &&
+             next_use_append(opt.vpn_use, get_vpn(rec.vaddr));
+    }
+    ok = ok && next_use_finish(opt.vpn_use) && fseeko(opt.spool, 0, SEEK_SET) == 0;
+    
+    /* Stage 2: translation */
+    cache_t *l1 = opt_level_cache(ctx, 0);
+    while (ok && fread(&rec, sizeof(rec), 1, opt.spool) == 1) {
+        opt_xlate_t x = { .rec = rec };
+        tlb_result_t tlb_res;
+        pt_result_t pt_res;
+        
+        ok = next_use_read(opt.vpn_use, &next);
+        tlb_set_next_use(ctx->tlb, next);
+        pagetable_set_next_use(ctx->pagetable, next);
+        
+        access.is_write = (rec.mode == 'W' || rec.mode == 'w');
+        access.paddr = translate_address(ctx, rec.vaddr, access.is_write, &tlb_res, &pt_res);
+        
+        ok = ok && fwrite(&access, sizeof(access), 1, opt.level_in[0]) == 1 &&
+             next_use_append(opt.block_use[0], access.paddr >> l1->offset_bits);
+        
+        if (ok && opt.xlate) {
+            x.paddr = access.paddr;
+            x.tlb_res = (uint8_t)tlb_res;
+            x.pt_res = (uint8_t)pt_res;
+            ok = fwrite(&x, sizeof(x), 1, opt.xlate) == 1;
+        }
+    }
+    
+    /* Stage 3: cache levels, each fed by the misses of the one above */
+    for (uint32_t level = 0; ok && level < opt.num_levels; level++) {
+        cache_t *cache = opt_level_cache(ctx, level);
+        cache_t *below = (level + 1 < opt.num_levels) ? opt_level_cache(ctx, level + 1) : NULL;
+        
+        ok = next_use_finish(opt.block_use[level]) &&
+             fseeko(opt.level_in[level], 0, SEEK_SET) == 0;
+        
+        while (ok && fread(&access, sizeof(access), 1, opt.level_in[level]) == 1) {
+            uint8_t res;
+            
+            ok = next_use_read(opt.block_use[level], &next);
+            cache_set_next_use(cache, next);
+            
+            if (!opt_access_level(ctx, level, &access, &res) && below) {
+                ok = ok && fwrite(&access, sizeof(access), 1, opt.level_in[level + 1]) == 1 &&
+                     next_use_append(opt.block_use[level + 1],
+                                     access.paddr >> below->offset_bits);
+            }
+            if (ok && opt.level_res[level]) {
+                ok = fwrite(&res, 1, 1, opt.level_res[level]) == 1;
+            }
+        }
+    }
+    
+    /* Stage 4: verbose lines in trace order */
+    if (ok && ctx->config->verbose) {
+        opt_xlate_t x;
+        
+        ok = fseeko(opt.xlate, 0, SEEK_SET) == 0;
+        for (uint32_t i = 0; ok && i < opt.num_levels; i++) {
+            ok = fseeko(opt.level_res[i], 0, SEEK_SET) == 0;
+        }
+        
+        while (ok && fread(&x, sizeof(x), 1, opt.xlate) == 1) {
+            uint8_t res = CACHE_MISS_ALL_LEVELS;
+            
+            /* An access reaches a level only if it missed every level above */
+            for (uint32_t level = 0; ok && level < opt.num_levels; level++) {
+                ok = fread(&res, 1, 1, opt.level_res[level]) == 1;
+                if (!ctx->multi_cache || res != CACHE_MISS_ALL_LEVELS) {
+                    break;
+                }
+            }
+            
+            print_verbose(ctx, x.rec.mode, x.rec.vaddr, x.paddr, (tlb_result_t)x.tlb_res,
+                          (pt_result_t)x.pt_res, (cache_result_t)res);
+        }
+    }
+    
+    if (!ok) {
+        fprintf(stderr, "OPT replay failed: temporary file error\n");
+    }
+    
+    opt_cleanup(&opt);
+    return ok;
+}
+
+/* ============================================================================
+ * Warmup and Interval Statistics
+ * ============================================================================ */
+
+/**
+ * @brief Read the cumulative counters of every structure
+ */
+static void read_counters(const sim_ctx_t *ctx, sim_counters_t *c) {
+    uint32_t levels = ctx->multi_cache ? ctx->multi_cache->num_levels : 1;
+    
+    memset(c, 0, sizeof(*c));
+    c->end = ctx->records;
+    c->tlb[0] = ctx->tlb->accesses;
+    c->tlb[1] = ctx->tlb->hits;
+    c->tlb[2] = ctx->tlb->misses;
+    c->pt[0] = ctx->pagetable->accesses;
+    c->pt[1] = ctx->pagetable->page_faults;
+    c->pt[2] = ctx->pagetable->page_faults_dirty;
+    
+    for (uint32_t i = 0; i < levels; i++) {
+        const cache_t *cache = ctx->multi_cache ? ctx->multi_cache->levels[i]
+                                                : ctx->single_cache;
+        uint64_t *out = c->cache[i];
+        out[0] = cache->accesses;
+        out[1] = cache->hits;
+        out[2] = cache->misses;
+        out[3] = cache->reads;
+        out[4] = cache->read_hits;
+        out[5] = cache->writes;
+        out[6] = cache->write_hits;
+    }
+}
+
+/**
+ * @brief Zero every statistic, keeping all contents (end of --warmup)
+ */
+static void reset_stats(sim_ctx_t *ctx) {
+    tlb_reset_stats(ctx->tlb);
+    pagetable_reset_stats(ctx->pagetable);
+    if (ctx->multi_cache) {
+        multilevel_cache_reset_stats(ctx->multi_cache);
+    } else {
+        cache_reset_stats(ctx->single_cache);
+    }
+    for (uint32_t k = 0; k < ctx->num_sweep; k++) {
+        cache_reset_stats(ctx->sweep_caches[k]);
+    }
+    if (ctx->mrc) {
+        mrc_reset_stats(ctx->mrc);
+    }
+    timing_reset(&ctx->timing);
+    read_counters(ctx, &ctx->interval_base);
+}
+
+/**
+ * @brief Append the counter differences since the previous row
+ * 
+ * @return false on allocation failure
+ */
+static bool record_interval(sim_ctx_t *ctx) {
+    if (ctx->num_intervals == ctx->cap_intervals) {
+        size_t cap = ctx->cap_intervals ? 2 * ctx->cap_intervals : 64;
+        sim_counters_t *grown = realloc(ctx->intervals, cap * sizeof(sim_counters_t));
+        if (!grown) {
+            fprintf(stderr, "Failed to record interval statistics\n");
+            return false;
+        }
+        ctx->intervals = grown;
+        ctx->cap_intervals = cap;
+    }
+    
+    sim_counters_t now;
+    read_counters(ctx, &now);
+    
+    const sim_counters_t *base = &ctx->interval_base;
+    sim_counters_t *row = &ctx->intervals[ctx->num_intervals++];
+    row->end = now.end;
+    for (uint32_t i = 0; i < 3; i++) {
+        row->tlb[i] = now.tlb[i] - base->tlb[i];
+        row->pt[i] = now.pt[i] - base->pt[i];
+    }
+    for (uint32_t i = 0; i < MAX_CACHE_LEVELS; i++) {
+        for (uint32_t j = 0; j < INTERVAL_CACHE_COUNTERS; j++) {
+            row->cache[i][j] = now.cache[i][j] - base->cache[i][j];
+        }
+    }
+    
+    ctx->interval_base = now;
+    return true;
+}
+
+/**
+ * @brief Print the --interval rows
+ * 
+ * Format:
+ *   * Interval Statistics *
+ *   end tlb-accesses tlb-hits tlb-misses pt-accesses page-faults
+ *   page-faults-dirty <c>-accesses <c>-hits <c>-misses <c>-reads
+ *   <c>-read-hits <c>-writes <c>-write-hits     (one line; <c> is "cache",
+ *                                                 or L1, L2 with -S1/-S2)
+ *   E X X X ...                                 (one row per interval)
+ */
+static void print_intervals(const sim_ctx_t *ctx) {
+    static const char *const names[INTERVAL_CACHE_COUNTERS] = {
+        "accesses", "hits", "misses", "reads", "read-hits", "writes", "write-hits"
+    };
+    uint32_t levels = ctx->multi_cache ? ctx->multi_cache->num_levels : 1;
+    
+    printf("\n* Interval Statistics *\n");
+    printf("end tlb-accesses tlb-hits tlb-misses pt-accesses page-faults page-faults-dirty");
+    for (uint32_t i = 0; i < levels; i++) {
+        for (uint32_t j = 0; j < INTERVAL_CACHE_COUNTERS; j++) {
+            if (ctx->multi_cache) {
+                printf(" L%u-%s", i + 1, names[j]);
+            } else {
+                printf(" cache-%s", names[j]);
+            }
+        }
+    }
+    printf("\n");
+    
+    for (size_t r = 0; r < ctx->num_intervals; r++) {
+        const sim_counters_t *row = &ctx->intervals[r];
+        printf("%llu %llu %llu %llu %llu %llu %llu",
+               (unsigned long long)row->end,
+               (unsigned long long)row->tlb[0], (unsigned long long)row->tlb[1],
+               (unsigned long long)row->tlb[2], (unsigned long long)row->pt[0],
+               (unsigned long long)row->pt[1], (unsigned long long)row->pt[2]);
+        for (uint32_t i = 0; i < levels; i++) {
+            for (uint32_t j = 0; j < INTERVAL_CACHE_COUNTERS; j++) {
+                printf(" %llu", (unsigned long long)row->cache[i][j]);
+            }
+        }
+        printf("\n");
+    }
+}
+
+/* ============================================================================
+ * Miss Classification (--classify, --heatmap)
+ * ============================================================================ */
+
+/**
+ * @brief Attach a classifier to the cache or every level
+ */
+static bool enable_classify(sim_ctx_t *ctx) {
+    if (!ctx->multi_cache) {
+        return cache_enable_classify(ctx->single_cache);
+    }
+    for (uint32_t i = 0; i < ctx->multi_cache->num_levels; i++) {
+        if (!cache_enable_classify(ctx->multi_cache->levels[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Write the per-set counters of every classified cache as CSV
+ */
+static bool write_heatmap(const sim_ctx_t *ctx, const char *path) {
+    FILE *out = fopen(path, "w");
+    if (!out) {
+        fprintf(stderr, "Failed to write heatmap %s\n", path);
+        return false;
+    }
+    
+    fprintf(out, "cache,set,accesses,misses,compulsory,capacity,conflict,evictions\n");
+    if (ctx->multi_cache) {
+        for (uint32_t i = 0; i < ctx->multi_cache->num_levels; i++) {
+            char name[16];
+            snprintf(name, sizeof(name), "l%u", i + 1);
+            classify_write_heatmap(ctx->multi_cache->levels[i]->classify, name, out);
+        }
+    } else {
+        classify_write_heatmap(ctx->single_cache->classify, "cache", out);
+    }
+    
+    if (fclose(out) != 0) {
+        fprintf(stderr, "Failed to write heatmap %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+sim_ctx_t* sim_create(const sim_config_t *config) {
+    sim_ctx_t *ctx = calloc(1, sizeof(sim_ctx_t));
+    if (!ctx) {
+        return NULL;
+    }
+    ctx->config = config;
+    out_init(&ctx->verbose_out, stdout);
+    
+    /* Initialize TLB */
+    ctx->tlb = tlb_init(config->tlb);
+    if (!ctx->tlb) {
+        fprintf(stderr, "Failed to initialize TLB\n");
+        sim_destroy(ctx);
+        return NULL;
+    }
+    
+    /* Initialize page table */
+    ctx->pagetable = pagetable_init();
+    if (!ctx->pagetable) {
+        fprintf(stderr, "Failed to initialize page table\n");
+        sim_destroy(ctx);
+        return NULL;
+    }
+    pagetable_use_opt(ctx->pagetable, config->opt);
+    
+    /* Initialize cache based on task */
+    if (config->task == 4) {
+        /* Multi-level cache (Task 4) */
+        ctx->multi_cache = multilevel_cache_init(config->levels, config->num_levels);
+        if (!ctx->multi_cache) {
+            fprintf(stderr, "Failed to initialize multi-level cache\n");
+            sim_destroy(ctx);
+            return NULL;
+        }
+    } else {
+        /* Single-level cache (Tasks 1-3) */
+        ctx->single_cache = cache_init(config->cache);
+        if (!ctx->single_cache) {
+            fprintf(stderr, "Failed to initialize cache\n");
+            sim_destroy(ctx);
+            return NULL;
+        }
+    }
+    
+    if (config->writebacks && !multilevel_cache_propagate_writebacks(ctx->multi_cache)) {
+        fprintf(stderr, "Failed to initialize multi-level cache\n");
+        sim_destroy(ctx);
+        return NULL;
+    }
+    
+    if (config->classify && !enable_classify(ctx)) {
+        fprintf(stderr, "Failed to initialize miss classification\n");
+        sim_destroy(ctx);
+        return NULL;
+    }
+    
+    /* Sets of the single-level cache shared among threads (--threads) */
+    if (config->task != 4 && config->threads > 1) {
+        ctx->num_shards = config->threads < ctx->single_cache->num_sets ?
+                          config->threads : ctx->single_cache->num_sets;
+    }
+    
+    /* Sweep caches, fed the same physical stream */
+    if (config->num_sweep > 0) {
+        ctx->sweep_caches = calloc(config->num_sweep, sizeof(cache_t *));
+        if (!ctx->sweep_caches) {
+            fprintf(stderr, "Failed to initialize cache\n");
+            sim_destroy(ctx);
+            return NULL;
+        }
+        for (; ctx->num_sweep < config->num_sweep; ctx->num_sweep++) {
+            cache_t *cache = cache_init(config->sweep[ctx->num_sweep]);
+            if (!cache) {
+                fprintf(stderr, "Failed to initialize cache\n");
+                sim_destroy(ctx);
+                return NULL;
+            }
+            ctx->sweep_caches[ctx->num_sweep] = cache;
+        }
+    }
+    
+    /* Stack-distance profiler, in blocks of the (L1) cache */
+    if (config->mrc) {
+        uint32_t block_size = (config->task == 4) ? config->levels[0].block_size
+                                                  : config->cache.block_size;
+        ctx->mrc = mrc_create(block_size, config->mrc_sets, config->hash_index);
+        if (ctx->mrc && !mrc_set_sampling(ctx->mrc, config->shards_rate,
+                                          config->shards_budget)) {
+            mrc_destroy(ctx->mrc);
+            ctx->mrc = NULL;
+        }
+        if (!ctx->mrc) {
+            fprintf(stderr, "Failed to initialize miss-ratio profiler\n");
+            sim_destroy(ctx);
+            return NULL;
+        }
+    }
+    
+    return ctx;
+}
+
+/**
+ * @brief Start the shard threads of the single-level cache (--threads)
+ */
+static bool start_shards(sim_ctx_t *ctx) {
+    if (ctx->num_shards > 1) {
+        ctx->shards = shard_start(ctx->single_cache, ctx->num_shards);
+        if (!ctx->shards) {
+            fprintf(stderr, "Failed to start cache threads\n");
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Drain the shard threads and merge their statistics
+ */
+static void finish_shards(sim_ctx_t *ctx) {
+    shard_finish(ctx->shards);
+    ctx->shards = NULL;
+}
+
+/**
+ * @brief Simulate the next limit records of a trace (UINT64_MAX: all)
+ */
+static bool simulate_segment(sim_ctx_t *ctx, trace_reader_t *trace, uint64_t limit) {
+    if (ctx->config->pipeline) {
+        return simulate_pipelined(ctx, trace, limit);
+    }
+    return simulate_trace(ctx, trace, limit);
+}
+
+/**
+ * @brief Simulate a trace, stopping at the record counts where the
+ * statistics are read: end of --warmup, each --interval boundary and
+ * --checkpoint-at
+ * 
+ * Batches are cut short at those points instead of testing every access.
+ * Shard threads are drained at each point, so their statistics are
+ * merged, and restarted after it.
+ */
+static bool simulate_phases(sim_ctx_t *ctx, trace_reader_t *trace) {
+    const sim_config_t *config = ctx->config;
+    bool warmup = ctx->records < config->warmup;
+    bool checkpoint = config->checkpoint_file && ctx->records <= config->checkpoint_at;
+    uint64_t interval_end = UINT64_MAX;
+    bool ok = true;
+    
+    /* Intervals are counted from the end of the warmup */
+    if (config->interval > 0 && !warmup) {
+        interval_end = config->warmup +
+                       ((ctx->records - config->warmup) / config->interval + 1) *
+                       config->interval;
+    }
+    read_counters(ctx, &ctx->interval_base);
+    
+    for (;;) {
+        uint64_t stop = interval_end;
+        if (warmup && config->warmup < stop) {
+            stop = config->warmup;
+        }
+        if (checkpoint && config->checkpoint_at < stop) {
+            stop = config->checkpoint_at;
+        }
+        
+        uint64_t start = ctx->records;
+        ok = simulate_segment(ctx, trace, stop - start);
+        bool done = !ok || ctx->records < stop;    /* Trace ended */
+        finish_shards(ctx);
+        
+        if (ok && warmup && ctx->records == config->warmup) {
+            reset_stats(ctx);
+            warmup = false;
+            if (config->interval > 0) {
+                interval_end = config->warmup + config->interval;
+            }
+        }
+        if (ok && config->interval > 0 && !warmup &&
+            (ctx->records == interval_end ||
+             (done && ctx->records > ctx->interval_base.end))) {
+            ok = record_interval(ctx);
+            interval_end += config->interval;
+        }
+        if (ok && checkpoint && (ctx->records == config->checkpoint_at || done)) {
+            ok = sim_checkpoint(ctx, trace, config->checkpoint_file);
+            checkpoint = false;
+        }
+        
+        if (!ok || done) {
+            return ok;
+        }
+        if (!start_shards(ctx)) {
+            return false;
+        }
+    }
+}
+
+/**
+ * @brief Move past the records a restored checkpoint already simulated
+ * 
+ * Seeks when the trace allows it (see trace_seek()), so resuming a long
+ * run on a mapped file does not re-read the records.
+ * 
+ * @return false if the trace is not the one the checkpoint was taken on,
+ *         or ends before the checkpoint
+ */
+static bool resume_trace(sim_ctx_t *ctx, trace_reader_t *trace) {
+    const ckpt_position_t *at = &ctx->resume_at;
+    ctx->resume = false;
+    
+    trace_identity_t id;
+    trace_get_identity(trace, &id);
+    if (memcmp(&id, &at->trace, sizeof(id)) != 0) {
+        fprintf(stderr, "Checkpoint was taken on a different trace\n");
+        return false;
+    }
+    
+    if (!trace_seek(trace, at->records, at->offset)) {
+        fprintf(stderr, "Trace ends before checkpoint (%llu records)\n",
+                (unsigned long long)at->records);
+        return false;
+    }
+    return true;
+}
+
+bool sim_run(sim_ctx_t *ctx, trace_reader_t *trace) {
+    const sim_config_t *config = ctx->config;
+    
+    if (config->restore_file && !sim_restore(ctx, config->restore_file)) {
+        return false;
+    }
+    
+    /* Records up to a restored checkpoint were already simulated */
+    if (ctx->resume && !resume_trace(ctx, trace)) {
+        return false;
+    }
+    
+    if (!start_shards(ctx)) {
+        return false;
+    }
+    bool ok;
+    if (config->opt) {
+        ok = simulate_opt(ctx, trace);
+    } else {
+        ok = simulate_phases(ctx, trace);
+    }
+    finish_shards(ctx);
+    out_flush(&ctx->verbose_out);
+    
+    /* A truncated or corrupt trace must not look like a complete run */
+    if (ok && trace_failed(trace)) {
+        ok = false;
+    }
+    if (ok && config->heatmap_file) {
+        ok = write_heatmap(ctx, config->heatmap_file);
+    }
+    return ok;
+}
+
+bool sim_run_records(sim_ctx_t *ctx, const trace_record_t *recs, size_t n) {
+    bool ok = start_shards(ctx);
+    for (size_t i = 0; ok && i < n; i += SIM_BATCH) {
+        ok = simulate_batch(ctx, recs + i, n - i < SIM_BATCH ? n - i : SIM_BATCH);
+    }
+    finish_shards(ctx);
+    out_flush(&ctx->verbose_out);
+    return ok;
+}
+
+bool sim_checkpoint(const sim_ctx_t *ctx, const trace_reader_t *trace, const char *path) {
+    ckpt_position_t pos = { .records = ctx->records, .offset = TRACE_OFFSET_UNKNOWN };
+    if (trace) {
+        pos.offset = trace_tell(trace);
+        trace_get_identity(trace, &pos.trace);
+    }
+    
+    ckpt_writer_t *w = ckpt_create(path, &pos);
+    if (!w) {
+        fprintf(stderr, "Failed to write checkpoint %s\n", path);
+        return false;
+    }
+    
+    tlb_save(ctx->tlb, w);
+    pagetable_save(ctx->pagetable, w);
+    if (ctx->multi_cache) {
+        multilevel_cache_save(ctx->multi_cache, w);
+    } else {
+        cache_save(ctx->single_cache, w);
+    }
+    ckpt_write(w, &ctx->num_sweep, sizeof(ctx->num_sweep));
+    for (uint32_t k = 0; k < ctx->num_sweep; k++) {
+        cache_save(ctx->sweep_caches[k], w);
+    }
+    
+    if (!ckpt_close(w)) {
+        fprintf(stderr, "Failed to write checkpoint %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+bool sim_restore(sim_ctx_t *ctx, const char *path) {
+    ckpt_position_t pos;
+    ckpt_reader_t *r = ckpt_open(path, &pos);
+    if (!r) {
+        fprintf(stderr, "Invalid checkpoint %s\n", path);
+        return false;
+    }
+    
+    uint32_t num_sweep;
+    bool ok = tlb_restore(ctx->tlb, r) && pagetable_restore(ctx->pagetable, r);
+    if (ok && ctx->multi_cache) {
+        ok = multilevel_cache_restore(ctx->multi_cache, r);
+    } else if (ok) {
+        ok = cache_restore(ctx->single_cache, r);
+    }
+    ok = ok && ckpt_read(r, &num_sweep, sizeof(num_sweep)) && num_sweep == ctx->num_sweep;
+    for (uint32_t k = 0; ok && k < ctx->num_sweep; k++) {
+        ok = cache_restore(ctx->sweep_caches[k], r);
+    }
+    
+    /* Leftover bytes mean the checkpoint came from another configuration */
+    ok = ckpt_release(r) && ok;
+    if (!ok) {
+        fprintf(stderr, "Checkpoint %s does not match the configuration\n", path);
+        return false;
+    }
+    
+    ctx->records = pos.records;
+    ctx->resume = true;
+    ctx->resume_at = pos;
+    return true;
+}
+
+void sim_get_stats(const sim_ctx_t *ctx, sim_stats_t *stats) {
+    const cache_t *cache = ctx->multi_cache ? ctx->multi_cache->levels[0]
+                                            : ctx->single_cache;
+    
+    stats->tlb_accesses = ctx->tlb->accesses;
+    stats->tlb_hits = ctx->tlb->hits;
+    stats->tlb_misses = ctx->tlb->misses;
+    stats->page_faults = ctx->pagetable->page_faults;
+    stats->page_faults_dirty = ctx->pagetable->page_faults_dirty;
+    stats->cache_sets = cache->num_sets;
+    stats->cache_ways = cache->ways_per_set;
+    stats->cache_accesses = cache->accesses;
+    stats->cache_hits = cache->hits;
+    stats->cache_misses = cache->misses;
+}
+
+void sim_register_stats(const sim_ctx_t *ctx, stats_registry_t *reg) {
+    const latency_config_t *lat = &ctx->config->latency;
+    const uint32_t level_latency[MAX_CACHE_LEVELS] = { lat->l1, lat->l2 };
+    
+    /* Every measured record looks up the TLB once */
+    reg->records = ctx->tlb->accesses;
+    reg->memory_latency = lat->memory;
+    
+    tlb_register_stats(ctx->tlb, reg);
+    pagetable_register_stats(ctx->pagetable, reg);
+    
+    if (ctx->multi_cache) {
+        multilevel_cache_register_stats(ctx->multi_cache, reg);
+        for (uint32_t i = 0; i < ctx->multi_cache->num_levels; i++) {
+            char key[16];
+            snprintf(key, sizeof(key), "l%u", i + 1);
+            stats_group_t *group = stats_find_group(reg, key);
+            if (group) {
+                group->latency = level_latency[i];
+            }
+        }
+    } else {
+        stats_group_t *group = cache_register_stats(ctx->single_cache, reg, "cache", NULL);
+        if (group) {
+            group->latency = level_latency[0];
+        }
+    }
+    
+    /* Sweep caches: machine-readable sinks only (text prints a table) */
+    for (uint32_t k = 0; k < ctx->num_sweep; k++) {
+        const cache_t *cache = ctx->sweep_caches[k];
+        char key[16];
+        snprintf(key, sizeof(key), "sweep%u", k);
+        stats_group_t *group = stats_add_group(reg, key, "");
+        if (group) {
+            stats_add_counter(group, "size", "", cache->size);
+            stats_add_counter(group, "block_size", "", cache->block_size);
+            stats_add_counter(group, "sets", "", cache->num_sets);
+            stats_add_counter(group, "ways", "", cache->ways_per_set);
+            cache_fill_stats(cache, group);
+        }
+    }
+    
+    if (ctx->config->timing) {
+        uint32_t levels = ctx->multi_cache ? ctx->multi_cache->num_levels : 1;
+        timing_register_stats(&ctx->timing, lat, levels, reg);
+    }
+    
+    stats_derive(reg);
+}
+
+void sim_print_report(const sim_ctx_t *ctx) {
+    stats_registry_t reg;
+    stats_init(&reg);
+    sim_register_stats(ctx, &reg);
+    if (reg.failed) {
+        fprintf(stderr, "Failed to collect statistics\n");
+    }
+    
+    /* Print statistics */
+    stats_emit(&reg, stats_get_sink(ctx->config->stats_format), stdout);
+    stats_free(&reg);
+    if (ctx->config->stats_format != STATS_TEXT) {
+        return;
+    }
+    
+    if (ctx->config->timing) {
+        uint32_t levels = ctx->multi_cache ? ctx->multi_cache->num_levels : 1;
+        timing_print(&ctx->timing, &ctx->config->latency, levels, stdout);
+    }
+    
+    /* Verbose mode: print entries */
+    if (ctx->config->verbose) {
+        tlb_print_entries(ctx->tlb);
+        pagetable_print_entries(ctx->pagetable);
+    }
+    
+    if (ctx->mrc) {
+        mrc_print(ctx->mrc);
+    }
+    if (ctx->num_sweep > 0) {
+        cache_print_sweep(ctx->sweep_caches, ctx->num_sweep);
+    }
+    if (ctx->config->interval > 0) {
+        print_intervals(ctx);
+    }
+}
+
+void sim_destroy(sim_ctx_t *ctx) {
+    if (!ctx) return;
+    
+    for (uint32_t k = 0; k < ctx->num_sweep; k++) {
+        cache_destroy(ctx->sweep_caches[k]);
+    }
+    free(ctx->sweep_caches);
+    free(ctx->intervals);
+    if (ctx->mrc) mrc_destroy(ctx->mrc);
+    if (ctx->multi_cache) multilevel_cache_destroy(ctx->multi_cache);
+    if (ctx->single_cache) cache_destroy(ctx->single_cache);
+    if (ctx->tlb) tlb_destroy(ctx->tlb);
+    pagetable_destroy(ctx->pagetable);
+    free(ctx);
+}
@@ -0,0 +1,242 @@
+/**
+ * @file stats.c
+ * @brief Statistics registry with pluggable output sinks
+ * @author Amir Noohi
+ * @copyright Copyright (c) 2025 Amir Noohi. All rights reserved.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "stats.h"
+#include "types.h"
+
+/* Initial number of groups of a registry */
+#define STATS_INITIAL_GROUPS 8
+
+/* ============================================================================
+ * Helper Functions
+ * ============================================================================ */
+
+/**
+ * @brief Look up a counter of a group
+ */
+static const stats_counter_t* find_counter(const stats_group_t *group, const char *key) {
+    for (uint32_t i = 0; i < group->num_counters; i++) {
+        if (strcmp(group->counters[i].key, key) == 0) {
+            return &group->counters[i];
+        }
+    }
+    return NULL;
+}
+
+static void add_metric(stats_group_t *group, const char *key, double value) {
+    if (group->num_metrics < STATS_MAX_METRICS) {
+        group->metrics[group->num_metrics].key = key;
+        group->metrics[group->num_metrics].value = value;
+        group->num_metrics++;
+    }
+}
+
+static double ratio(uint64_t num, uint64_t den) {
+    return den ? (double)num / (double)den : 0.0;
+}
+
+/**
+ * @brief Miss rate of a group (0 if it has no access or miss counter)
+ */
+static double group_miss_rate(const stats_group_t *group) {
+    const stats_counter_t *accesses = find_counter(group, "accesses");
+    const stats_counter_t *misses = find_counter(group, "misses");
+    if (!misses) {
+        misses = find_counter(group, "page_faults");
+    }
+    return (accesses && misses) ? ratio(misses->value, accesses->value) : 0.0;
+}
+
+/* ============================================================================
+ * Sinks
+ * ============================================================================ */
+
+static void text_begin(FILE *out, const stats_registry_t *reg) {
+    (void)out;
+    (void)reg;
+}
+
+static void text_group(FILE *out, const stats_group_t *group) {
+    stats_print_group(group, out);
+}
+
+static void text_end(FILE *out, const stats_registry_t *reg) {
+    (void)out;
+    (void)reg;
+}
+
+static void json_begin(FILE *out, const stats_registry_t *reg) {
+    fprintf(out, "{\n  \"records\": %llu", (unsigned long long)reg->records);
+}
+
+static void json_group(FILE *out, const stats_group_t *group) {
+    fprintf(out, ",\n  \"%s\": {", group->key);
+    for (uint32_t i = 0; i < group->num_counters; i++) {
+        fprintf(out, "%s\"%s\": %llu", i ? ", " : "", group->counters[i].key,
+                (unsigned long long)group->counters[i].value);
+    }
+    for (uint32_t i = 0; i < group->num_metrics; i++) {
+        fprintf(out, "%s\"%s\": %.6f", (i || group->num_counters) ? ", " : "",
+                group->metrics[i].key, group->metrics[i].value);
+    }
+    fprintf(out, "}");
+}
+
+static void json_end(FILE *out, const stats_registry_t *reg) {
+    (void)reg;
+    fprintf(out, "\n}\n");
+}
+
+static void csv_begin(FILE *out, const stats_registry_t *reg) {
+    fprintf(out, "group,name,value\n");
+    fprintf(out, "run,records,%llu\n", (unsigned long long)reg->records);
+}
+
+static void csv_group(FILE *out, const stats_group_t *group) {
+    for (uint32_t i = 0; i < group->num_counters; i++) {
+        fprintf(out, "%s,%s,%llu\n", group->key, group->counters[i].key,
+                (unsigned long long)group->counters[i].value);
+    }
+    for (uint32_t i = 0; i < group->num_metrics; i++) {
+        fprintf(out, "%s,%s,%.6f\n", group->key, group->metrics[i].key,
+                group->metrics[i].value);
+    }
+}
+
+static void csv_end(FILE *out, const stats_registry_t *reg) {
+    (void)out;
+    (void)reg;
+}
+
+static const stats_sink_t text_sink = { text_begin, text_group, text_end };
+static const stats_sink_t json_sink = { json_begin, json_group, json_end };
+static const stats_sink_t csv_sink = { csv_begin, csv_group, csv_end };
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+void stats_init(stats_registry_t *reg) {
+    memset(reg, 0, sizeof(*reg));
+}
+
+void stats_group_init(stats_group_t *group, const char *key, const char *title) {
+    memset(group, 0, sizeof(*group));
+    snprintf(group->key, sizeof(group->key), "%s", key);
+    snprintf(group->title, sizeof(group->title), "%s", title);
+}
+
+stats_group_t* stats_add_group(stats_registry_t *reg, const char *key, const char *title) {
+    if (reg->num_groups == reg->capacity) {
+        uint32_t capacity = reg->capacity ? 2 * reg->capacity : STATS_INITIAL_GROUPS;
+        stats_group_t *grown = realloc(reg->groups, capacity * sizeof(stats_group_t));
+        if (!grown) {
+            reg->failed = true;
+            return NULL;
+        }
+        reg->groups = grown;
+        reg->capacity = capacity;
+    }
+
+    stats_group_t *group = &reg->groups[reg->num_groups++];
+    stats_group_init(group, key, title);
+    return group;
+}
+
+stats_group_t* stats_find_group(stats_registry_t *reg, const char *key) {
+    for (uint32_t i = 0; i < reg->num_groups; i++) {
+        if (strcmp(reg->groups[i].key, key) == 0) {
+            return &reg->groups[i];
+        }
+    }
+    return NULL;
+}
+
+void stats_add_counter(stats_group_t *group, const char *key, const char *label,
+                       uint64_t value) {
+    if (group->num_counters < STATS_MAX_COUNTERS) {
+        stats_counter_t *counter = &group->counters[group->num_counters++];
+        snprintf(counter->key, sizeof(counter->key), "%s", key);
+        snprintf(counter->label, sizeof(counter->label), "%s", label);
+        counter->value = value;
+    }
+}
+
+void stats_derive(stats_registry_t *reg) {
+    for (uint32_t i = 0; i < reg->num_groups; i++) {
+        stats_group_t *group = &reg->groups[i];
+        const stats_counter_t *accesses = find_counter(group, "accesses");
+        const stats_counter_t *hits = find_counter(group, "hits");
+        const stats_counter_t *misses = find_counter(group, "misses");
+        const stats_counter_t *cycles = find_counter(group, "cycles");
+
+        group->num_metrics = 0;
+        if (!misses) {
+            misses = find_counter(group, "page_faults");
+        }
+        if (accesses && hits) {
+            add_metric(group, "hit_rate", ratio(hits->value, accesses->value));
+        }
+        if (accesses && misses) {
+            add_metric(group, "miss_rate", ratio(misses->value, accesses->value));
+            add_metric(group, "mpki", 1000.0 * ratio(misses->value, reg->records));
+        }
+        if (accesses && cycles) {
+            add_metric(group, "amat", ratio(cycles->value, accesses->value));
+        }
+    }
+
+    /* AMAT from the last level up: each level's misses pay the next one */
+    double below = reg->memory_latency;
+    for (uint32_t i = reg->num_groups; i-- > 0; ) {
+        stats_group_t *group = &reg->groups[i];
+        if (group->latency > 0) {
+            below = group->latency + group_miss_rate(group) * below;
+            add_metric(group, "amat", below);
+        }
+    }
+}
+
+const stats_sink_t* stats_get_sink(stats_format_t format) {
+    switch (format) {
+        case STATS_JSON: return &json_sink;
+        case STATS_CSV:  return &csv_sink;
+        default:         return &text_sink;
+    }
+}
+
+void stats_emit(const stats_registry_t *reg, const stats_sink_t *sink, FILE *out) {
+    sink->begin(out, reg);
+    for (uint32_t i = 0; i < reg->num_groups; i++) {
+        sink->group(out, &reg->groups[i]);
+    }
+    sink->end(out, reg);
+}
+
+void stats_print_group(const stats_group_t *group, FILE *out) {
+    if (group->title[0] == '\0') {
+        return;
+    }
+
+    fprintf(out, "\n* %s *\n", group->title);
+    for (uint32_t i = 0; i < group->num_counters; i++) {
+        if (group->counters[i].label[0] != '\0') {
+            fprintf(out, "%s: %llu\n", group->counters[i].label,
+                    (unsigned long long)group->counters[i].value);
+        }
+    }
+}
+
+void stats_free(stats_registry_t *reg) {
+    free(reg->groups);
+    reg->groups = NULL;
+    reg->num_groups = 0;
+    reg->capacity = 0;
+}
@@ -0,0 +1,248 @@
+/**
+ * @file timing.c
+ * @brief Cycle accounting of the translate -> cache path (--timing)
+ * @author Amir Noohi
+ * @copyright Copyright (c) 2025 Amir Noohi. All rights reserved.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include "timing.h"
+#include "stats.h"
+#include "types.h"
+
+/* Distinct latencies: at most one per outcome pair */
+#define TIMING_MAX_BUCKETS (TIMING_TRANSLATIONS * TIMING_LEVELS)
+
+/**
+ * @brief Cycles split by component
+ */
+typedef struct {
+    uint64_t accesses;
+    uint64_t cycles;
+    uint64_t l1;
+    uint64_t l2;
+    uint64_t memory;
+    uint64_t page_walk;
+    uint64_t page_fault;
+} timing_summary_t;
+
+/**
+ * @brief Accesses of one latency
+ */
+typedef struct {
+    uint64_t latency;
+    uint64_t count;
+} timing_bucket_t;
+
+/* ============================================================================
+ * Helper Functions
+ * ============================================================================ */
+
+static inline uint32_t translation_outcome(tlb_result_t tlb_res, pt_result_t pt_res) {
+    if (tlb_res == TLB_HIT) {
+        return 0;
+    }
+    return (pt_res == PT_HIT) ? 1 : 2;
+}
+
+static inline uint32_t data_outcome(cache_result_t cache_res) {
+    switch (cache_res) {
+        case CACHE_HIT:
+        case CACHE_HIT_L1:
+            return 0;
+        case CACHE_HIT_L2:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+/**
+ * @brief Latency of an outcome pair
+ */
+static uint64_t pair_latency(const latency_config_t *lat, uint32_t levels,
+                             uint32_t translation, uint32_t data) {
+    uint64_t cycles = lat->l1;
+    if (translation >= 1) {
+        cycles += lat->page_walk;
+    }
+    if (translation == 2) {
+        cycles += lat->page_fault;
+    }
+    if (data >= 1 && levels > 1) {
+        cycles += lat->l2;
+    }
+    if (data == 2) {
+        cycles += lat->memory;
+    }
+    return cycles;
+}
+
+static void summarize(const timing_t *t, const latency_config_t *lat, uint32_t levels,
+                      timing_summary_t *s) {
+    memset(s, 0, sizeof(*s));
+    for (uint32_t i = 0; i < TIMING_TRANSLATIONS; i++) {
+        for (uint32_t j = 0; j < TIMING_LEVELS; j++) {
+            uint64_t n = t->counts[i][j];
+            s->accesses += n;
+            s->cycles += n * pair_latency(lat, levels, i, j);
+            s->l1 += n * lat->l1;
+            if (i >= 1) {
+                s->page_walk += n * lat->page_walk;
+            }
+            if (i == 2) {
+                s->page_fault += n * lat->page_fault;
+            }
+            if (j >= 1 && levels > 1) {
+                s->l2 += n * lat->l2;
+            }
+            if (j == 2) {
+                s->memory += n * lat->memory;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Merge the outcome pairs into buckets of distinct latency
+ *
+ * @return Number of buckets, sorted by latency
+ */
+static uint32_t histogram(const timing_t *t, const latency_config_t *lat, uint32_t levels,
+                          timing_bucket_t *buckets) {
+    uint32_t n = 0;
+    for (uint32_t i = 0; i < TIMING_TRANSLATIONS; i++) {
+        for (uint32_t j = 0; j < TIMING_LEVELS; j++) {
+            if (t->counts[i][j] == 0) {
+                continue;
+            }
+            uint64_t latency = pair_latency(lat, levels, i, j);
+
+            /* Insertion into the sorted buckets */
+            uint32_t k = 0;
+            while (k < n && buckets[k].latency < latency) {
+                k++;
+            }
+            if (k < n && buckets[k].latency == latency) {
+                buckets[k].count += t->counts[i][j];
+                continue;
+            }
+            memmove(&buckets[k + 1], &buckets[k], (n - k) * sizeof(timing_bucket_t));
+            buckets[k].latency = latency;
+            buckets[k].count = t->counts[i][j];
+            n++;
+        }
+    }
+    return n;
+}
+
+/**
+ * @brief Smallest latency of at least a fraction p of the accesses
+ */
+static uint64_t percentile(const timing_bucket_t *buckets, uint32_t n, uint64_t total,
+                           double p) {
+    uint64_t rank = (uint64_t)(p * (double)total);
+    if ((double)rank < p * (double)total) {
+        rank++;
+    }
+
+    uint64_t seen = 0;
+    for (uint32_t k = 0; k < n; k++) {
+        seen += buckets[k].count;
+        if (seen >= rank) {
+            return buckets[k].latency;
+        }
+    }
+    return n ? buckets[n - 1].latency : 0;
+}
+
+static double share(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * (double)part / (double)whole : 0.0;
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+void timing_reset(timing_t *t) {
+    memset(t, 0, sizeof(*t));
+}
+
+void timing_record_batch(timing_t *t, const tlb_result_t *tlb_res,
+                         const pt_result_t *pt_res, const cache_result_t *cache_res,
+                         size_t n) {
+    for (size_t i = 0; i < n; i++) {
+        t->counts[translation_outcome(tlb_res[i], pt_res[i])][data_outcome(cache_res[i])]++;
+    }
+}
+
+void timing_register_stats(const timing_t *t, const latency_config_t *lat,
+                           uint32_t levels, stats_registry_t *reg) {
+    timing_summary_t s;
+    summarize(t, lat, levels, &s);
+
+    stats_group_t *group = stats_add_group(reg, "timing", "");
+    if (group) {
+        stats_add_counter(group, "accesses", "", s.accesses);
+        stats_add_counter(group, "cycles", "", s.cycles);
+        stats_add_counter(group, "l1_cycles", "", s.l1);
+        stats_add_counter(group, "l2_cycles", "", s.l2);
+        stats_add_counter(group, "memory_cycles", "", s.memory);
+        stats_add_counter(group, "page_walk_cycles", "", s.page_walk);
+        stats_add_counter(group, "page_fault_cycles", "", s.page_fault);
+        stats_add_counter(group, "stall_cycles", "", s.cycles - s.l1);
+    }
+
+    timing_bucket_t buckets[TIMING_MAX_BUCKETS];
+    uint32_t n = histogram(t, lat, levels, buckets);
+    group = stats_add_group(reg, "latency", "");
+    for (uint32_t k = 0; group && k < n; k++) {
+        char key[24];
+        snprintf(key, sizeof(key), "cycles_%llu", (unsigned long long)buckets[k].latency);
+        stats_add_counter(group, key, "", buckets[k].count);
+    }
+}
+
+void timing_print(const timing_t *t, const latency_config_t *lat, uint32_t levels,
+                  FILE *out) {
+    timing_summary_t s;
+    summarize(t, lat, levels, &s);
+
+    fprintf(out, "\n* Timing Statistics *\n");
+    fprintf(out, "total cycles: %llu\n", (unsigned long long)s.cycles);
+    fprintf(out, "average access time: %.2f cycles\n",
+            s.accesses ? (double)s.cycles / (double)s.accesses : 0.0);
+    fprintf(out, "%s cycles: %llu (%.2f%%)\n", levels > 1 ? "L1" : "cache",
+            (unsigned long long)s.l1, share(s.l1, s.cycles));
+    if (levels > 1) {
+        fprintf(out, "L2 cycles: %llu (%.2f%%)\n",
+                (unsigned long long)s.l2, share(s.l2, s.cycles));
+    }
+    fprintf(out, "memory cycles: %llu (%.2f%%)\n",
+            (unsigned long long)s.memory, share(s.memory, s.cycles));
+    fprintf(out, "page walk cycles: %llu (%.2f%%)\n",
+            (unsigned long long)s.page_walk, share(s.page_walk, s.cycles));
+    fprintf(out, "page fault cycles: %llu (%.2f%%)\n",
+            (unsigned long long)s.page_fault, share(s.page_fault, s.cycles));
+    fprintf(out, "stall cycles: %llu (%.2f%%)\n",
+            (unsigned long long)(s.cycles - s.l1), share(s.cycles - s.l1, s.cycles));
+
+    timing_bucket_t buckets[TIMING_MAX_BUCKETS];
+    uint32_t n = histogram(t, lat, levels, buckets);
+    fprintf(out, "latency percentiles: p50 %llu, p90 %llu, p99 %llu, p99.9 %llu\n",
+            (unsigned long long)percentile(buckets, n, s.accesses, 0.50),
+            (unsigned long long)percentile(buckets, n, s.accesses, 0.90),
+            (unsigned long long)percentile(buckets, n, s.accesses, 0.99),
+            (unsigned long long)percentile(buckets, n, s.accesses, 0.999));
+
+    fprintf(out, "\n* Access Latency Histogram *\n");
+    fprintf(out, "cycles accesses share cumulative\n");
+    uint64_t seen = 0;
+    for (uint32_t k = 0; k < n; k++) {
+        seen += buckets[k].count;
+        fprintf(out, "%llu %llu %.2f%% %.2f%%\n", (unsigned long long)buckets[k].latency,
+                (unsigned long long)buckets[k].count, share(buckets[k].count, s.accesses),
+                share(seen, s.accesses));
+    }
+}
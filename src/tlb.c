@@ -13,128 +13,254 @@
 #include <stdlib.h>
 #include <string.h>
 #include "tlb.h"
+#include "checkpoint.h"
+#include "stats.h"
+#include "way_index.h"
+#include "tag_match.h"
+#include "replacement.h"
+#include "output.h"
 #include "types.h"
 
 /* External function from cache.c */
 extern uint32_t log2_uint32(uint32_t n);
+extern uint32_t hash_set_index(uint32_t block, uint32_t num_sets);
 
 /* ============================================================================
  * Helper Functions
  * ============================================================================ */
 
 /**
- * @brief Initialize TLB entry list for LRU
+ * @brief First entry of a set in the per-entry arrays
  */
-static void init_tlb_lru(tlb_set_t *set) {
-    if (set->num_ways <= 1) return;
-    
-    set->lru_head = &set->entries[0];
-    set->lru_tail = &set->entries[set->num_ways - 1];
+static inline uint32_t set_base(const tlb_t *tlb, uint32_t index) {
+    return index * tlb->ways_per_set;
+}
+
+/**
+ * @brief Replacement state of a set
+ */
+static inline void* set_repl(const tlb_t *tlb, uint32_t index) {
+    return tlb->repl_state + (size_t)index * tlb->repl_stride;
+}
+
+/**
+ * @brief Tell the replacement policy about a hit or fill
+ */
+static void tlb_repl_update(tlb_t *tlb, uint32_t index, uint32_t way, bool fill) {
+    if (tlb->ways_per_set <= 1) {
+        return;  /* Direct-mapped: no replacement state */
+    }
     
-    for (uint32_t i = 0; i < set->num_ways; i++) {
-        set->entries[i].valid = false;
-        set->entries[i].dirty = false;
-        set->entries[i].vpn = 0;
-        set->entries[i].ppn = 0;
-        
-        if (i > 0) {
-            set->entries[i].prev = &set->entries[i - 1];
-        }
-        if (i < set->num_ways - 1) {
-            set->entries[i].next = &set->entries[i + 1];
-        }
+    if (fill) {
+        tlb->repl->insert(set_repl(tlb, index), tlb->ways_per_set, way, tlb->next_use);
+    } else {
+        tlb->repl->touch(set_repl(tlb, index), tlb->ways_per_set, way, tlb->next_use);
     }
 }
 
 /**
- * @brief Move TLB entry to head of LRU list
+ * @brief Find the way of a set holding a VPN tag
+ * 
+ * Only ways [0, fill) are valid, so the tags are searched with the
+ * vector kernel and no valid check. Large fully-associative TLBs use
+ * the VPN index instead.
+ * 
+ * @return Way index, or WAY_NONE on miss
  */
-static void tlb_lru_move_to_head(tlb_set_t *set, tlb_entry_t *entry) {
-    if (!entry || set->num_ways <= 1 || entry == set->lru_head) {
-        return;
+static uint32_t find_tlb_entry(const tlb_t *tlb, uint32_t index, uint32_t vpn) {
+    if (tlb->vpn_index.slots) {
+        return way_index_find(&tlb->vpn_index, vpn);
     }
     
-    /* Remove from current position */
-    if (entry->prev) {
-        entry->prev->next = entry->next;
-    }
-    if (entry->next) {
-        entry->next->prev = entry->prev;
+    return tag_match(tlb->vpns + set_base(tlb, index), tlb->sets[index].fill, vpn);
+}
+
+/**
+ * @brief Select victim TLB entry for eviction
+ */
+static uint32_t select_tlb_victim(tlb_t *tlb, uint32_t index) {
+    tlb_set_t *set = &tlb->sets[index];
+    
+    /* Entries fill in order, so a free entry is the one after the last */
+    if (set->fill < tlb->ways_per_set) {
+        return set->fill++;
     }
     
-    /* Update tail if needed */
-    if (entry == set->lru_tail) {
-        set->lru_tail = entry->prev;
+    /* Ask the replacement policy */
+    if (tlb->ways_per_set == 1) {
+        return 0;
     }
     
-    /* Insert at head */
-    entry->prev = NULL;
-    entry->next = set->lru_head;
-    if (set->lru_head) {
-        set->lru_head->prev = entry;
+    return tlb->repl->victim(set_repl(tlb, index), tlb->ways_per_set);
+}
+
+/**
+ * @brief Get set index for VPN
+ */
+static uint32_t get_tlb_index(const tlb_t *tlb, uint32_t vpn) {
+    switch (tlb->index_mode) {
+        case INDEX_MODULO:
+            return vpn % tlb->num_sets;
+        case INDEX_HASH:
+            return hash_set_index(vpn, tlb->num_sets);
+        default:
+            return vpn & ((1u << tlb->index_bits) - 1);
     }
-    set->lru_head = entry;
 }
 
 /**
- * @brief Find TLB entry with matching VPN
+ * @brief Get tag for VPN
  */
-static tlb_entry_t* find_tlb_entry(tlb_set_t *set, uint32_t vpn) {
-    for (uint32_t i = 0; i < set->num_ways; i++) {
-        if (set->entries[i].valid && set->entries[i].vpn == vpn) {
-            return &set->entries[i];
-        }
+static uint32_t get_tlb_tag(const tlb_t *tlb, uint32_t vpn) {
+    switch (tlb->index_mode) {
+        case INDEX_MODULO:
+            return vpn / tlb->num_sets;
+        case INDEX_HASH:
+            return vpn;
+        default:
+            return vpn >> tlb->index_bits;
     }
-    return NULL;
 }
 
 /**
- * @brief Find invalid TLB entry
+ * @brief Rebuild the VPN held in an entry from its tag and set
  */
-static tlb_entry_t* find_invalid_tlb_entry(tlb_set_t *set) {
-    for (uint32_t i = 0; i < set->num_ways; i++) {
-        if (!set->entries[i].valid) {
-            return &set->entries[i];
-        }
+static uint32_t get_tlb_vpn(const tlb_t *tlb, uint32_t tag, uint32_t index) {
+    switch (tlb->index_mode) {
+        case INDEX_MODULO:
+            return tag * tlb->num_sets + index;
+        case INDEX_HASH:
+            return tag;
+        default:
+            return (tag << tlb->index_bits) | index;
     }
-    return NULL;
 }
 
+/* ============================================================================
+ * Lookup Paths
+ * ============================================================================ */
+
+/* Geometry a lookup path is compiled for (as in cache.c) */
+#define GEOM_ANY       0    /* Anything (runtime ways, index mode, VPN index) */
+#define GEOM_SETS      1    /* Bit-sliced sets with a constant way count */
+#define GEOM_FA        2    /* One set, VPNs scanned */
+#define GEOM_FA_INDEX  3    /* One set, VPNs found through the VPN index */
+
+#if defined(__GNUC__) || defined(__clang__)
+#define LOOKUP_INLINE static inline __attribute__((always_inline))
+#else
+#define LOOKUP_INLINE static inline
+#endif
+
 /**
- * @brief Select victim TLB entry for eviction
+ * @brief Lookup body shared by all paths (geom and const_ways are constants)
  */
-static tlb_entry_t* select_tlb_victim(tlb_set_t *set) {
-    /* Try invalid entry first */
-    tlb_entry_t *invalid = find_invalid_tlb_entry(set);
-    if (invalid) {
-        return invalid;
+LOOKUP_INLINE tlb_result_t lookup_body(tlb_t *tlb, uint32_t vpn, uint32_t *ppn, bool *dirty,
+                                       const int geom, const uint32_t const_ways) {
+    const uint32_t ways = const_ways ? const_ways : tlb->ways_per_set;
+    
+    tlb->accesses++;
+    
+    uint32_t index, tag;
+    if (geom == GEOM_ANY) {
+        index = get_tlb_index(tlb, vpn);
+        tag = get_tlb_tag(tlb, vpn);
+    } else if (geom == GEOM_SETS) {
+        index = vpn & (tlb->num_sets - 1);
+        tag = vpn >> tlb->index_bits;
+    } else {
+        index = 0;
+        tag = vpn;
     }
     
-    /* Use LRU */
-    if (set->num_ways == 1) {
-        return &set->entries[0];
+    uint32_t base = index * ways;
+    uint32_t way;
+    if (geom == GEOM_ANY) {
+        way = find_tlb_entry(tlb, index, tag);
+    } else if (geom == GEOM_FA_INDEX) {
+        way = way_index_find(&tlb->vpn_index, tag);
+    } else {
+        way = tag_match(tlb->vpns + base, tlb->sets[index].fill, tag);
+    }
+    
+    if (way != WAY_NONE) {
+        /* TLB HIT */
+        uint32_t e = base + way;
+        tlb->hits++;
+        *ppn = tlb->ppns[e];
+        *dirty = (tlb->state[e] & LINE_DIRTY) != 0;
+        
+        /* Update replacement state */
+        if (ways > 1) {
+            tlb->repl->touch(set_repl(tlb, index), ways, way, tlb->next_use);
+        }
+        
+        return TLB_HIT;
     }
     
-    return set->lru_tail;
+    /* TLB MISS */
+    tlb->misses++;
+    return TLB_MISS;
 }
 
+#define DEFINE_TLB_LOOKUP(name, geom, ways)                                     \
+    static tlb_result_t name(tlb_t *tlb, uint32_t vpn, uint32_t *ppn,           \
+                             bool *dirty) {                                     \
+        return lookup_body(tlb, vpn, ppn, dirty, geom, ways);                   \
+    }
+
+DEFINE_TLB_LOOKUP(lookup_generic, GEOM_ANY, 0)
+
+#ifndef GENERIC_ACCESS_ONLY
+DEFINE_TLB_LOOKUP(lookup_dm, GEOM_SETS, 1)
+DEFINE_TLB_LOOKUP(lookup_2way, GEOM_SETS, 2)
+DEFINE_TLB_LOOKUP(lookup_4way, GEOM_SETS, 4)
+DEFINE_TLB_LOOKUP(lookup_8way, GEOM_SETS, 8)
+DEFINE_TLB_LOOKUP(lookup_16way, GEOM_SETS, 16)
+DEFINE_TLB_LOOKUP(lookup_fa, GEOM_FA, 0)
+DEFINE_TLB_LOOKUP(lookup_fa_indexed, GEOM_FA_INDEX, 0)
+#endif
+
 /**
- * @brief Get set index for VPN
+ * @brief Describe the geometry of a TLB for checkpoints
  */
-static uint32_t get_tlb_index(const tlb_t *tlb, uint32_t vpn) {
-    if (tlb->associativity == FULLY_ASSOC) {
-        return 0;
-    }
+static void tlb_geometry(const tlb_t *tlb, ckpt_geometry_t *geo) {
+    size_t n = (size_t)tlb->num_sets * tlb->ways_per_set;
     
-    uint32_t index_mask = (1 << tlb->index_bits) - 1;
-    return vpn & index_mask;
+    memset(geo, 0, sizeof(*geo));
+    geo->sets = tlb->num_sets;
+    geo->ways = tlb->ways_per_set;
+    geo->index_mode = (uint32_t)tlb->index_mode;
+    geo->state_bytes = tlb->num_sets * sizeof(tlb_set_t) +
+                       n * (2 * sizeof(uint32_t) + sizeof(uint8_t)) +
+                       tlb->num_sets * tlb->repl_stride;
+    if (tlb->vpn_index.slots) {
+        geo->state_bytes += ((uint64_t)tlb->vpn_index.mask + 1) * sizeof(way_index_slot_t);
+    }
+    strncpy(geo->policy, tlb->repl->name, sizeof(geo->policy) - 1);
 }
 
 /**
- * @brief Get tag for VPN
+ * @brief Pick the lookup path of a fully-initialized TLB
  */
-static uint32_t get_tlb_tag(const tlb_t *tlb, uint32_t vpn) {
-    return vpn >> tlb->index_bits;
+static tlb_lookup_fn select_lookup(const tlb_t *tlb) {
+#ifndef GENERIC_ACCESS_ONLY
+    if (tlb->index_mode == INDEX_BITS) {
+        if (tlb->num_sets == 1) {
+            return tlb->vpn_index.slots ? lookup_fa_indexed : lookup_fa;
+        }
+        switch (tlb->ways_per_set) {
+            case 1:  return lookup_dm;
+            case 2:  return lookup_2way;
+            case 4:  return lookup_4way;
+            case 8:  return lookup_8way;
+            case 16: return lookup_16way;
+            default: break;
+        }
+    }
+#endif
+    (void)tlb;
+    return lookup_generic;
 }
 
 /* ============================================================================
@@ -172,6 +298,11 @@ tlb_t* tlb_init(tlb_config_t config) {
             tlb->num_sets = config.num_entries / 4;
             break;
             
+        case N_WAY:
+            tlb->ways_per_set = config.ways;
+            tlb->num_sets = config.num_entries / config.ways;
+            break;
+            
         default:
             free(tlb);
             return NULL;
@@ -179,34 +310,57 @@ tlb_t* tlb_init(tlb_config_t config) {
     
     /* Calculate bit fields */
     tlb->offset_bits = 12;  /* 4KB pages */
-    tlb->index_bits = (config.associativity == FULLY_ASSOC) ? 
-                      0 : log2_uint32(tlb->num_sets);
+    if (config.hash_index && tlb->num_sets > 1) {
+        tlb->index_mode = INDEX_HASH;
+    } else if (tlb->num_sets & (tlb->num_sets - 1)) {
+        tlb->index_mode = INDEX_MODULO;
+    } else {
+        tlb->index_mode = INDEX_BITS;
+        tlb->index_bits = log2_uint32(tlb->num_sets);
+    }
     tlb->tag_bits = 20 - tlb->index_bits;  /* VPN is 20 bits (bits 31-12) */
     
-    /* Allocate sets */
+    /* Allocate set headers and per-entry arrays */
+    uint32_t n = tlb->num_sets * tlb->ways_per_set;
     tlb->sets = calloc(tlb->num_sets, sizeof(tlb_set_t));
-    if (!tlb->sets) {
-        free(tlb);
+    tlb->vpns = calloc(n, sizeof(uint32_t));
+    tlb->ppns = calloc(n, sizeof(uint32_t));
+    tlb->state = calloc(n, sizeof(uint8_t));
+    if (!tlb->sets || !tlb->vpns || !tlb->ppns || !tlb->state) {
+        tlb_destroy(tlb);
         return NULL;
     }
     
-    /* Initialize each set */
-    for (uint32_t i = 0; i < tlb->num_sets; i++) {
-        tlb->sets[i].num_ways = tlb->ways_per_set;
-        tlb->sets[i].entries = calloc(tlb->ways_per_set, sizeof(tlb_entry_t));
-        
-        if (!tlb->sets[i].entries) {
-            for (uint32_t j = 0; j < i; j++) {
-                free(tlb->sets[j].entries);
-            }
-            free(tlb->sets);
-            free(tlb);
+    /* Replacement state (direct-mapped sets have no choice to make) */
+    tlb->repl = repl_get_ops(config.policy);
+    if (!tlb->repl) {
+        tlb_destroy(tlb);
+        return NULL;
+    }
+    if (tlb->ways_per_set > 1) {
+        tlb->repl_stride = REPL_ALIGN_UP(tlb->repl->state_size(tlb->ways_per_set));
+        tlb->repl_state = malloc(tlb->num_sets * tlb->repl_stride);
+        if (!tlb->repl_state) {
+            tlb_destroy(tlb);
             return NULL;
         }
         
-        init_tlb_lru(&tlb->sets[i]);
+        for (uint32_t i = 0; i < tlb->num_sets; i++) {
+            tlb->repl->init(set_repl(tlb, i), tlb->ways_per_set,
+                            repl_set_seed(config.seed, i));
+        }
     }
     
+    /* Large fully-associative TLBs find VPNs through a hash index */
+    if (tlb->num_sets == 1 &&
+        tlb->ways_per_set > WAY_INDEX_MIN_WAYS &&
+        !way_index_init(&tlb->vpn_index, tlb->ways_per_set)) {
+        tlb_destroy(tlb);
+        return NULL;
+    }
+    
+    tlb->lookup = select_lookup(tlb);
+    
     tlb->accesses = 0;
     tlb->hits = 0;
     tlb->misses = 0;
@@ -215,105 +369,182 @@ tlb_t* tlb_init(tlb_config_t config) {
 }
 
 tlb_result_t tlb_lookup(tlb_t *tlb, uint32_t vpn, uint32_t *ppn, bool *dirty) {
-    tlb->accesses++;
-    
-    uint32_t index = get_tlb_index(tlb, vpn);
-    uint32_t tag = get_tlb_tag(tlb, vpn);
-    
-    tlb_set_t *set = &tlb->sets[index];
-    tlb_entry_t *entry = find_tlb_entry(set, tag);
-    
-    if (entry) {
-        /* TLB HIT */
-        tlb->hits++;
-        *ppn = entry->ppn;
-        *dirty = entry->dirty;
-        
-        /* Update LRU */
-        tlb_lru_move_to_head(set, entry);
-        
-        return TLB_HIT;
-    }
-    
-    /* TLB MISS */
-    tlb->misses++;
-    return TLB_MISS;
+    return tlb->lookup(tlb, vpn, ppn, dirty);
 }
 
 void tlb_insert(tlb_t *tlb, uint32_t vpn, uint32_t ppn) {
     uint32_t index = get_tlb_index(tlb, vpn);
     uint32_t tag = get_tlb_tag(tlb, vpn);
-    
-    tlb_set_t *set = &tlb->sets[index];
+    uint32_t base = set_base(tlb, index);
     
     /* Check if entry already exists */
-    tlb_entry_t *entry = find_tlb_entry(set, tag);
-    if (entry) {
+    uint32_t way = find_tlb_entry(tlb, index, tag);
+    if (way != WAY_NONE) {
         /* Update existing entry */
-        entry->ppn = ppn;
-        tlb_lru_move_to_head(set, entry);
+        tlb->ppns[base + way] = ppn;
+        tlb_repl_update(tlb, index, way, false);
         return;
     }
     
     /* Select victim */
-    tlb_entry_t *victim = select_tlb_victim(set);
+    uint32_t victim = select_tlb_victim(tlb, index);
+    uint32_t e = base + victim;
+    
+    /* Keep the VPN index in step with the eviction and fill */
+    if (tlb->vpn_index.slots) {
+        if (tlb->state[e] & LINE_VALID) {
+            way_index_remove(&tlb->vpn_index, tlb->vpns[e]);
+        }
+        way_index_insert(&tlb->vpn_index, tag, victim);
+    }
     
     /* Install new entry */
-    victim->valid = true;
-    victim->dirty = false;
-    victim->vpn = tag;
-    victim->ppn = ppn;
+    tlb->state[e] = LINE_VALID;
+    tlb->vpns[e] = tag;
+    tlb->ppns[e] = ppn;
     
-    /* Move to head */
-    tlb_lru_move_to_head(set, victim);
+    /* Update replacement state for the new entry */
+    tlb_repl_update(tlb, index, victim, true);
 }
 
 void tlb_set_dirty(tlb_t *tlb, uint32_t vpn) {
     uint32_t index = get_tlb_index(tlb, vpn);
     uint32_t tag = get_tlb_tag(tlb, vpn);
     
-    tlb_set_t *set = &tlb->sets[index];
-    tlb_entry_t *entry = find_tlb_entry(set, tag);
+    uint32_t way = find_tlb_entry(tlb, index, tag);
+    
+    if (way != WAY_NONE) {
+        tlb->state[set_base(tlb, index) + way] |= LINE_DIRTY;
+    }
+}
+
+void tlb_set_next_use(tlb_t *tlb, uint64_t next_use) {
+    tlb->next_use = next_use;
+}
+
+void tlb_prefetch(const tlb_t *tlb, uint32_t vpn) {
+    uint32_t index = get_tlb_index(tlb, vpn);
+    PREFETCH(&tlb->sets[index]);
+    PREFETCH(tlb->vpns + set_base(tlb, index));
+}
+
+void tlb_save(const tlb_t *tlb, ckpt_writer_t *w) {
+    size_t n = (size_t)tlb->num_sets * tlb->ways_per_set;
+    ckpt_geometry_t geo;
+    tlb_geometry(tlb, &geo);
+    ckpt_write(w, &geo, sizeof(geo));
+    
+    ckpt_write(w, tlb->sets, tlb->num_sets * sizeof(tlb_set_t));
+    ckpt_write(w, tlb->vpns, n * sizeof(uint32_t));
+    ckpt_write(w, tlb->ppns, n * sizeof(uint32_t));
+    ckpt_write(w, tlb->state, n * sizeof(uint8_t));
+    ckpt_write(w, tlb->repl_state, tlb->num_sets * tlb->repl_stride);
+    if (tlb->vpn_index.slots) {
+        ckpt_write(w, tlb->vpn_index.slots,
+                   ((size_t)tlb->vpn_index.mask + 1) * sizeof(way_index_slot_t));
+    }
+    
+    uint64_t stats[] = { tlb->accesses, tlb->hits, tlb->misses };
+    ckpt_write(w, stats, sizeof(stats));
+}
+
+bool tlb_restore(tlb_t *tlb, ckpt_reader_t *r) {
+    size_t n = (size_t)tlb->num_sets * tlb->ways_per_set;
+    ckpt_geometry_t geo;
+    tlb_geometry(tlb, &geo);
+    if (!ckpt_check_geometry(r, &geo) ||
+        !ckpt_read(r, tlb->sets, tlb->num_sets * sizeof(tlb_set_t)) ||
+        !ckpt_read(r, tlb->vpns, n * sizeof(uint32_t)) ||
+        !ckpt_read(r, tlb->ppns, n * sizeof(uint32_t)) ||
+        !ckpt_read(r, tlb->state, n * sizeof(uint8_t))) {
+        return false;
+    }
+    if (tlb->repl_state &&
+        !ckpt_read(r, tlb->repl_state, tlb->num_sets * tlb->repl_stride)) {
+        return false;
+    }
+    if (tlb->vpn_index.slots &&
+        !ckpt_read(r, tlb->vpn_index.slots,
+                   ((size_t)tlb->vpn_index.mask + 1) * sizeof(way_index_slot_t))) {
+        return false;
+    }
     
-    if (entry) {
-        entry->dirty = true;
+    uint64_t stats[3];
+    if (!ckpt_read(r, stats, sizeof(stats))) {
+        return false;
+    }
+    tlb->accesses = stats[0];
+    tlb->hits = stats[1];
+    tlb->misses = stats[2];
+    return true;
+}
+
+void tlb_reset_stats(tlb_t *tlb) {
+    tlb->accesses = 0;
+    tlb->hits = 0;
+    tlb->misses = 0;
+}
+
+/**
+ * @brief Add the counters of a TLB to a statistics group
+ */
+static void tlb_fill_stats(const tlb_t *tlb, stats_group_t *group) {
+    stats_add_counter(group, "accesses", "total accesses", tlb->accesses);
+    stats_add_counter(group, "hits", "hits", tlb->hits);
+    stats_add_counter(group, "misses", "misses", tlb->misses);
+}
+
+void tlb_register_stats(const tlb_t *tlb, stats_registry_t *reg) {
+    stats_group_t *group = stats_add_group(reg, "tlb", "TLB Statistics");
+    if (group) {
+        tlb_fill_stats(tlb, group);
     }
 }
 
 void tlb_print_stats(const tlb_t *tlb) {
-    printf("\n* TLB Statistics *\n");
-    printf("total accesses: %llu\n", (unsigned long long)tlb->accesses);
-    printf("hits: %llu\n", (unsigned long long)tlb->hits);
-    printf("misses: %llu\n", (unsigned long long)tlb->misses);
+    stats_group_t group;
+    stats_group_init(&group, "tlb", "TLB Statistics");
+    tlb_fill_stats(tlb, &group);
+    stats_print_group(&group, stdout);
 }
 
 void tlb_print_entries(const tlb_t *tlb) {
-    printf("\nTLB Entries (Valid-Bit Dirty-Bit VPN PPN)\n");
+    out_writer_t out;
+    out_init(&out, stdout);
+    
+    OUT_LIT(&out, "\nTLB Entries (Valid-Bit Dirty-Bit VPN PPN)\n");
     
     for (uint32_t i = 0; i < tlb->num_sets; i++) {
-        for (uint32_t j = 0; j < tlb->sets[i].num_ways; j++) {
-            tlb_entry_t *entry = &tlb->sets[i].entries[j];
+        for (uint32_t j = 0; j < tlb->ways_per_set; j++) {
+            uint32_t e = set_base(tlb, i) + j;
             
-            if (entry->valid) {
+            if (tlb->state[e] & LINE_VALID) {
                 /* Reconstruct full VPN */
-                uint32_t full_vpn = (entry->vpn << tlb->index_bits) | i;
-                printf("%d %d 0x%05x 0x%05x\n", 
-                       1, entry->dirty ? 1 : 0, full_vpn, entry->ppn);
+                uint32_t full_vpn = get_tlb_vpn(tlb, tlb->vpns[e], i);
+                OUT_LIT(&out, "1 ");
+                out_char(&out, (tlb->state[e] & LINE_DIRTY) ? '1' : '0');
+                OUT_LIT(&out, " 0x");
+                out_hex(&out, full_vpn, 5);
+                OUT_LIT(&out, " 0x");
+                out_hex(&out, tlb->ppns[e], 5);
+                out_char(&out, '\n');
             } else {
-                printf("%d %d - -\n", 0, 0);
+                OUT_LIT(&out, "0 0 - -\n");
             }
         }
     }
+    
+    out_flush(&out);
 }
 
 void tlb_destroy(tlb_t *tlb) {
     if (!tlb) return;
     
-    for (uint32_t i = 0; i < tlb->num_sets; i++) {
-        free(tlb->sets[i].entries);
-    }
-    
+    way_index_free(&tlb->vpn_index);
     free(tlb->sets);
+    free(tlb->vpns);
+    free(tlb->ppns);
+    free(tlb->state);
+    free(tlb->repl_state);
     free(tlb);
 }
-
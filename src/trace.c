@@ -0,0 +1,820 @@
+/**
+ * @file trace.c
+ * @brief Memory trace readers and writers
+ * @author Amir Noohi
+ * @copyright Copyright (c) 2025 Amir Noohi. All rights reserved.
+ *
+ * Both formats are decoded straight out of a byte window [pos, end):
+ * - Regular files are mmap'd once, so the window is the whole file and
+ *   decoding is zero-copy.
+ * - Anything that cannot be mapped (pipes, character devices) falls back
+ *   to a streaming buffer that is refilled with large read() calls.
+ *
+ * The text decoder is a hand-written scanner that accepts exactly what the
+ * original `fscanf(trace, " %c 0x%x", ...)` loop accepted.
+ *
+ * gzip-compressed input (detected by its magic, built with HAVE_ZLIB) is
+ * inflated into the stream buffer before decoding. Whenever the input is
+ * compressed or cannot be mapped, decoding moves to a reader thread that
+ * passes batches of records to trace_next() through a bounded ring, so
+ * I/O and decompression overlap the simulation.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <limits.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <pthread.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#include "trace.h"
+#include "ring.h"
+#include "types.h"
+
+/* Initial size of the streaming buffer (grows for oversized records) */
+#define TRACE_STREAM_BUFFER (1 << 20)
+
+/* Compressed input read per read() call */
+#define TRACE_GZ_INPUT (1 << 18)
+
+/* Compressed input of a mapped file handed to inflate() at once (avail_in
+ * is a uInt) */
+#define TRACE_GZ_MAP_CHUNK ((size_t)UINT_MAX)
+
+/* Reader thread hand-off: records per batch, batches in flight */
+#define TRACE_BATCH_RECORDS 4096
+#define TRACE_RING_SLOTS 16
+
+/* gzip member magic */
+#define GZIP_MAGIC0 0x1f
+#define GZIP_MAGIC1 0x8b
+
+/* ============================================================================
+ * Internal Structures
+ * ============================================================================ */
+
+/**
+ * @brief Batch of decoded records passed from the reader thread
+ */
+typedef struct {
+    size_t count;
+    trace_record_t recs[TRACE_BATCH_RECORDS];
+} trace_batch_t;
+
+struct trace_reader_s {
+    int fd;
+    bool own_fd;                   /* false for stdin */
+    trace_format_t format;
+    trace_identity_t identity;
+
+    /* Byte source: either a mapping of the whole file or a stream buffer */
+    uint8_t *map;                  /* mmap'd file (NULL when streaming) */
+    size_t map_len;
+    uint8_t *buf;                  /* Stream buffer */
+    size_t buf_cap;
+    const uint8_t *pos;            /* Next unread byte */
+    const uint8_t *end;            /* One past the last buffered byte */
+    bool eof;                      /* No bytes beyond end */
+    bool failed;                   /* Input ended early or is corrupt */
+
+    /* Binary decoding state */
+    uint64_t remaining;            /* Records not yet decoded */
+
+#ifdef HAVE_ZLIB
+    /* gzip decoding state */
+    bool gz;                       /* Window holds inflated bytes */
+    z_stream zs;
+    uint8_t *zbuf;                 /* Compressed input (when streaming) */
+    const uint8_t *zin;            /* Compressed input not yet handed to */
+    size_t zin_len;                /* inflate() (when mapped) */
+    bool zeof;                     /* No compressed input left */
+    bool member_done;              /* Inflated a full gzip member */
+#endif
+
+    /* Reader thread state */
+    bool threaded;
+    pthread_t thread;
+    ring_t *ring;
+    trace_batch_t *batch;          /* Batch being consumed */
+    size_t batch_pos;
+};
+
+struct trace_writer_s {
+    FILE *file;
+    uint64_t count;                /* Records written so far */
+};
+
+/**
+ * @brief Text scanner outcome
+ */
+typedef enum {
+    SCAN_OK,                       /* Record decoded */
+    SCAN_FAIL,                     /* Input does not match; stop */
+    SCAN_MORE                      /* Ran off the window before deciding */
+} scan_result_t;
+
+/* ============================================================================
+ * Helper Functions
+ * ============================================================================ */
+
+static void put_le16(uint8_t *p, uint16_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+}
+
+static void put_le32(uint8_t *p, uint32_t v) {
+    p[0] = (uint8_t)v;
+    p[1] = (uint8_t)(v >> 8);
+    p[2] = (uint8_t)(v >> 16);
+    p[3] = (uint8_t)(v >> 24);
+}
+
+static void put_le64(uint8_t *p, uint64_t v) {
+    put_le32(p, (uint32_t)v);
+    put_le32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint16_t get_le16(const uint8_t *p) {
+    return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static uint32_t get_le32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) |
+           ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static uint64_t get_le64(const uint8_t *p) {
+    return (uint64_t)get_le32(p) | ((uint64_t)get_le32(p + 4) << 32);
+}
+
+/**
+ * @brief Build a binary trace header
+ */
+static void encode_header(uint8_t *hdr, uint64_t count) {
+    memset(hdr, 0, TRACE_BIN_HEADER_SIZE);
+    memcpy(hdr, TRACE_BIN_MAGIC, TRACE_BIN_MAGIC_SIZE);
+    put_le16(hdr + 8, TRACE_BIN_VERSION);
+    put_le16(hdr + 10, TRACE_BIN_RECORD_SIZE);
+    put_le64(hdr + 16, count);
+}
+
+/**
+ * @brief Validate a binary trace header and extract the record count
+ */
+static bool decode_header(const uint8_t *hdr, uint64_t *count) {
+    if (get_le16(hdr + 8) != TRACE_BIN_VERSION) {
+        fprintf(stderr, "Unsupported binary trace version %u\n",
+                get_le16(hdr + 8));
+        return false;
+    }
+    if (get_le16(hdr + 10) != TRACE_BIN_RECORD_SIZE ||
+        get_le32(hdr + 12) != 0) {
+        fprintf(stderr, "Malformed binary trace header\n");
+        return false;
+    }
+    *count = get_le64(hdr + 16);
+    return true;
+}
+
+/* ============================================================================
+ * Byte Source
+ * ============================================================================ */
+
+/**
+ * @brief Try to map the whole file; leaves the reader untouched on failure
+ */
+static bool map_file(trace_reader_t *reader) {
+    struct stat st;
+    if (fstat(reader->fd, &st) != 0 || !S_ISREG(st.st_mode)) {
+        return false;
+    }
+
+    if (st.st_size == 0) {
+        /* Nothing to map; an empty window at EOF */
+        reader->eof = true;
+        return true;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE,
+                     reader->fd, 0);
+    if (map == MAP_FAILED) {
+        return false;
+    }
+    posix_madvise(map, (size_t)st.st_size, POSIX_MADV_SEQUENTIAL);
+
+    reader->map = map;
+    reader->map_len = (size_t)st.st_size;
+    reader->pos = reader->map;
+    reader->end = reader->map + reader->map_len;
+    reader->eof = true;
+    return true;
+}
+
+#ifdef HAVE_ZLIB
+/**
+ * @brief Read more compressed input for inflate()
+ */
+static bool gz_read_input(trace_reader_t *reader) {
+    if (reader->zeof) {
+        return false;
+    }
+    if (reader->map) {
+        /* Hand the mapping over in chunks that fit avail_in */
+        if (reader->zin_len == 0) {
+            reader->zeof = true;
+            return false;
+        }
+        size_t n = reader->zin_len < TRACE_GZ_MAP_CHUNK ? reader->zin_len
+                                                        : TRACE_GZ_MAP_CHUNK;
+        reader->zs.next_in = (Bytef *)reader->zin;
+        reader->zs.avail_in = (uInt)n;
+        reader->zin += n;
+        reader->zin_len -= n;
+        return true;
+    }
+    for (;;) {
+        ssize_t n = read(reader->fd, reader->zbuf, TRACE_GZ_INPUT);
+        if (n > 0) {
+            reader->zs.next_in = reader->zbuf;
+            reader->zs.avail_in = (uInt)n;
+            return true;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        reader->zeof = true;
+        return false;
+    }
+}
+
+/**
+ * @brief Inflate into dst; handles concatenated gzip members
+ *
+ * @return Bytes produced, 0 at end of input or on error
+ */
+static size_t gz_fill(trace_reader_t *reader, uint8_t *dst, size_t cap) {
+    z_stream *zs = &reader->zs;
+    zs->next_out = dst;
+    zs->avail_out = (uInt)cap;
+
+    while (zs->avail_out == cap) {
+        if (zs->avail_in == 0 && !gz_read_input(reader)) {
+            if (!reader->member_done) {
+                fprintf(stderr, "gzip trace truncated\n");
+                reader->failed = true;
+            }
+            break;
+        }
+        if (reader->member_done) {
+            inflateReset(zs);
+            reader->member_done = false;
+        }
+
+        int ret = inflate(zs, Z_NO_FLUSH);
+        if (ret == Z_STREAM_END) {
+            reader->member_done = true;
+        } else if (ret != Z_OK && ret != Z_BUF_ERROR) {
+            fprintf(stderr, "Corrupt gzip trace\n");
+            reader->failed = true;
+            break;
+        }
+    }
+
+    return cap - zs->avail_out;
+}
+
+/**
+ * @brief Switch the reader to inflating the bytes it has buffered so far
+ */
+static bool gz_start(trace_reader_t *reader) {
+    const uint8_t *in = reader->pos;
+    size_t in_len = (size_t)(reader->end - reader->pos);
+
+    if (reader->map) {
+        /* The whole compressed file is already in memory; gz_read_input()
+         * feeds it to inflate() from here */
+        reader->zin = in;
+        reader->zin_len = in_len;
+    } else {
+        /* Hand the stream buffer (>= TRACE_GZ_INPUT) over as compressed input */
+        reader->zbuf = reader->buf;
+        reader->buf = NULL;
+    }
+
+    reader->buf_cap = TRACE_STREAM_BUFFER;
+    reader->buf = malloc(reader->buf_cap);
+    if (!reader->buf) {
+        return false;
+    }
+
+    memset(&reader->zs, 0, sizeof(reader->zs));
+    if (inflateInit2(&reader->zs, 16 + MAX_WBITS) != Z_OK) {
+        return false;
+    }
+    if (!reader->map) {
+        /* Less than one stream buffer */
+        reader->zs.next_in = (Bytef *)in;
+        reader->zs.avail_in = (uInt)in_len;
+    }
+
+    reader->gz = true;
+    reader->pos = reader->buf;
+    reader->end = reader->buf;
+    reader->eof = false;
+    return true;
+}
+#endif
+
+/**
+ * @brief Pull more bytes into the stream buffer
+ *
+ * Unread bytes are moved to the front of the buffer first, so a record
+ * that straddles two reads stays contiguous. The buffer doubles when the
+ * unread bytes already fill it.
+ *
+ * @return true if at least one byte was added
+ */
+static bool refill(trace_reader_t *reader) {
+    if (reader->eof) {
+        return false;
+    }
+
+    size_t pending = (size_t)(reader->end - reader->pos);
+    if (pending == reader->buf_cap) {
+        uint8_t *grown = realloc(reader->buf, reader->buf_cap * 2);
+        if (!grown) {
+            reader->eof = true;
+            return false;
+        }
+        reader->pos = grown + (reader->pos - reader->buf);
+        reader->buf = grown;
+        reader->buf_cap *= 2;
+    }
+    memmove(reader->buf, reader->pos, pending);
+    reader->pos = reader->buf;
+    reader->end = reader->buf + pending;
+
+#ifdef HAVE_ZLIB
+    if (reader->gz) {
+        size_t n = gz_fill(reader, reader->buf + pending,
+                           reader->buf_cap - pending);
+        reader->end += n;
+        if (n == 0) {
+            reader->eof = true;
+        }
+        return n > 0;
+    }
+#endif
+
+    for (;;) {
+        ssize_t n = read(reader->fd, reader->buf + pending,
+                         reader->buf_cap - pending);
+        if (n > 0) {
+            reader->end += n;
+            return true;
+        }
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        reader->eof = true;
+        return false;
+    }
+}
+
+/**
+ * @brief Make sure at least n unread bytes are buffered (unless at EOF)
+ */
+static bool ensure(trace_reader_t *reader, size_t n) {
+    while ((size_t)(reader->end - reader->pos) < n) {
+        if (!refill(reader)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ============================================================================
+ * Text Scanner
+ * ============================================================================ */
+
+/* Hex digit values (only meaningful where is_hex() holds) */
+static const uint8_t hex_value[256] = {
+    ['0'] = 0,  ['1'] = 1,  ['2'] = 2,  ['3'] = 3,  ['4'] = 4,
+    ['5'] = 5,  ['6'] = 6,  ['7'] = 7,  ['8'] = 8,  ['9'] = 9,
+    ['a'] = 10, ['b'] = 11, ['c'] = 12, ['d'] = 13, ['e'] = 14, ['f'] = 15,
+    ['A'] = 10, ['B'] = 11, ['C'] = 12, ['D'] = 13, ['E'] = 14, ['F'] = 15
+};
+
+static inline bool is_hex(uint8_t c) {
+    return (c >= '0' && c <= '9') || ((c | 0x20) >= 'a' && (c | 0x20) <= 'f');
+}
+
+/* Same set as isspace() in the C locale */
+static inline bool is_space(uint8_t c) {
+    return c == ' ' || (c >= '\t' && c <= '\r');
+}
+
+static inline const uint8_t* skip_space(const uint8_t *p, const uint8_t *end) {
+    while (p < end && is_space(*p)) {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * @brief Decode one "<mode> 0x<hex>" record from [*pp, end)
+ *
+ * Follows scanf rules: whitespace is optional everywhere the format has a
+ * space, %x itself accepts a sign and a second 0x prefix, and the value is
+ * strtoul()-converted (saturating) then truncated to 32 bits. A record
+ * that reaches `end` is only accepted when `at_eof` says no more input can
+ * follow; otherwise SCAN_MORE asks the caller to refill and retry.
+ */
+static scan_result_t scan_record(const uint8_t **pp, const uint8_t *end,
+                                 bool at_eof, trace_record_t *rec) {
+    const uint8_t *p = skip_space(*pp, end);
+    if (p == end) return at_eof ? SCAN_FAIL : SCAN_MORE;
+    char mode = (char)*p++;
+
+    p = skip_space(p, end);
+    if (p == end) return at_eof ? SCAN_FAIL : SCAN_MORE;
+    if (*p++ != '0') return SCAN_FAIL;
+    if (p == end) return at_eof ? SCAN_FAIL : SCAN_MORE;
+    if (*p++ != 'x') return SCAN_FAIL;
+
+    /* %x: leading whitespace, optional sign, optional 0x prefix */
+    p = skip_space(p, end);
+    if (p == end) return at_eof ? SCAN_FAIL : SCAN_MORE;
+    bool negative = false;
+    if (*p == '+' || *p == '-') {
+        negative = (*p == '-');
+        p++;
+        if (p == end) return at_eof ? SCAN_FAIL : SCAN_MORE;
+    }
+    bool have_digit = false;
+    if (*p == '0' && end - p >= 2 && (p[1] | 0x20) == 'x') {
+        /* glibc consumes the prefix even with no digits after it (value 0) */
+        p += 2;
+        have_digit = true;
+    }
+    if (!have_digit && !is_hex(*p)) return SCAN_FAIL;
+
+    uint64_t value = 0;
+    bool saturated = false;
+    while (p < end && is_hex(*p)) {
+        if (value >> 60) {
+            saturated = true;
+        }
+        value = (value << 4) | hex_value[*p++];
+    }
+    if (p == end && !at_eof) return SCAN_MORE;
+    if (saturated) {
+        value = UINT64_MAX;
+    }
+    if (negative) {
+        value = 0 - value;
+    }
+
+    rec->mode = mode;
+    rec->vaddr = (uint32_t)value;
+    *pp = p;
+    return SCAN_OK;
+}
+
+static bool next_text(trace_reader_t *reader, trace_record_t *rec) {
+    for (;;) {
+        const uint8_t *p = reader->pos;
+        switch (scan_record(&p, reader->end, reader->eof, rec)) {
+            case SCAN_OK:
+                reader->pos = p;
+                return true;
+            case SCAN_FAIL:
+                return false;
+            case SCAN_MORE:
+                /* refill() only fails once eof is set, so this terminates */
+                refill(reader);
+                break;
+        }
+    }
+}
+
+static bool next_binary(trace_reader_t *reader, trace_record_t *rec) {
+    if (reader->remaining == 0) {
+        return false;
+    }
+    if (!ensure(reader, TRACE_BIN_RECORD_SIZE)) {
+        fprintf(stderr, "Binary trace truncated: %llu records missing\n",
+                (unsigned long long)reader->remaining);
+        reader->remaining = 0;
+        reader->failed = true;
+        return false;
+    }
+
+    const uint8_t *p = reader->pos;
+    rec->mode = (char)p[0];
+    rec->vaddr = get_le32(p + 1);
+    reader->pos = p + TRACE_BIN_RECORD_SIZE;
+    reader->remaining--;
+    return true;
+}
+
+/**
+ * @brief Decode the next record on the calling thread
+ */
+static bool decode_next(trace_reader_t *reader, trace_record_t *rec) {
+    if (reader->format == TRACE_FORMAT_TEXT) {
+        return next_text(reader, rec);
+    }
+    return next_binary(reader, rec);
+}
+
+/* ============================================================================
+ * Reader Thread
+ * ============================================================================ */
+
+/**
+ * @brief Decode the whole trace into ring batches
+ */
+static void* reader_thread(void *arg) {
+    trace_reader_t *reader = arg;
+
+    for (;;) {
+        trace_batch_t *batch = ring_write_acquire(reader->ring);
+        if (!batch) {
+            break;  /* Consumer closed the ring */
+        }
+
+        size_t n = 0;
+        while (n < TRACE_BATCH_RECORDS && decode_next(reader, &batch->recs[n])) {
+            n++;
+        }
+        batch->count = n;
+
+        if (n > 0) {
+            ring_write_commit(reader->ring);
+        }
+        if (n < TRACE_BATCH_RECORDS) {
+            break;  /* End of trace */
+        }
+    }
+
+    ring_close(reader->ring);
+    return NULL;
+}
+
+static bool start_reader_thread(trace_reader_t *reader) {
+    reader->ring = ring_create(TRACE_RING_SLOTS, sizeof(trace_batch_t));
+    if (!reader->ring) {
+        return false;
+    }
+    if (pthread_create(&reader->thread, NULL, reader_thread, reader) != 0) {
+        ring_destroy(reader->ring);
+        reader->ring = NULL;
+        return false;
+    }
+    reader->threaded = true;
+    return true;
+}
+
+/* ============================================================================
+ * Reader API
+ * ============================================================================ */
+
+trace_reader_t* trace_open(const char *path) {
+    bool use_stdin = strcmp(path, TRACE_STDIN) == 0;
+    int fd = use_stdin ? STDIN_FILENO : open(path, O_RDONLY);
+    if (fd < 0) {
+        return NULL;
+    }
+
+    trace_reader_t *reader = calloc(1, sizeof(trace_reader_t));
+    if (!reader) {
+        if (!use_stdin) close(fd);
+        return NULL;
+    }
+    reader->fd = fd;
+    reader->own_fd = !use_stdin;
+
+    struct stat st;
+    if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode)) {
+        reader->identity.size = (uint64_t)st.st_size;
+        reader->identity.mtime = (uint64_t)st.st_mtim.tv_sec * 1000000000u +
+                                 (uint64_t)st.st_mtim.tv_nsec;
+    }
+
+    if (!map_file(reader)) {
+        reader->buf_cap = TRACE_STREAM_BUFFER;
+        reader->buf = malloc(reader->buf_cap);
+        if (!reader->buf) {
+            trace_close(reader);
+            return NULL;
+        }
+        reader->pos = reader->buf;
+        reader->end = reader->buf;
+    }
+
+    /* Compressed input is inflated transparently */
+    ensure(reader, 2);
+    bool compressed = reader->end - reader->pos >= 2 &&
+                      reader->pos[0] == GZIP_MAGIC0 &&
+                      reader->pos[1] == GZIP_MAGIC1;
+    if (compressed) {
+#ifdef HAVE_ZLIB
+        if (!gz_start(reader)) {
+            fprintf(stderr, "Cannot initialize gzip decoder\n");
+            trace_close(reader);
+            return NULL;
+        }
+#else
+        fprintf(stderr, "gzip traces need a build with HAVE_ZLIB\n");
+        trace_close(reader);
+        return NULL;
+#endif
+    }
+
+    /* Sniff the magic; anything else is treated as text */
+    ensure(reader, TRACE_BIN_HEADER_SIZE);
+    size_t avail = (size_t)(reader->end - reader->pos);
+    if (avail >= TRACE_BIN_MAGIC_SIZE &&
+        memcmp(reader->pos, TRACE_BIN_MAGIC, TRACE_BIN_MAGIC_SIZE) == 0) {
+        reader->format = TRACE_FORMAT_BINARY;
+        if (avail < TRACE_BIN_HEADER_SIZE) {
+            fprintf(stderr, "Malformed binary trace header\n");
+            trace_close(reader);
+            return NULL;
+        }
+        if (!decode_header(reader->pos, &reader->remaining)) {
+            trace_close(reader);
+            return NULL;
+        }
+        reader->pos += TRACE_BIN_HEADER_SIZE;
+    } else {
+        reader->format = TRACE_FORMAT_TEXT;
+    }
+
+    /* Mapped plain files decode inline; everything else gets a thread */
+    if ((compressed || !reader->map) && !start_reader_thread(reader)) {
+        trace_close(reader);
+        return NULL;
+    }
+
+    return reader;
+}
+
+bool trace_next(trace_reader_t *reader, trace_record_t *rec) {
+    if (!reader->threaded) {
+        return decode_next(reader, rec);
+    }
+
+    if (!reader->batch || reader->batch_pos == reader->batch->count) {
+        if (reader->batch) {
+            ring_read_release(reader->ring);
+        }
+        reader->batch = ring_read_acquire(reader->ring);
+        reader->batch_pos = 0;
+        if (!reader->batch) {
+            return false;
+        }
+    }
+
+    *rec = reader->batch->recs[reader->batch_pos++];
+    return true;
+}
+
+trace_format_t trace_get_format(const trace_reader_t *reader) {
+    return reader->format;
+}
+
+uint64_t trace_tell(const trace_reader_t *reader) {
+    if (reader->threaded || !reader->map) {
+        return TRACE_OFFSET_UNKNOWN;
+    }
+    return (uint64_t)(reader->pos - reader->map);
+}
+
+bool trace_seek(trace_reader_t *reader, uint64_t records, uint64_t offset) {
+    if (!reader->threaded && reader->map) {
+        if (reader->format == TRACE_FORMAT_BINARY) {
+            uint64_t avail = (uint64_t)(reader->end - reader->pos) / TRACE_BIN_RECORD_SIZE;
+            if (records > reader->remaining || records > avail) {
+                return false;
+            }
+            reader->pos += records * TRACE_BIN_RECORD_SIZE;
+            reader->remaining -= records;
+            return true;
+        }
+        if (offset != TRACE_OFFSET_UNKNOWN) {
+            if (offset > reader->map_len) {
+                return false;
+            }
+            reader->pos = reader->map + offset;
+            return true;
+        }
+    }
+
+    /* Not seekable: decode and discard */
+    trace_record_t rec;
+    while (records > 0 && trace_next(reader, &rec)) {
+        records--;
+    }
+    return records == 0;
+}
+
+void trace_get_identity(const trace_reader_t *reader, trace_identity_t *id) {
+    *id = reader->identity;
+}
+
+bool trace_failed(const trace_reader_t *reader) {
+    /* Set by the reader thread before it closes the ring */
+    return reader->failed;
+}
+
+void trace_close(trace_reader_t *reader) {
+    if (!reader) return;
+
+    if (reader->threaded) {
+        /* Unblock the reader thread if we stopped consuming early */
+        ring_close(reader->ring);
+        pthread_join(reader->thread, NULL);
+        ring_destroy(reader->ring);
+    }
+#ifdef HAVE_ZLIB
+    if (reader->gz) {
+        inflateEnd(&reader->zs);
+    }
+    free(reader->zbuf);
+#endif
+    if (reader->map) {
+        munmap(reader->map, reader->map_len);
+    }
+    if (reader->own_fd) {
+        close(reader->fd);
+    }
+    free(reader->buf);
+    free(reader);
+}
+
+/* ============================================================================
+ * Writer API
+ * ============================================================================ */
+
+trace_writer_t* trace_writer_open(const char *path) {
+    FILE *file = fopen(path, "wb");
+    if (!file) {
+        return NULL;
+    }
+
+    trace_writer_t *writer = calloc(1, sizeof(trace_writer_t));
+    if (!writer) {
+        fclose(file);
+        return NULL;
+    }
+    writer->file = file;
+
+    /* Placeholder header; the count is patched on close */
+    uint8_t hdr[TRACE_BIN_HEADER_SIZE];
+    encode_header(hdr, 0);
+    if (fwrite(hdr, 1, sizeof(hdr), file) != sizeof(hdr)) {
+        fclose(file);
+        free(writer);
+        return NULL;
+    }
+
+    return writer;
+}
+
+bool trace_writer_put(trace_writer_t *writer, const trace_record_t *rec) {
+    uint8_t p[TRACE_BIN_RECORD_SIZE];
+    p[0] = (uint8_t)rec->mode;
+    put_le32(p + 1, rec->vaddr);
+
+    if (fwrite(p, 1, sizeof(p), writer->file) != sizeof(p)) {
+        return false;
+    }
+    writer->count++;
+    return true;
+}
+
+bool trace_writer_close(trace_writer_t *writer) {
+    if (!writer) return false;
+
+    uint8_t hdr[TRACE_BIN_HEADER_SIZE];
+    encode_header(hdr, writer->count);
+
+    bool ok = fseek(writer->file, 0, SEEK_SET) == 0 &&
+              fwrite(hdr, 1, sizeof(hdr), writer->file) == sizeof(hdr);
+    if (fclose(writer->file) != 0) {
+        ok = false;
+    }
+
+    free(writer);
+    return ok;
+}
@@ -0,0 +1,60 @@
+/**
+ * @file trace2bin.c
+ * @brief Convert a text trace to the binary trace format
+ * @author Amir Noohi
+ * @copyright Copyright (c) 2025 Amir Noohi. All rights reserved.
+ *
+ * Usage: trace2bin <input-trace> <output.bin>
+ *
+ * The input may be in either format (a binary input is simply re-encoded).
+ * The resulting file is accepted by `sim -t` in place of the text trace.
+ * If the input is truncated or corrupt, or a write fails, no output file
+ * is left behind.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "trace.h"
+#include "types.h"
+
+int main(int argc, char *argv[]) {
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <input-trace> <output.bin>\n", argv[0]);
+        return 1;
+    }
+
+    trace_reader_t *reader = trace_open(argv[1]);
+    if (!reader) {
+        fprintf(stderr, "Cannot open trace %s\n", argv[1]);
+        return 1;
+    }
+
+    trace_writer_t *writer = trace_writer_open(argv[2]);
+    if (!writer) {
+        fprintf(stderr, "Cannot create %s\n", argv[2]);
+        trace_close(reader);
+        return 1;
+    }
+
+    trace_record_t rec;
+    bool ok = true;
+    while (ok && trace_next(reader, &rec)) {
+        ok = trace_writer_put(writer, &rec);
+    }
+    bool failed = trace_failed(reader);
+
+    trace_close(reader);
+    if (!trace_writer_close(writer) || !ok) {
+        fprintf(stderr, "Write error on %s\n", argv[2]);
+        failed = true;
+    }
+
+    /* Leave no well-formed but short trace behind */
+    if (failed) {
+        unlink(argv[2]);
+        return 1;
+    }
+
+    return 0;
+}
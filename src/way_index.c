@@ -0,0 +1,122 @@
+/**
+ * @file way_index.c
+ * @brief Tag-to-way hash index for fully-associative structures
+ * @author Amir Noohi
+ * @copyright Copyright (c) 2025 Amir Noohi. All rights reserved.
+ *
+ * Open addressing with linear probing. The table has at least twice as
+ * many slots as ways, so it is never more than half full. Deletion uses
+ * backward shifting: later members of the probe chain are moved into the
+ * hole, so lookups never have to skip tombstones.
+ */
+
+#include <stdlib.h>
+#include "way_index.h"
+#include "types.h"
+
+/* Fibonacci hashing multiplier (2^32 / golden ratio) */
+#define WAY_INDEX_HASH_MULT 0x9E3779B1u
+
+/* ============================================================================
+ * Helper Functions
+ * ============================================================================ */
+
+/**
+ * @brief Home slot of a tag
+ *
+ * Tags of a sequential stream differ in their low bits only; multiplying
+ * spreads them over the high bits, which select the slot.
+ */
+static inline uint32_t home_slot(const way_index_t *index, uint32_t tag) {
+    return (uint32_t)(tag * WAY_INDEX_HASH_MULT) >> index->shift;
+}
+
+/* ============================================================================
+ * Public API Implementation
+ * ============================================================================ */
+
+bool way_index_init(way_index_t *index, uint32_t ways) {
+    uint32_t bits = 1;
+    while ((1u << bits) < 2 * (uint64_t)ways) {
+        bits++;
+    }
+
+    uint32_t num_slots = 1u << bits;
+    index->slots = malloc((size_t)num_slots * sizeof(way_index_slot_t));
+    if (!index->slots) {
+        return false;
+    }
+
+    index->mask = num_slots - 1;
+    index->shift = 32 - bits;
+
+    for (uint32_t i = 0; i < num_slots; i++) {
+        index->slots[i].tag = 0;
+        index->slots[i].way = WAY_NONE;
+    }
+
+    return true;
+}
+
+uint32_t way_index_find(const way_index_t *index, uint32_t tag) {
+    uint32_t i = home_slot(index, tag);
+
+    for (;;) {
+        const way_index_slot_t *slot = &index->slots[i];
+        if (slot->way == WAY_NONE) {
+            return WAY_NONE;
+        }
+        if (slot->tag == tag) {
+            return slot->way;
+        }
+        i = (i + 1) & index->mask;
+    }
+}
+
+void way_index_insert(way_index_t *index, uint32_t tag, uint32_t way) {
+    uint32_t i = home_slot(index, tag);
+
+    while (index->slots[i].way != WAY_NONE) {
+        i = (i + 1) & index->mask;
+    }
+
+    index->slots[i].tag = tag;
+    index->slots[i].way = way;
+}
+
+void way_index_remove(way_index_t *index, uint32_t tag) {
+    uint32_t hole = home_slot(index, tag);
+
+    /* Locate the tag */
+    for (;;) {
+        if (index->slots[hole].way == WAY_NONE) {
+            return;
+        }
+        if (index->slots[hole].tag == tag) {
+            break;
+        }
+        hole = (hole + 1) & index->mask;
+    }
+
+    /* Pull back every later chain member whose home is not past the hole */
+    uint32_t i = hole;
+    for (;;) {
+        i = (i + 1) & index->mask;
+        if (index->slots[i].way == WAY_NONE) {
+            break;
+        }
+
+        uint32_t home = home_slot(index, index->slots[i].tag);
+        if (((i - home) & index->mask) >= ((i - hole) & index->mask)) {
+            index->slots[hole] = index->slots[i];
+            hole = i;
+        }
+    }
+
+    index->slots[hole].way = WAY_NONE;
+}
+
+void way_index_free(way_index_t *index) {
+    free(index->slots);
+    index->slots = NULL;
+}
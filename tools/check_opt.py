@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""
+Belady OPT checker for VM/Cache Simulator
+Replays every testcaseNN/ trace through an independent brute-force
+Belady model and compares it with `sim --opt -v`, access by access.
+
+Each structure (TLB, page frames, each cache level) only sees the accesses
+that reach it, and on a miss in a full set it evicts the entry whose next
+use in that stream is furthest away (or that is never used again). The
+physical address of each access is taken from the simulator's verbose
+output, so frame numbering is not modelled, only which accesses fault.
+
+Usage: check_opt.py [--sim PATH]
+Copyright (c) 2025 Amir Noohi
+"""
+
+import os
+import subprocess
+import sys
+
+from run_tests import C
+from check_writebacks import ways_of
+
+PAGE_SIZE = 4096
+NUM_PHYSICAL_PAGES = 256
+
+# (TLB entries, -L, cache options); multi-level when the options hold -S1
+GEOMETRIES = [
+    ('8', '2', ['-S', '256', '-B', '16', '-A', '2']),
+    ('16', '4', ['-S', '512', '-B', '16', '-A', '4']),
+    ('12', '3w', ['-S', '384', '-B', '32', '-A', '3w']),
+    ('4', '1', ['-S1', '64', '-B1', '16', '-A1', '3',
+                '-S2', '256', '-B2', '16', '-A2', '4']),
+    ('8', '2', ['-S1', '128', '-B1', '16', '-A1', '2',
+                '-S2', '1536', '-B2', '32', '-A2', '6w']),
+]
+
+def belady(keys, sets, ways):
+    """Hit (True) or miss (False) of each key of a stream under OPT"""
+    next_use = [0] * len(keys)
+    seen = {}
+    for i in range(len(keys) - 1, -1, -1):
+        next_use[i] = seen.get(keys[i], len(keys))
+        seen[keys[i]] = i
+
+    resident = [{} for _ in range(sets)]   # key -> next use, per set
+    hits = []
+    for i, key in enumerate(keys):
+        lines = resident[key % sets]
+        hit = key in lines
+        if not hit and len(lines) == ways:
+            del lines[max(lines, key=lines.get)]
+        lines[key] = next_use[i]
+        hits.append(hit)
+    return hits
+
+def levels_of(options):
+    """(size, block, assoc) of each cache level"""
+    opts = dict(zip(options[::2], options[1::2]))
+    if '-S1' in opts:
+        return [(int(opts[f'-S{n}']), int(opts[f'-B{n}']), opts[f'-A{n}']) for n in (1, 2)]
+    return [(int(opts['-S']), int(opts['-B']), opts['-A'])]
+
+def model(accesses, geometry):
+    """Expected (TLB, page, cache...) results of each access"""
+    entries, tlb_assoc, options = geometry
+    tlb_ways = ways_of(tlb_assoc, int(entries), 1)
+    vpns = [vaddr // PAGE_SIZE for vaddr, _ in accesses]
+    tlb = belady(vpns, int(entries) // tlb_ways, tlb_ways)
+    frames = belady(vpns, 1, NUM_PHYSICAL_PAGES)
+
+    # Each level sees the misses of the level above
+    reaching = list(range(len(accesses)))
+    caches = []
+    for size, block, assoc in levels_of(options):
+        ways = ways_of(assoc, size, block)
+        hits = belady([accesses[i][1] // block for i in reaching], size // block // ways, ways)
+        caches.append(dict(zip(reaching, hits)))
+        reaching = [i for i, hit in zip(reaching, hits) if not hit]
+
+    expected = []
+    for i in range(len(accesses)):
+        result = ['TLB-HIT' if tlb[i] else 'TLB-MISS',
+                  '-' if tlb[i] else ('PAGE-HIT' if frames[i] else 'PAGE-FAULT')]
+        if len(caches) == 1:
+            result.append('CACHE-HIT' if caches[0][i] else 'CACHE-MISS')
+        elif caches[0][i]:
+            result += ['L1-HIT', 'L2-HIT']
+        else:
+            result += ['L1-MISS', 'L2-HIT' if caches[1][i] else 'L2-MISS']
+        expected.append(result)
+    return expected
+
+def check(sim, trace, geometry):
+    """Return a list of mismatching accesses (empty if none)"""
+    entries, tlb_assoc, options = geometry
+    result = subprocess.run([sim] + options + ['-T', entries, '-L', tlb_assoc,
+                                               '-t', trace, '--opt', '-v'],
+                            capture_output=True, text=True, timeout=10)
+    if result.returncode != 0:
+        return ['simulator failed']
+
+    accesses, actual = [], []
+    for line in result.stdout.splitlines():
+        fields = line.split()
+        if len(fields) < 6 or fields[0] not in ('R', 'W'):
+            continue
+        accesses.append((int(fields[1], 16), int(fields[2], 16)))
+        actual.append(fields[3:])
+
+    expected = model(accesses, geometry)
+    return [f"access {i}: {' '.join(a)} != {' '.join(e)}"
+            for i, (a, e) in enumerate(zip(actual, expected)) if a != e]
+
+def main():
+    argv = sys.argv[1:]
+    sim = argv[argv.index('--sim') + 1] if '--sim' in argv else './sim'
+    if not os.path.exists(sim):
+        print(f"{C.R}[ERROR]{C.END} Simulator not found. Run 'make' first.")
+        sys.exit(1)
+
+    test_dir = 'tests'
+    traces = sorted(os.path.join(test_dir, d, 'input.txt') for d in os.listdir(test_dir)
+                    if d.startswith('testcase'))
+    passed = total = 0
+    for trace in traces:
+        if not os.path.exists(trace):
+            continue
+        name = os.path.basename(os.path.dirname(trace))
+        errors = []
+        for geometry in GEOMETRIES:
+            label = ' '.join(geometry[2] + ['-T', geometry[0], '-L', geometry[1]])
+            errors += [f"{label}: {e}" for e in check(sim, trace, geometry)]
+        total += 1
+        if errors:
+            print(f"{C.R}[FAIL]{C.END} {name}: {errors[0]}")
+        else:
+            print(f"{C.G}[PASS]{C.END} {name}")
+            passed += 1
+
+    if passed == total:
+        print(f"\n{C.BOLD}{C.G}All traces match the model ({passed}/{total}){C.END}")
+        sys.exit(0)
+    print(f"\n{C.BOLD}{C.R}Traces matching the model: {passed}/{total}{C.END}")
+    sys.exit(1)
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,159 @@
+#!/usr/bin/env python3
+"""
+Writeback checker for VM/Cache Simulator
+Replays every testcaseNN/ trace through an independent two-level LRU
+model with dirty-victim propagation and compares its counters with
+`sim --writebacks --stats-format json`.
+
+The model takes the physical address of each access from the simulator's
+verbose output, so only the caches are modelled. An L1 miss is a demand
+access of L2; the dirty block it evicted from L1 (if any) is then written
+into L2 as a non-demand write, which may itself evict a dirty L2 block.
+
+Usage: check_writebacks.py [--sim PATH]
+Copyright (c) 2025 Amir Noohi
+"""
+
+import json
+import os
+import subprocess
+import sys
+from collections import OrderedDict
+
+from run_tests import C
+
+# Multi-level geometries: (L1 size, block, -A1, L2 size, block, -A2)
+GEOMETRIES = [
+    ('64', '16', '3', '256', '16', '4'),
+    ('128', '16', '1', '512', '32', '3'),
+    ('256', '16', '4', '1024', '16', '1'),
+    ('64', '8', '2', '512', '16', '8w'),
+]
+
+COUNTERS = ('accesses', 'hits', 'misses', 'reads', 'read_hits', 'writes',
+            'write_hits', 'writebacks', 'writebacks_in', 'writeback_misses')
+
+def ways_of(assoc, size, block):
+    """Ways of an -A argument (a code 1-4 or "<N>w")"""
+    if assoc.endswith('w'):
+        return int(assoc[:-1])
+    return {'1': 1, '3': 2, '4': 4}.get(assoc, size // block)
+
+class Cache:
+    """Write-back, write-allocate LRU cache"""
+
+    def __init__(self, size, block, assoc):
+        self.block = block
+        self.ways = ways_of(assoc, size, block)
+        self.sets = [OrderedDict() for _ in range(size // block // self.ways)]
+        self.stats = dict.fromkeys(COUNTERS, 0)
+
+    def touch(self, addr, write):
+        """Reference a block; return (hit, dirty victim address or None)"""
+        block = addr // self.block
+        lines = self.sets[block % len(self.sets)]
+        if block in lines:
+            lines.move_to_end(block)
+            lines[block] = lines[block] or write
+            return True, None
+        victim = None
+        if len(lines) == self.ways:
+            old, dirty = lines.popitem(last=False)
+            if dirty:
+                self.stats['writebacks'] += 1
+                victim = old * self.block
+        lines[block] = write
+        return False, victim
+
+    def access(self, addr, write):
+        """Demand access"""
+        hit, victim = self.touch(addr, write)
+        self.stats['accesses'] += 1
+        self.stats['writes' if write else 'reads'] += 1
+        if hit:
+            self.stats['hits'] += 1
+            self.stats['write_hits' if write else 'read_hits'] += 1
+        else:
+            self.stats['misses'] += 1
+        return hit, victim
+
+    def write_back(self, addr):
+        """Writeback received from the level above"""
+        hit, _ = self.touch(addr, True)
+        self.stats['writebacks_in'] += 1
+        if not hit:
+            self.stats['writeback_misses'] += 1
+
+def model(verbose, geometry):
+    """Counters of L1 and L2 for the accesses of a verbose run"""
+    l1 = Cache(int(geometry[0]), int(geometry[1]), geometry[2])
+    l2 = Cache(int(geometry[3]), int(geometry[4]), geometry[5])
+    for line in verbose.splitlines():
+        fields = line.split()
+        if len(fields) < 4 or fields[0] not in ('R', 'W'):
+            continue
+        write = fields[0] == 'W'
+        paddr = int(fields[2], 16)
+        hit, victim = l1.access(paddr, write)
+        if not hit:
+            l2.access(paddr, write)
+            if victim is not None:
+                l2.write_back(victim)
+    return {'l1': l1.stats, 'l2': l2.stats}
+
+def check(sim, trace, geometry):
+    """Return a list of mismatching counters (empty if none)"""
+    args = ['-S1', geometry[0], '-B1', geometry[1], '-A1', geometry[2],
+            '-S2', geometry[3], '-B2', geometry[4], '-A2', geometry[5],
+            '-T', '8', '-L', '3', '-t', trace]
+    verbose = subprocess.run([sim] + args + ['-v'], capture_output=True, text=True,
+                             timeout=10).stdout
+    result = subprocess.run([sim] + args + ['--writebacks', '--stats-format', 'json'],
+                            capture_output=True, text=True, timeout=10)
+    if result.returncode != 0:
+        return ['simulator failed']
+    stats = json.loads(result.stdout)
+    expected = model(verbose, geometry)
+
+    errors = [f"{level} {key}: {stats[level][key]} != {value}"
+              for level in ('l1', 'l2') for key, value in expected[level].items()
+              if stats[level][key] != value]
+    if stats['hierarchy'].get('l1_writebacks') != expected['l1']['writebacks']:
+        errors.append('hierarchy l1_writebacks')
+    if stats['hierarchy'].get('memory_writebacks') != expected['l2']['writebacks']:
+        errors.append('hierarchy memory_writebacks')
+    return errors
+
+def main():
+    argv = sys.argv[1:]
+    sim = argv[argv.index('--sim') + 1] if '--sim' in argv else './sim'
+    if not os.path.exists(sim):
+        print(f"{C.R}[ERROR]{C.END} Simulator not found. Run 'make' first.")
+        sys.exit(1)
+
+    test_dir = 'tests'
+    traces = sorted(os.path.join(test_dir, d, 'input.txt') for d in os.listdir(test_dir)
+                    if d.startswith('testcase'))
+    passed = total = 0
+    for trace in traces:
+        if not os.path.exists(trace):
+            continue
+        name = os.path.basename(os.path.dirname(trace))
+        errors = []
+        for geometry in GEOMETRIES:
+            errors += [f"{' '.join(geometry)}: {e}" for e in check(sim, trace, geometry)]
+        total += 1
+        if errors:
+            print(f"{C.R}[FAIL]{C.END} {name}: {errors[0]}")
+        else:
+            print(f"{C.G}[PASS]{C.END} {name}")
+            passed += 1
+
+    if passed == total:
+        print(f"\n{C.BOLD}{C.G}All traces match the model ({passed}/{total}){C.END}")
+        sys.exit(0)
+    print(f"\n{C.BOLD}{C.R}Traces matching the model: {passed}/{total}{C.END}")
+    sys.exit(1)
+
+if __name__ == "__main__":
+    main()
@@ -9,13 +9,15 @@ import os
 import sys
 
 def parse_params(params_file):
-    """Parse params.txt into command-line arguments"""
+    """Parse params.txt into command-line arguments ("--" lines as written)"""
     args = []
     try:
         with open(params_file, 'r', encoding='utf-8') as f:
             for line in f:
                 line = line.strip()
-                if line and '-' in line:
+                if line.startswith('--'):
+                    args.extend(line.split())
+                elif line and '-' in line:
                     parts = line.split(' - ')
                     if len(parts) == 2:
                         param = parts[0].strip()
@@ -39,7 +41,8 @@ def generate(sim, testcase_dir):
     if not args:
         return None
     
-    args.extend(['-t', input_file, '-v'])
+    # Verbose like run_tests.py (json/csv reports exclude -v)
+    args.extend(['-t', input_file] + ([] if '--stats-format' in args else ['-v']))
     
     try:
         result = subprocess.run(
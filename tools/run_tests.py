@@ -8,6 +8,9 @@ Copyright (c) 2025 Amir Noohi
 import subprocess
 import sys
 import os
+import gzip
+import shutil
+import tempfile
 from pathlib import Path
 
 # ANSI colors
@@ -22,12 +25,18 @@ class C:
     BOLD = '\033[1m'
 
 def parse_params(params_file):
-    """Parse params.txt and return arguments list"""
+    """Parse params.txt and return arguments list
+
+    "X - value" lines give "-X value"; lines starting with "--" are long
+    options, passed through as written (e.g. "--latency l1=2,l2=10").
+    """
     args = []
     with open(params_file, 'r') as f:
         for line in f:
             line = line.strip()
-            if line and '-' in line:
+            if line.startswith('--'):
+                args.extend(line.split())
+            elif line and '-' in line:
                 parts = line.split(' - ')
                 if len(parts) == 2:
                     param = parts[0].strip()
@@ -35,8 +44,214 @@ def parse_params(params_file):
                     args.extend([f'-{param}', value])
     return args
 
-def run_test(sim, testcase_dir):
-    """Run a single test case"""
+# Geometries covering every specialized access path (--compare)
+VARIANT_ARGS = [
+    ['-S', '4096', '-B', '16', '-A', '1', '-T', '16', '-L', '1'],              # direct-mapped
+    ['-S', '4096', '-B', '16', '-A', '3', '-T', '16', '-L', '3'],              # 2-way
+    ['-S', '4096', '-B', '32', '-A', '4', '-T', '16', '-L', '4', '-P', 'plru'],
+    ['-S', '4096', '-B', '16', '-A', '8w', '-T', '32', '-L', '8w', '-P', 'srrip'],
+    ['-S', '8192', '-B', '16', '-A', '16w', '-T', '32', '-L', '16w', '-PT', 'fifo'],
+    ['-S', '256', '-B', '16', '-A', '2', '-T', '8', '-L', '2'],                # scanned fully-assoc
+    ['-S', '4096', '-B', '16', '-A', '2', '-T', '64', '-L', '2'],              # indexed fully-assoc
+    ['-S', '3072', '-B', '16', '-A', '12w', '-T', '24', '-L', '3w'],           # generic only
+    ['-S', '4096', '-B', '16', '-A', '4', '-T', '16', '-L', '4', '--hash-index'],
+    ['-S1', '512', '-B1', '16', '-A1', '4', '-S2', '4096', '-B2', '32', '-A2', '8w',
+     '-T', '8', '-L', '3'],
+]
+
+def compare_sims(sim, other, testcases, other_args=(), verbose=True):
+    """Run every test trace through VARIANT_ARGS on both simulators, compare outputs
+
+    other_args are appended to the runs of other only. Without verbose
+    (--threads excludes -v), only the single-level geometries are run.
+    """
+    results = []
+    variants = [a for a in VARIANT_ARGS if verbose or '-S' in a]
+    for testcase in testcases:
+        input_file = os.path.join(testcase, 'input.txt')
+        if not os.path.exists(input_file):
+            continue
+        mismatches = 0
+        for args in variants:
+            cmd = args + ['-t', input_file] + (['-v'] if verbose else [])
+            outputs = [subprocess.run([s] + cmd + extra, capture_output=True, text=True,
+                                      encoding='utf-8', errors='replace',
+                                      timeout=10).stdout
+                       for s, extra in ((sim, []), (other, list(other_args)))]
+            if outputs[0] != outputs[1]:
+                mismatches += 1
+                print(f"{C.R}[FAIL]{C.END} {os.path.basename(testcase)}: {' '.join(args)}")
+        if mismatches == 0:
+            print(f"{C.G}[PASS]{C.END} {os.path.basename(testcase)}")
+        results.append(mismatches == 0)
+    return results
+
+def convert_to_binary(input_file, tmp_dir):
+    """Convert a text trace with trace2bin, return the binary path"""
+    out = os.path.join(tmp_dir, os.path.basename(os.path.dirname(input_file)) + '.bin')
+    subprocess.run(['./trace2bin', input_file, out], check=True,
+                   capture_output=True, timeout=10)
+    return out
+
+def run_sim(sim, args, stdin=b''):
+    """Run sim with stdin piped from bytes, return the result"""
+    return subprocess.run([sim] + args, input=stdin, capture_output=True,
+                          timeout=10)
+
+def check_checkpoint(sim, testcases, records, tmp_dir):
+    """Compare a checkpoint-then-restore run with an uninterrupted run
+
+    Every test trace, as text and converted by trace2bin, is checkpointed
+    after `records` records and restored: the restored run must print the
+    uninterrupted run's verbose lines past the checkpoint, then the same
+    statistics. Restoring must fail on another file, and on a stdin trace
+    that ends before the checkpoint.
+    """
+    results = []
+    ckpt = os.path.join(tmp_dir, 'test.ckpt')
+    for testcase in testcases:
+        name = os.path.basename(testcase)
+        input_file = os.path.join(testcase, 'input.txt')
+        params_file = os.path.join(testcase, 'params.txt')
+        if not os.path.exists(input_file) or not os.path.exists(params_file):
+            continue
+        args = parse_params(params_file)
+        if any(arg.startswith('--') for arg in args):
+            continue  # Feature cases: most of their options exclude checkpoints
+        full = run_sim(sim, args + ['-t', input_file, '-v'])
+        if full.returncode != 0:
+            continue  # Invalid configuration: nothing to checkpoint
+        lines = full.stdout.splitlines()
+        accesses = sum(1 for line in lines if line[:2] in (b'R ', b'W '))
+        save = ['--checkpoint-at', str(records), ckpt]
+
+        failures = []
+        for trace in (input_file, convert_to_binary(input_file, tmp_dir)):
+            saved = run_sim(sim, args + ['-t', trace] + save)
+            resumed = run_sim(sim, args + ['-t', trace, '--restore', ckpt, '-v'])
+            if (saved.returncode != 0 or resumed.returncode != 0 or
+                    resumed.stdout.splitlines() != lines[min(records, accesses):]):
+                failures.append(f"restore on {os.path.basename(trace)}")
+
+        # Same records, another file
+        copy = os.path.join(tmp_dir, 'copy.txt')
+        shutil.copyfile(input_file, copy)
+        run_sim(sim, args + ['-t', input_file] + save)
+        refused = run_sim(sim, args + ['-t', copy, '--restore', ckpt])
+        if refused.returncode != 1 or b'different trace' not in refused.stderr:
+            failures.append("restore on another file")
+
+        # Fewer records than the checkpoint covers (a pipe has no identity)
+        if 0 < records <= accesses:
+            with open(input_file, 'rb') as f:
+                trace = f.read()
+            short = b''.join(line + b'\n' for line in trace.splitlines()[:records - 1])
+            run_sim(sim, args + ['-t', '-'] + save, stdin=trace)
+            refused = run_sim(sim, args + ['-t', '-', '--restore', ckpt], stdin=short)
+            if refused.returncode != 1 or b'ends before checkpoint' not in refused.stderr:
+                failures.append("restore on a shorter trace")
+
+        for failure in failures:
+            print(f"{C.R}[FAIL]{C.END} {name}: {failure}")
+        if not failures:
+            print(f"{C.G}[PASS]{C.END} {name}")
+        results.append(not failures)
+    return results
+
+def mrc_rows(output):
+    """Parse the (ways, misses) rows of a --mrc report
+
+    A leading (0, accesses) row stands for the sizes below the first step.
+    """
+    lines = output.splitlines()
+    if 'ways size misses miss-ratio' not in lines:
+        return None
+    start = lines.index('* Miss-Ratio Curve *')
+    rows = [(0, next(int(line.split()[1]) for line in lines[start:]
+                     if line.startswith('accesses:')))]
+    for line in lines[lines.index('ways size misses miss-ratio') + 1:]:
+        fields = line.split()
+        if len(fields) != 4:
+            break
+        rows.append((int(fields[0]), int(fields[2])))
+    return rows
+
+def cache_misses(output):
+    """Misses of the single-level cache in a report"""
+    lines = output.splitlines()
+    start = lines.index('* Cache Statistics *')
+    return next(int(line.split()[1]) for line in lines[start:] if line.startswith('misses:'))
+
+def check_mrc(sim, testcases):
+    """Compare miss-ratio curves with simulated caches of the same geometry
+
+    For 1 set (--mrc) and for 3 and 4 sets (--mrc-sets), every way count
+    at which the curve steps (and the one just below it) must give the
+    misses of an LRU cache of that many sets and ways on the same trace:
+    `-A 2` for one set, `-A <ways>w` otherwise.
+    """
+    results = []
+    xlate = ['-T', '8', '-L', '2']
+    for testcase in testcases:
+        input_file = os.path.join(testcase, 'input.txt')
+        if not os.path.exists(input_file):
+            continue
+        failures = []
+        for block in (16, 32):
+            for sets in (1, 3, 4):
+                base = ['-S', str(block), '-B', str(block), '-A', '2'] + xlate
+                curve = run_sim(sim, base + ['-t', input_file, '--mrc-sets', str(sets)])
+                rows = mrc_rows(curve.stdout.decode())
+                if curve.returncode != 0 or not rows:
+                    failures.append(f"-B {block} --mrc-sets {sets}: no curve")
+                    continue
+                ways = sorted(({w for r, _ in rows for w in (r - 1, r)} | set(range(1, 9))) - {-1, 0})
+                for w in ways:
+                    expected = next(m for r, m in reversed(rows) if r <= w)
+                    assoc = '2' if sets == 1 else f'{w}w'
+                    run = run_sim(sim, ['-S', str(sets * w * block), '-B', str(block),
+                                        '-A', assoc] + xlate + ['-t', input_file])
+                    if run.returncode != 0 or cache_misses(run.stdout.decode()) != expected:
+                        failures.append(f"-B {block} --mrc-sets {sets}: {w} ways")
+        for failure in failures[:1]:
+            print(f"{C.R}[FAIL]{C.END} {os.path.basename(testcase)}: {failure}")
+        if not failures:
+            print(f"{C.G}[PASS]{C.END} {os.path.basename(testcase)}")
+        results.append(not failures)
+    return results
+
+def check_truncated_gzip(sim, testcases, tmp_dir):
+    """Every valid case on a gzip trace cut in half must fail with exit 1"""
+    results = []
+    for testcase in testcases:
+        input_file = os.path.join(testcase, 'input.txt')
+        params_file = os.path.join(testcase, 'params.txt')
+        if not os.path.exists(input_file) or not os.path.exists(params_file):
+            continue
+        args = parse_params(params_file)
+        if run_sim(sim, args + ['-t', input_file]).returncode != 0:
+            continue  # Invalid configuration: the trace is never read
+        with open(input_file, 'rb') as f:
+            compressed = gzip.compress(f.read())
+        truncated = os.path.join(tmp_dir, 'truncated.gz')
+        with open(truncated, 'wb') as f:
+            f.write(compressed[:len(compressed) // 2])
+        result = run_sim(sim, args + ['-t', truncated])
+        name = os.path.basename(testcase)
+        if result.returncode == 1 and b'truncated' in result.stderr:
+            print(f"{C.G}[PASS]{C.END} {name} (truncated .gz)")
+        else:
+            print(f"{C.R}[FAIL]{C.END} {name}: truncated .gz accepted "
+                  f"(exit {result.returncode})")
+        results.append(result.returncode == 1)
+    return results
+
+def run_test(sim, testcase_dir, tmp_dir=None, pipe=None):
+    """Run a single test case
+
+    On a binary-converted trace if tmp_dir is set; with pipe (e.g.
+    ['gzip', '-c']), the trace is piped through that command to `-t -`.
+    """
     testcase_name = os.path.basename(testcase_dir)
     input_file = os.path.join(testcase_dir, 'input.txt')
     params_file = os.path.join(testcase_dir, 'params.txt')
@@ -50,17 +265,29 @@ def run_test(sim, testcase_dir):
     
     # Parse parameters
     args = parse_params(params_file)
-    args.extend(['-t', input_file, '-v'])  # Always verbose for output comparison
     
     # Run simulator
     try:
+        if tmp_dir is not None:
+            input_file = convert_to_binary(input_file, tmp_dir)
+        feeder = None
+        if pipe is not None:
+            feeder = subprocess.Popen(pipe + [input_file], stdout=subprocess.PIPE)
+        # Verbose for output comparison (json/csv reports exclude -v)
+        args.extend(['-t', '-' if feeder else input_file] +
+                    ([] if '--stats-format' in args else ['-v']))
+        
         result = subprocess.run(
             [sim] + args,
+            stdin=feeder.stdout if feeder else None,
             capture_output=True,
             text=True,
             encoding='utf-8',
             timeout=10
         )
+        if feeder:
+            feeder.stdout.close()
+            feeder.wait()
         
         # Read expected output (try multiple encodings)
         expected = None
@@ -107,9 +334,13 @@ def main():
     print(f"{C.BOLD}{C.M}{'VM/Cache Simulator Test Suite':^70}{C.END}")
     print(f"{C.BOLD}{C.M}{'='*70}{C.END}\n")
     
-    # Find simulator (prefer .exe on Windows)
+    # Find simulator (prefer .exe on Windows); --sim PATH picks another build
+    argv = sys.argv[1:]
     sim = None
-    for candidate in ['./sim.exe', 'sim.exe', './sim', 'sim']:
+    candidates = ['./sim.exe', 'sim.exe', './sim', 'sim']
+    if '--sim' in argv:
+        candidates = [argv[argv.index('--sim') + 1]]
+    for candidate in candidates:
         if os.path.exists(candidate):
             sim = candidate
             break
@@ -134,12 +365,68 @@ def main():
     
     print(f"{C.B}[INFO]{C.END} Found {len(testcases)} test cases\n")
     
+    # --compare OTHER: check OTHER produces identical output to sim
+    other = argv[argv.index('--compare') + 1] if '--compare' in argv else None
+    if other is not None and not os.path.exists(other):
+        print(f"{C.R}[ERROR]{C.END} {other} not found.")
+        sys.exit(1)
+    
+    # --threads N / --pipeline: check the parallel modes of sim against the
+    # sequential run
+    other_args = ()
+    verbose = True
+    if '--threads' in argv:
+        other = sim
+        other_args = ('--threads', argv[argv.index('--threads') + 1])
+        verbose = False
+    elif '--pipeline' in argv:
+        other = sim
+        other_args = ('--pipeline',)
+    
+    # --checkpoint N: checkpoint every case after N records and restore it
+    checkpoint = int(argv[argv.index('--checkpoint') + 1]) if '--checkpoint' in argv else None
+    
+    # --mrc: check miss-ratio curves against simulated caches
+    mrc = '--mrc' in argv
+    
+    # --binary: rerun every case on a trace converted by trace2bin
+    binary = '--binary' in argv
+    if (binary or checkpoint is not None) and not os.path.exists('./trace2bin'):
+        print(f"{C.R}[ERROR]{C.END} trace2bin not found. Run 'make' first.")
+        sys.exit(1)
+    if binary:
+        print(f"{C.B}[INFO]{C.END} Using binary-converted traces\n")
+    
+    # --gzip / --stdin: rerun every case on its trace piped through gzip or
+    # cat to `-t -` (--gzip also checks truncated .gz traces are refused)
+    pipe = None
+    if '--gzip' in argv:
+        pipe = ['gzip', '-c']
+    elif '--stdin' in argv:
+        pipe = ['cat']
+    if pipe:
+        print(f"{C.B}[INFO]{C.END} Piping traces through {pipe[0]}\n")
+    
     # Run all tests
     results = []
-    for testcase in testcases:
-        result = run_test(sim, testcase)
-        if result is not None:
-            results.append(result)
+    if other is not None:
+        print(f"{C.B}[INFO]{C.END} Comparing against: {' '.join((other,) + other_args)}\n")
+        results = compare_sims(sim, other, testcases, other_args, verbose)
+    elif checkpoint is not None:
+        print(f"{C.B}[INFO]{C.END} Checkpointing after {checkpoint} records\n")
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            results = check_checkpoint(sim, testcases, checkpoint, tmp_dir)
+    elif mrc:
+        print(f"{C.B}[INFO]{C.END} Checking miss-ratio curves against simulated caches\n")
+        results = check_mrc(sim, testcases)
+    else:
+        with tempfile.TemporaryDirectory() as tmp_dir:
+            for testcase in testcases:
+                result = run_test(sim, testcase, tmp_dir if binary else None, pipe)
+                if result is not None:
+                    results.append(result)
+            if pipe and pipe[0] == 'gzip':
+                results += check_truncated_gzip(sim, testcases, tmp_dir)
     
     # Summary
     print(f"\n{C.BOLD}{C.M}{'='*70}{C.END}")
@@ -0,0 +1,109 @@
+#!/usr/bin/env python3
+"""
+SHARDS error report for VM/Cache Simulator
+Runs every testcaseNN/ trace (or the traces given on the command line)
+with the exact miss-ratio curve (--mrc) and with SHARDS sampling, and
+reports the mean and max absolute miss-ratio error over all cache sizes.
+
+Usage: shards_error.py [--rate R | --budget N] [--sets N] [trace ...]
+Copyright (c) 2025 Amir Noohi
+"""
+
+import os
+import subprocess
+import sys
+
+from run_tests import C, parse_params
+
+# Geometry for traces given on the command line (only -B matters)
+DEFAULT_ARGS = ['-S', '1024', '-B', '16', '-A', '2', '-T', '16', '-L', '2']
+
+def option(argv, name, default):
+    """Value following name in argv, or default"""
+    if name in argv:
+        i = argv.index(name)
+        value = argv[i + 1]
+        del argv[i:i + 2]
+        return value
+    return default
+
+def run_curve(sim, args):
+    """Run sim and parse its miss-ratio curve into [(ways, miss ratio)]"""
+    result = subprocess.run([sim] + args, capture_output=True, text=True,
+                            encoding='utf-8', errors='replace', timeout=60)
+    if result.returncode != 0 or '* Miss-Ratio Curve *' not in result.stdout:
+        return None
+    curve = []
+    for line in result.stdout.split('* Miss-Ratio Curve *')[1].splitlines():
+        fields = line.split()
+        if len(fields) == 4 and fields[0].isdigit():
+            curve.append((int(fields[0]), float(fields[3])))
+    return curve
+
+def miss_ratio(curve, ways):
+    """Evaluate a step curve at a way count"""
+    ratio = 1.0
+    for w, r in curve:
+        if w > ways:
+            break
+        ratio = r
+    return ratio
+
+def compare(sim, name, args, sampling):
+    """Return (mean, max) absolute error of the sampled curve, or None"""
+    exact = run_curve(sim, args + ['--mrc'])
+    approx = run_curve(sim, args + sampling)
+    if exact is None or approx is None:
+        return None
+
+    # Every way count up to the last drop of either curve
+    last = max([w for w, _ in exact] + [w for w, _ in approx] + [1])
+    errors = [abs(miss_ratio(exact, w) - miss_ratio(approx, w))
+              for w in range(1, last + 1)]
+    mean, worst = sum(errors) / len(errors), max(errors)
+    print(f"{C.B}[INFO]{C.END} {name}: mean error {mean:.4f}, max error {worst:.4f}")
+    return mean, worst
+
+def main():
+    argv = sys.argv[1:]
+    budget = option(argv, '--budget', None)
+    rate = option(argv, '--rate', '0.1')
+    sets = option(argv, '--sets', '1')
+    sampling = (['--shards-budget', budget] if budget is not None
+                else ['--shards-rate', rate])
+
+    sim = './sim'
+    if not os.path.exists(sim):
+        print(f"{C.R}[ERROR]{C.END} Simulator not found. Run 'make' first.")
+        sys.exit(1)
+
+    print(f"\n{C.BOLD}{C.M}{'SHARDS Error Report':^70}{C.END}")
+    print(f"{C.B}[INFO]{C.END} Sampling: {' '.join(sampling)}\n")
+
+    # Runs: (name, arguments without the MRC options)
+    runs = []
+    if argv:
+        for trace in argv:
+            runs.append((trace, DEFAULT_ARGS + ['-t', trace, '--mrc-sets', sets]))
+    else:
+        test_dir = 'tests'
+        for d in sorted(os.listdir(test_dir)):
+            testcase = os.path.join(test_dir, d)
+            params = os.path.join(testcase, 'params.txt')
+            trace = os.path.join(testcase, 'input.txt')
+            if d.startswith('testcase') and os.path.exists(params) and os.path.exists(trace):
+                runs.append((d, parse_params(params) + ['-t', trace, '--mrc-sets', sets]))
+
+    results = [r for r in (compare(sim, name, args, sampling) for name, args in runs)
+               if r is not None]
+    if not results:
+        print(f"{C.Y}[WARN]{C.END} No valid traces to compare")
+        sys.exit(0)
+
+    mean = sum(r[0] for r in results) / len(results)
+    worst = max(r[1] for r in results)
+    print(f"\n{C.BOLD}Traces: {len(results)}, mean error {mean:.4f}, "
+          f"max error {worst:.4f}{C.END}\n")
+
+if __name__ == "__main__":
+    main()